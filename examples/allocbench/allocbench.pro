@@ -0,0 +1,15 @@
+######################################################################
+# Counts the heap allocations of the steady state append, projection,
+# axis update, drawing and frame paths. Fails if any of them allocates.
+######################################################################
+
+include(../examples.pro)
+
+TEMPLATE = app
+TARGET = allocbench
+DEPENDPATH += .
+INCLUDEPATH += . ../../src ../../src/curve ../../src/axes
+
+# Input
+HEADERS += alloccounter.h
+SOURCES += main.cpp alloccounter.cpp
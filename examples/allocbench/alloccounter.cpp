@@ -0,0 +1,106 @@
+#include "alloccounter.h"
+
+/* do not include stdlib.h: its declarations of malloc and friends carry
+ * exception specifications that the definitions below would have to repeat.
+ */
+#include <stddef.h>
+#include <errno.h>
+#ifdef __linux__
+#include <features.h>
+#endif
+
+#ifdef __GLIBC__
+
+extern "C"
+{
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t n, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void __libc_free(void *ptr);
+}
+
+/* thread local: allocations of the other threads (Qt, the X connection...) are not counted */
+static __thread int tCounting = 0;
+static __thread unsigned long tAllocations = 0;
+
+bool AllocCounter::isAvailable()
+{
+    return true;
+}
+
+void AllocCounter::start()
+{
+    tAllocations = 0;
+    tCounting = 1;
+}
+
+unsigned long AllocCounter::stop()
+{
+    tCounting = 0;
+    return tAllocations;
+}
+
+extern "C"
+{
+
+void *malloc(size_t size)
+{
+    if(tCounting)
+        tAllocations++;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size)
+{
+    if(tCounting)
+        tAllocations++;
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    if(tCounting)
+        tAllocations++;
+    return __libc_realloc(ptr, size);
+}
+
+void *memalign(size_t alignment, size_t size)
+{
+    if(tCounting)
+        tAllocations++;
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size)
+{
+    if(tCounting)
+        tAllocations++;
+    *ptr = __libc_memalign(alignment, size);
+    return *ptr ? 0 : ENOMEM;
+}
+
+void free(void *ptr)
+{
+    __libc_free(ptr);
+}
+
+}
+
+#else
+
+bool AllocCounter::isAvailable()
+{
+    return false;
+}
+
+void AllocCounter::start()
+{
+}
+
+unsigned long AllocCounter::stop()
+{
+    return 0;
+}
+
+#endif
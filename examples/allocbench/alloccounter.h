@@ -0,0 +1,26 @@
+#ifndef ALLOCCOUNTER_H
+#define ALLOCCOUNTER_H
+
+/** \brief counts the heap allocations made by the calling thread.
+ *
+ * malloc, calloc, realloc and the aligned allocators are interposed by
+ * alloccounter.cpp and forwarded to the C library. operator new goes through
+ * malloc, so C++ and Qt allocations are counted as well.
+ * Only the allocations made by the thread that called start are counted, until
+ * stop is called.
+ *
+ * Interposition relies on the glibc __libc_* entry points: where they are not
+ * available, isAvailable returns false and nothing is counted.
+ */
+class AllocCounter
+{
+public:
+    static bool isAvailable();
+
+    static void start();
+
+    /* stops counting and returns the number of allocations since start */
+    static unsigned long stop();
+};
+
+#endif // ALLOCCOUNTER_H
@@ -0,0 +1,221 @@
+#include <QApplication>
+#include <QImage>
+#include <QPainter>
+#include <QVector>
+#include <stdio.h>
+#include <math.h>
+#include "alloccounter.h"
+#include "plotscenewidget.h"
+#include "curve/scenecurve.h"
+#include "curve/curveitem.h"
+#include "curve/data.h"
+#include "curve/painters/linepainter.h"
+#include "curve/painters/stepspainter.h"
+#include "curve/painters/dotspainter.h"
+#include "axes/scaleitem.h"
+
+/* counts the heap allocations of the steady state paths of the library once the
+ * buffers are warm. Each phase runs warmup iterations first, then the allocations
+ * of the measured iterations are counted.
+ *
+ * The program fails if any of the following phases allocates:
+ * \li append: SceneCurve::addPoint on a full buffer (eviction of the oldest point),
+ *     with a CurveItem and a LinePainter listening, as on a displayed curve. The plot
+ *     is refreshed by a RefreshScheduler (manualSceneUpdate), so that the curve item
+ *     defers its updates to the next frame instead of posting an event;
+ * \li projection: SceneCurve::points after invalidateCache;
+ * \li invalid data: Data::invalidDataPoints into a reused vector;
+ * \li axis bounds: ScaleItem::setBoundsFromCurves with unchanged bounds;
+ * \li draw: the line, steps and dots painters drawing on a QImage.
+ *
+ * The frame phase (append, event processing and PlotSceneWidget::render) is only
+ * reported: the events delivered by the loop, QPainter::begin on the target and the
+ * item list and style options built by QGraphicsView::render allocate inside Qt,
+ * whatever the library does.
+ *
+ * usage: allocbench [bufsiz] [iterations]
+ */
+
+static const int warmup = 100;
+
+static void report(const char *phase, unsigned long allocations, int iterations, const char *outcome)
+{
+    printf("%-16s %8lu allocations in %d iterations (%.3f per iteration)%s\n", phase, allocations,
+           iterations, allocations / (double) iterations, outcome);
+}
+
+static bool check(const char *phase, unsigned long allocations, int iterations)
+{
+    report(phase, allocations, iterations, allocations == 0 ? "" : "  FAILED");
+    return allocations == 0;
+}
+
+static SceneCurve *addDrawnCurve(PlotSceneWidget *plot, const QString& name, int bufsiz)
+{
+    SceneCurve *c = plot->addCurve(name);
+    c->setBufferSize(bufsiz);
+    CurveItem *curveItem = new CurveItem(c);
+    plot->scene()->addItem(curveItem);
+    c->installCurveChangeListener(curveItem);
+    QVector<double> x(bufsiz), y(bufsiz);
+    for(int i = 0; i < bufsiz; i++)
+    {
+        x[i] = i;
+        y[i] = sin(i * 0.01) * 10;
+    }
+    c->setData(x, y);
+    return c;
+}
+
+int main(int argc, char *argv[])
+{
+#if QT_VERSION >= 0x050000
+    if(qgetenv("QT_QPA_PLATFORM").isEmpty())
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+#endif
+    QApplication a( argc, argv );
+
+    if(!AllocCounter::isAvailable())
+    {
+        printf("allocbench: allocation counting is not available on this platform\n");
+        return EXIT_SUCCESS;
+    }
+
+    int bufsiz = 10000, iterations = 10000;
+    if(a.arguments().size() > 1)
+        bufsiz = qMax(10, a.arguments().at(1).toInt());
+    if(a.arguments().size() > 2)
+        iterations = qMax(1, a.arguments().at(2).toInt());
+
+    PlotSceneWidget *plot = new PlotSceneWidget(0);
+    plot->setAttribute(Qt::WA_DontShowOnScreen);
+    plot->resize(800, 600);
+    plot->show();
+    plot->xScaleItem()->setBounds(0, bufsiz);
+    plot->yScaleItem()->setBounds(-10, 10);
+    /* a period long enough not to elapse while measuring */
+    plot->setRefreshPeriod(1000);
+    plot->setManualSceneUpdate(true);
+    qApp->processEvents();
+
+    bool ok = true;
+    unsigned long allocations;
+    int sample = 0;
+
+    /* append: the curve item is notified of each point added and removed */
+    SceneCurve *appendCurve = addDrawnCurve(plot, "append", bufsiz);
+    new LinePainter(appendCurve->curveItem());
+    qApp->processEvents();
+    /* the warmup arms the scheduler timer and posts the scene's own pending
+     * notifications once: without event processing neither happens again
+     */
+    for(; sample < bufsiz + warmup; sample++)
+        appendCurve->addPoint(sample, sin(sample * 0.01) * 10);
+    AllocCounter::start();
+    for(int i = 0; i < iterations; i++, sample++)
+        appendCurve->addPoint(sample, sin(sample * 0.01) * 10);
+    allocations = AllocCounter::stop();
+    ok &= check("append", allocations, iterations);
+
+    /* projection */
+    for(int i = 0; i < warmup; i++)
+    {
+        appendCurve->invalidateCache();
+        appendCurve->points();
+    }
+    int projections = qMax(1, iterations / 100);
+    AllocCounter::start();
+    for(int i = 0; i < projections; i++)
+    {
+        appendCurve->invalidateCache();
+        appendCurve->points();
+    }
+    allocations = AllocCounter::stop();
+    ok &= check("projection", allocations, projections);
+
+    /* invalid data: one NaN every 100 points */
+    Data nanData;
+    QVector<double> x(bufsiz), y(bufsiz), xInvalid;
+    for(int i = 0; i < bufsiz; i++)
+    {
+        x[i] = i;
+        y[i] = (i % 100 == 0) ? NAN : i;
+    }
+    nanData.setData(x, y);
+    for(int i = 0; i < warmup; i++)
+        nanData.invalidDataPoints(xInvalid);
+    AllocCounter::start();
+    for(int i = 0; i < projections; i++)
+        nanData.invalidDataPoints(xInvalid);
+    allocations = AllocCounter::stop();
+    ok &= check("invalid data", allocations, projections);
+
+    /* curves drawn by the painters. Data does not change from now on */
+    SceneCurve *lineCurve = addDrawnCurve(plot, "line", bufsiz);
+    SceneCurve *stepsCurve = addDrawnCurve(plot, "steps", bufsiz);
+    SceneCurve *dotsCurve = addDrawnCurve(plot, "dots", bufsiz);
+    LinePainter *linePainter = new LinePainter(lineCurve->curveItem());
+    StepsPainter *stepsPainter = new StepsPainter(stepsCurve->curveItem());
+    DotsPainter *dotsPainter = new DotsPainter(dotsCurve->curveItem());
+    qApp->processEvents();
+
+    /* axis bounds: the bounds do not change, so neither do the labels */
+    ScaleItem *xScale = plot->xScaleItem(), *yScale = plot->yScaleItem();
+    for(int i = 0; i < warmup; i++)
+    {
+        xScale->setBoundsFromCurves();
+        yScale->setBoundsFromCurves();
+    }
+    AllocCounter::start();
+    for(int i = 0; i < iterations; i++)
+    {
+        xScale->setBoundsFromCurves();
+        yScale->setBoundsFromCurves();
+    }
+    allocations = AllocCounter::stop();
+    ok &= check("axis bounds", allocations, iterations);
+
+    /* painters */
+    QImage image(plot->size(), QImage::Format_ARGB32_Premultiplied);
+    QPainter painter(&image);
+    int draws = qMax(1, iterations / 100);
+    QList<SceneCurve *> drawnCurves = QList<SceneCurve *>() << lineCurve << stepsCurve << dotsCurve;
+    QList<ItemPainterInterface *> painters = QList<ItemPainterInterface *>() << linePainter << stepsPainter << dotsPainter;
+    const char *names[] = { "draw line", "draw steps", "draw dots" };
+    for(int p = 0; p < painters.size(); p++)
+    {
+        for(int i = 0; i < warmup; i++)
+            painters[p]->draw(drawnCurves[p], plot, &painter, NULL, NULL);
+        AllocCounter::start();
+        for(int i = 0; i < draws; i++)
+            painters[p]->draw(drawnCurves[p], plot, &painter, NULL, NULL);
+        allocations = AllocCounter::stop();
+        ok &= check(names[p], allocations, draws);
+    }
+    painter.end();
+
+    /* full frame: append to a displayed curve and render. Reported, not enforced */
+    for(int i = 0; i < warmup; i++, sample++)
+    {
+        lineCurve->addPoint(sample, sin(sample * 0.01) * 10);
+        qApp->processEvents();
+        plot->render(&image);
+    }
+    AllocCounter::start();
+    for(int i = 0; i < draws; i++, sample++)
+    {
+        lineCurve->addPoint(sample, sin(sample * 0.01) * 10);
+        qApp->processEvents();
+        plot->render(&image);
+    }
+    allocations = AllocCounter::stop();
+    report("frame", allocations, draws, "  (not enforced)");
+
+    delete plot;
+    if(!ok)
+    {
+        printf("allocbench: the steady state allocates memory\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
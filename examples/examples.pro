@@ -10,5 +10,5 @@ INCLUDEPATH += ../../../src ../../../src/curve ../../../src/axes ../../../src/it
 LIBS += -L.. -L../.. -L../../.. -lQGraphicsPlot$${VER_SUFFIX}
 
 TEMPLATE = subdirs
-SUBDIRS = agingcircles scalar spectrum externalscales  scalartime
+SUBDIRS = agingcircles scalar spectrum externalscales  scalartime renderbench microbench allocbench formatcheck
 CONFIG += ordered
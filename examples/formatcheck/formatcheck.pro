@@ -0,0 +1,14 @@
+######################################################################
+# Checks the rounding of TimeLabelFormatter and that DoubleFormatter
+# writes the decimal point whatever the LC_NUMERIC locale.
+######################################################################
+
+include(../examples.pro)
+
+TEMPLATE = app
+TARGET = formatcheck
+DEPENDPATH += .
+INCLUDEPATH += . ../../src
+
+# Input
+SOURCES += main.cpp
@@ -0,0 +1,89 @@
+#include <QStringList>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <locale.h>
+#include "doubleformatter.h"
+#include "scalelabels/timelabelformatter.h"
+
+/* checks the output of the label formatters.
+ *
+ * The fraction of second written by TimeLabelFormatter must be rounded, with the
+ * carry into the seconds.
+ *
+ * DoubleFormatter is checked under a locale with a comma as decimal separator:
+ * qsnprintf, used by the Printf mode and by the rounding ties of the Fixed mode,
+ * follows LC_NUMERIC. The output must keep the point. These checks are skipped if
+ * no such locale is installed.
+ *
+ * usage: formatcheck [locale]
+ * The first of de_DE.UTF-8, it_IT.UTF-8, fr_FR.UTF-8 installed is used if no
+ * locale is given.
+ */
+
+static int failures = 0;
+
+static void check(const char *format, double v, const char *expected)
+{
+    DoubleFormatter f(format);
+    char buf[DoubleFormatter::BufferSize + 1];
+    int len = f.write(v, buf);
+    buf[len] = 0;
+    bool ok = strcmp(buf, expected) == 0;
+    printf("%-14s %-16s %s%s\n", format, buf, ok ? "" : "FAILED, expected ", ok ? "" : expected);
+    if(!ok)
+        failures++;
+}
+
+/* only the seconds and their fraction: they do not depend on the time zone */
+static void checkTime(const char *format, double t, const char *expected)
+{
+    TimeLabelFormatter f(format);
+    QByteArray s = f.format(t).toLatin1();
+    bool ok = s == expected;
+    printf("%-14s %-16s %s%s\n", format, s.constData(), ok ? "" : "FAILED, expected ", ok ? "" : expected);
+    if(!ok)
+        failures++;
+}
+
+int main(int argc, char *argv[])
+{
+    checkTime("ss.zzz", 1400000000.1, "20.100");
+    checkTime("ss.z", 1400000000.1, "20.1");
+    checkTime("ss.zzz", 1400000000.3, "20.300");
+    checkTime("ss.zz", 1400000000.3, "20.30");
+    checkTime("ss.zzz", 1400000039.9996, "00.000");
+    checkTime("ss", 1400000000.6, "21");
+
+    QStringList locales;
+    if(argc > 1)
+        locales << argv[1];
+    else
+        locales << "de_DE.UTF-8" << "it_IT.UTF-8" << "fr_FR.UTF-8";
+    const char *locale = NULL;
+    foreach(QString l, locales)
+        if((locale = setlocale(LC_NUMERIC, l.toLatin1().constData())) != NULL)
+            break;
+
+    char probe[32];
+    snprintf(probe, sizeof(probe), "%g", 1.5);
+    if(!locale || strcmp(probe, "1,5") != 0)
+    {
+        printf("formatcheck: no locale with a comma decimal separator is installed, skipped\n");
+        printf("%d failures\n", failures);
+        return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    printf("LC_NUMERIC %s: printf(\"%%g\", 1.5) writes \"%s\"\n", locale, probe);
+
+    check("%g", 1.5, "1.5");
+    check("%.2e V, %%", 1234.5, "1.23e+03 V, %");
+    check("x=%5.2f, y", 3.14159, "x= 3.14, y");
+    check("%.1f", 0.25, "0.2"); /* a tie: qsnprintf */
+    check("%.2f", 1.005, "1.00");
+    check("%f", 2.5, "2.500000");
+    check("%.2lf", 2.5, "2.50");
+    check("", 0.1, "0.1");
+
+    printf("%d failures\n", failures);
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
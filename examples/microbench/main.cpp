@@ -0,0 +1,22 @@
+#include <QApplication>
+#include <QtTest>
+#include "microbench.h"
+
+/* benchmarks the Data and SceneCurve hot paths at sizes from 1k to 10M points.
+ *
+ * usage: microbench [QTest options], e.g. microbench -csv dataAddPoint
+ */
+int main(int argc, char *argv[])
+{
+#if QT_VERSION >= 0x050000
+    if(qgetenv("QT_QPA_PLATFORM").isEmpty())
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+#endif
+    QApplication a( argc, argv );
+
+    a.setOrganizationName("QGraphicsPlot");
+    a.setApplicationName("MicroBench");
+
+    MicroBench bench;
+    return QTest::qExec(&bench, argc, argv);
+}
@@ -0,0 +1,211 @@
+#include "microbench.h"
+#include "plotscenewidget.h"
+#include "curve/data.h"
+#include "curve/scenecurve.h"
+#include <QtTest>
+#include <QVector>
+#include <math.h>
+
+static PlotSceneWidget *plot = NULL;
+
+static void fillVectors(int n, QVector<double> &x, QVector<double> &y, double phase = 0.0)
+{
+    x.resize(n);
+    y.resize(n);
+    for(int i = 0; i < n; i++)
+    {
+        x[i] = i;
+        y[i] = sin(i * 0.01 + phase);
+    }
+}
+
+/* the curve shared by the SceneCurve benchmarks, filled with n points */
+static SceneCurve *benchCurve(int n)
+{
+    SceneCurve *c = plot->findCurve("bench");
+    if(!c)
+        c = plot->addCurve("bench");
+    c->setBufferSize(n);
+    QVector<double> x, y;
+    fillVectors(n, x, y);
+    c->setData(x, y);
+    return c;
+}
+
+/* a hidden plot with autoscaled axes */
+void MicroBench::initTestCase()
+{
+    plot = new PlotSceneWidget(0);
+    plot->setAttribute(Qt::WA_DontShowOnScreen);
+    plot->resize(800, 600);
+    plot->show();
+    plot->xScaleItem()->setAxisAutoscaleEnabled(true);
+    plot->yScaleItem()->setAxisAutoscaleEnabled(true);
+}
+
+void MicroBench::cleanupTestCase()
+{
+    delete plot;
+    plot = NULL;
+}
+
+void MicroBench::mSizes()
+{
+    int maxSize = 10000000;
+    if(!qgetenv("MICROBENCH_MAX_SIZE").isEmpty())
+        maxSize = qgetenv("MICROBENCH_MAX_SIZE").toInt();
+    QTest::addColumn<int>("n");
+    for(int n = 1000; n <= maxSize; n *= 10)
+        QTest::newRow(QByteArray::number(n).constData()) << n;
+}
+
+void MicroBench::dataAddPoint_data()
+{
+    mSizes();
+}
+
+void MicroBench::dataAddPoint()
+{
+    QFETCH(int, n);
+    QBENCHMARK
+    {
+        Data d;
+        for(int i = 0; i < n; i++)
+            d.addPoint(i, sin(i * 0.01));
+    }
+}
+
+void MicroBench::dataAddPoints_data()
+{
+    mSizes();
+}
+
+void MicroBench::dataAddPoints()
+{
+    QFETCH(int, n);
+    QVector<double> x, y;
+    fillVectors(n, x, y);
+    QBENCHMARK
+    {
+        Data d;
+        d.addPoints(x, y);
+    }
+}
+
+void MicroBench::dataSetData_data()
+{
+    mSizes();
+}
+
+/* 2n operations: y changes at each call, as in a spectrum */
+void MicroBench::dataSetData()
+{
+    QFETCH(int, n);
+    Data d;
+    QVector<double> x1, y1, x2, y2;
+    fillVectors(n, x1, y1);
+    fillVectors(n, x2, y2, 1.0);
+    d.setData(x1, y1);
+    QBENCHMARK
+    {
+        d.setData(x2, y2);
+        d.setData(x1, y1);
+    }
+}
+
+void MicroBench::dataCalculateBounds_data()
+{
+    mSizes();
+}
+
+void MicroBench::dataCalculateBounds()
+{
+    QFETCH(int, n);
+    Data d;
+    QVector<double> x, y;
+    fillVectors(n, x, y);
+    d.setData(x, y);
+    QBENCHMARK
+    {
+        d.calculateBounds();
+    }
+}
+
+void MicroBench::dataInvalidDataPoints_data()
+{
+    mSizes();
+}
+
+void MicroBench::dataInvalidDataPoints()
+{
+    QFETCH(int, n);
+    Data d;
+    QVector<double> x, y;
+    fillVectors(n, x, y);
+    for(int i = 0; i < n; i += 100) /* 1% NaN */
+        y[i] = NAN;
+    d.setData(x, y);
+    QBENCHMARK
+    {
+        QVector<double> invalid = d.invalidDataPoints();
+        Q_UNUSED(invalid);
+    }
+}
+
+void MicroBench::sceneCurveEviction_data()
+{
+    mSizes();
+}
+
+/* the buffer is full: each addPoint evicts the oldest point (mCheckBufferSize).
+ * The eviction moves the whole buffer: the points added per block are capped to
+ * qMax(10, 1e8 / n), so that about 1e8 values are moved at any n
+ */
+void MicroBench::sceneCurveEviction()
+{
+    QFETCH(int, n);
+    SceneCurve *c = benchCurve(n);
+    int m = qMin(n, qMax(10, 100000000 / n));
+    int x = n;
+    QBENCHMARK
+    {
+        for(int i = 0; i < m; i++, x++)
+            c->addPoint(x, sin(x * 0.01));
+    }
+}
+
+void MicroBench::sceneCurvePoints_data()
+{
+    mSizes();
+}
+
+void MicroBench::sceneCurvePoints()
+{
+    QFETCH(int, n);
+    SceneCurve *c = benchCurve(n);
+    QBENCHMARK
+    {
+        c->invalidateCache();
+        c->points();
+    }
+}
+
+void MicroBench::plotGetClosest_data()
+{
+    mSizes();
+}
+
+/* 10 calls, the projection is not part of the measure */
+void MicroBench::plotGetClosest()
+{
+    QFETCH(int, n);
+    SceneCurve *c = benchCurve(n);
+    c->points();
+    QPointF closestPos;
+    int closestIndex;
+    QBENCHMARK
+    {
+        for(int i = 0; i < 10; i++)
+            plot->getClosest(closestPos, &closestIndex, QPointF(100 + i * 50, 300));
+    }
+}
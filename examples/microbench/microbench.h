@@ -0,0 +1,44 @@
+#ifndef MICROBENCH_H
+#define MICROBENCH_H
+
+#include <QObject>
+
+/** \brief QTestLib benchmarks of the Data and SceneCurve hot paths.
+ *
+ * Each benchmark runs at sizes from 1k to 10M points (the data tag is the size).
+ * The data sets are built before QBENCHMARK, so that only the operation is
+ * measured; the block measured performs about n operations unless noted.
+ * Use the usual QTest options to select the benchmarks and the output format,
+ * e.g. -xml or -csv, and to repeat the measure (-iterations, -minimumvalue).
+ *
+ * The environment variable MICROBENCH_MAX_SIZE limits the largest size.
+ */
+class MicroBench : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void dataAddPoint_data();
+    void dataAddPoint();
+    void dataAddPoints_data();
+    void dataAddPoints();
+    void dataSetData_data();
+    void dataSetData();
+    void dataCalculateBounds_data();
+    void dataCalculateBounds();
+    void dataInvalidDataPoints_data();
+    void dataInvalidDataPoints();
+    void sceneCurveEviction_data();
+    void sceneCurveEviction();
+    void sceneCurvePoints_data();
+    void sceneCurvePoints();
+    void plotGetClosest_data();
+    void plotGetClosest();
+
+private:
+    void mSizes();
+};
+
+#endif // MICROBENCH_H
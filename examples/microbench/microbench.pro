@@ -0,0 +1,17 @@
+######################################################################
+# Microbenchmarks of the Data and SceneCurve hot paths.
+######################################################################
+
+include(../examples.pro)
+
+TEMPLATE = app
+TARGET = microbench
+QT += testlib
+DEPENDPATH += .
+INCLUDEPATH += . ../../src ../../src/curve ../../src/axes
+
+QMAKE_CXXFLAGS += -O2
+
+# Input
+HEADERS += microbench.h
+SOURCES += main.cpp microbench.cpp
@@ -0,0 +1,90 @@
+#include <QApplication>
+#include <QFile>
+#include <QStringList>
+#include <stdio.h>
+#include "plotbench.h"
+#include "qgraphicsplotbackend.h"
+#ifdef BENCH_WITH_QWT
+#include "qwtbackend.h"
+#endif
+
+static PlotBackend *createBackend(const QString& library)
+{
+#ifdef BENCH_WITH_QWT
+    if(library == "qwt")
+        return new QwtBackend();
+#endif
+    Q_UNUSED(library);
+    return new QGraphicsPlotBackend();
+}
+
+/* runs identical workloads on qgraphicsplot and Qwt and prints the frame time and
+ * CPU time distributions as JSON. Save the output of a reference build to compare
+ * later builds against it.
+ *
+ * usage: plotbench [frames] [output.json]
+ */
+int main(int argc, char *argv[])
+{
+#if QT_VERSION >= 0x050000
+    if(qgetenv("QT_QPA_PLATFORM").isEmpty())
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+#endif
+    QApplication a( argc, argv );
+
+    a.setOrganizationName("QGraphicsPlot");
+    a.setApplicationName("PlotBench");
+
+    int frames = 100;
+    QString outFile;
+    bool ok;
+    if(a.arguments().size() > 1)
+    {
+        frames = a.arguments().at(1).toInt(&ok);
+        if(!ok || frames <= 0)
+        {
+            printf("usage: %s [frames] [output.json]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if(a.arguments().size() > 2)
+        outFile = a.arguments().at(2);
+
+    const QSize size(800, 600);
+    QStringList libraries = QStringList() << "qgraphicsplot";
+#ifdef BENCH_WITH_QWT
+    libraries << "qwt";
+#endif
+    const QStringList workloads = QStringList() << "scalar" << "spectrum" << "zoom";
+    const QList<int> curveCounts = QList<int>() << 1 << 8;
+    const QList<int> bufferSizes = QList<int>() << 1000 << 10000 << 100000;
+
+    PlotBench bench(frames, size);
+    QList<RunResult> results;
+    foreach(QString workload, workloads)
+        foreach(int nCurves, curveCounts)
+            foreach(int bufsiz, bufferSizes)
+                foreach(QString library, libraries)
+                {
+                    fprintf(stderr, "%s %s curves %d bufsiz %d...\n", qPrintable(library),
+                            qPrintable(workload), nCurves, bufsiz);
+                    PlotBackend *backend = createBackend(library);
+                    results << bench.run(backend, workload, nCurves, bufsiz);
+                    delete backend;
+                }
+
+    QString json = PlotBench::toJson(results, frames, size);
+    if(outFile.isEmpty())
+        printf("%s", json.toUtf8().constData());
+    else
+    {
+        QFile f(outFile);
+        if(!f.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            fprintf(stderr, "plotbench: cannot open \"%s\"\n", qPrintable(outFile));
+            return EXIT_FAILURE;
+        }
+        f.write(json.toUtf8());
+    }
+    return EXIT_SUCCESS;
+}
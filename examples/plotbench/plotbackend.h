@@ -0,0 +1,38 @@
+#ifndef PLOTBACKEND_H
+#define PLOTBACKEND_H
+
+#include <QString>
+#include <QVector>
+
+class QWidget;
+class QImage;
+
+/* the operations a benchmark workload performs on a plotting library.
+ * One implementation per library keeps the workloads identical.
+ */
+class PlotBackend
+{
+public:
+    virtual ~PlotBackend() {}
+
+    virtual QString name() const = 0;
+
+    virtual QWidget *widget() = 0;
+
+    /* creates n line curves holding at most bufsiz points each */
+    virtual void addCurves(int n, int bufsiz) = 0;
+
+    /* appends points to a curve, evicting the oldest ones beyond bufsiz */
+    virtual void append(int curve, const QVector<double>& x, const QVector<double>& y) = 0;
+
+    /* replaces the whole data of a curve */
+    virtual void replace(int curve, const QVector<double>& x, const QVector<double>& y) = 0;
+
+    /* fixes the x axis range, disabling the x autoscale */
+    virtual void setXRange(double lo, double hi) = 0;
+
+    /* brings the plot up to date and renders it into image */
+    virtual void render(QImage *image) = 0;
+};
+
+#endif // PLOTBACKEND_H
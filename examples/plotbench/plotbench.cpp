@@ -0,0 +1,145 @@
+#include "plotbench.h"
+#include "plotbackend.h"
+#include <QWidget>
+#include <QImage>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QtAlgorithms>
+#include <math.h>
+#include <time.h>
+
+Distribution Distribution::fromSamples(QVector<double> samples)
+{
+    Distribution d;
+    d.min = d.p50 = d.p90 = d.p99 = d.max = d.mean = 0.0;
+    int n = samples.size();
+    if(n == 0)
+        return d;
+    qSort(samples);
+    double sum = 0.0;
+    foreach(double s, samples)
+        sum += s;
+    d.min = samples.first();
+    d.max = samples.last();
+    d.mean = sum / n;
+    /* nearest rank percentiles */
+    d.p50 = samples.at(qBound(0, (int) ceil(0.50 * n) - 1, n - 1));
+    d.p90 = samples.at(qBound(0, (int) ceil(0.90 * n) - 1, n - 1));
+    d.p99 = samples.at(qBound(0, (int) ceil(0.99 * n) - 1, n - 1));
+    return d;
+}
+
+QString Distribution::toJson() const
+{
+    return QString("{\"min\": %1, \"p50\": %2, \"p90\": %3, \"p99\": %4, \"max\": %5, \"mean\": %6}")
+            .arg(min, 0, 'f', 4).arg(p50, 0, 'f', 4).arg(p90, 0, 'f', 4)
+            .arg(p99, 0, 'f', 4).arg(max, 0, 'f', 4).arg(mean, 0, 'f', 4);
+}
+
+PlotBench::PlotBench(int frames, const QSize &size) : mFrames(frames), mSize(size)
+{
+}
+
+double PlotBench::cpuMs()
+{
+#ifdef Q_OS_UNIX
+    struct timespec ts;
+    if(clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) == 0)
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+#endif
+    return clock() * 1000.0 / CLOCKS_PER_SEC;
+}
+
+/* deterministic data: both libraries receive exactly the same points */
+void PlotBench::mFeed(PlotBackend *backend, const QString &workload, int nCurves, int bufsiz,
+                      int frame, int *sample)
+{
+    for(int i = 0; i < nCurves; i++)
+    {
+        double maxAmplitude = 1 + i * 2;
+        if(workload == "scalar")
+        {
+            int n = (frame < 0) ? bufsiz : pointsPerFrame;
+            QVector<double> x(n), y(n);
+            for(int j = 0; j < n; j++)
+            {
+                x[j] = (*sample + j) * 0.03;
+                y[j] = sin(x[j]) * maxAmplitude;
+            }
+            backend->append(i, x, y);
+        }
+        else /* spectrum, zoom */
+        {
+            double amplitude = maxAmplitude * (0.5 + 0.5 * sin(frame * 0.1 + i));
+            QVector<double> x(bufsiz), y(bufsiz);
+            for(int j = 0; j < bufsiz; j++)
+            {
+                x[j] = j / 10.0;
+                y[j] = sin(x[j]) * amplitude;
+            }
+            backend->replace(i, x, y);
+        }
+    }
+    if(workload == "scalar")
+        *sample += (frame < 0) ? bufsiz : pointsPerFrame;
+}
+
+RunResult PlotBench::run(PlotBackend *backend, const QString &workload, int nCurves, int bufsiz)
+{
+    RunResult r;
+    r.library = backend->name();
+    r.workload = workload;
+    r.nCurves = nCurves;
+    r.bufsiz = bufsiz;
+    r.frames = mFrames;
+
+    QWidget *w = backend->widget();
+    w->setAttribute(Qt::WA_DontShowOnScreen);
+    w->resize(mSize);
+    w->show();
+    backend->addCurves(nCurves, bufsiz);
+    if(workload == "zoom")
+    {
+        double span = bufsiz / 10.0;
+        backend->setXRange(span * 0.45, span * 0.55);
+    }
+
+    QImage image(mSize, QImage::Format_ARGB32_Premultiplied);
+    int sample = 0;
+    /* fill the buffers and warm up */
+    mFeed(backend, workload, nCurves, bufsiz, -1, &sample);
+    backend->render(&image);
+
+    QVector<double> wall, cpu;
+    QElapsedTimer timer;
+    for(int f = 0; f < mFrames; f++)
+    {
+        double cpu0 = cpuMs();
+        timer.start();
+        mFeed(backend, workload, nCurves, bufsiz, f, &sample);
+        backend->render(&image);
+        wall << timer.nsecsElapsed() / 1e6;
+        cpu << cpuMs() - cpu0;
+    }
+    r.wall = Distribution::fromSamples(wall);
+    r.cpu = Distribution::fromSamples(cpu);
+    return r;
+}
+
+QString PlotBench::toJson(const QList<RunResult> &results, int frames, const QSize &size)
+{
+    QString json = QString("{\n  \"benchmark\": \"plotbench\",\n  \"qt\": \"%1\",\n  \"frames\": %2,\n"
+                           "  \"width\": %3,\n  \"height\": %4,\n  \"runs\": [\n")
+            .arg(qVersion()).arg(frames).arg(size.width()).arg(size.height());
+    for(int i = 0; i < results.size(); i++)
+    {
+        const RunResult &r = results.at(i);
+        json += QString("    {\"library\": \"%1\", \"workload\": \"%2\", \"curves\": %3, \"bufsiz\": %4, "
+                        "\"wallMs\": %5, \"cpuMs\": %6}")
+                .arg(r.library).arg(r.workload).arg(r.nCurves).arg(r.bufsiz)
+                .arg(r.wall.toJson()).arg(r.cpu.toJson());
+        json += (i < results.size() - 1) ? ",\n" : "\n";
+    }
+    json += "  ]\n}\n";
+    return json;
+}
@@ -0,0 +1,62 @@
+#ifndef PLOTBENCH_H
+#define PLOTBENCH_H
+
+#include <QString>
+#include <QVector>
+#include <QSize>
+#include <QList>
+
+class PlotBackend;
+
+/* summary of the per frame samples of a run, in milliseconds */
+struct Distribution
+{
+    double min, p50, p90, p99, max, mean;
+
+    static Distribution fromSamples(QVector<double> samples);
+
+    QString toJson() const;
+};
+
+struct RunResult
+{
+    QString library, workload;
+
+    int nCurves, bufsiz, frames;
+
+    Distribution wall, cpu;
+};
+
+/** \brief runs the same synthetic workloads on any PlotBackend.
+ *
+ * \li scalar: each frame appends pointsPerFrame points to each curve, evicting the
+ *     oldest beyond bufsiz. Buffers are filled before the measured frames;
+ * \li spectrum: each frame replaces the bufsiz points of each curve;
+ * \li zoom: as spectrum, with the x axis fixed on a tenth of the data range.
+ *
+ * For each frame the wall clock and the process CPU time spent updating the
+ * data and rendering the plot into a QImage are recorded.
+ */
+class PlotBench
+{
+public:
+    PlotBench(int frames, const QSize& size);
+
+    RunResult run(PlotBackend *backend, const QString& workload, int nCurves, int bufsiz);
+
+    static QString toJson(const QList<RunResult>& results, int frames, const QSize& size);
+
+private:
+    int mFrames;
+
+    QSize mSize;
+
+    static const int pointsPerFrame = 10;
+
+    static double cpuMs();
+
+    void mFeed(PlotBackend *backend, const QString& workload, int nCurves, int bufsiz,
+               int frame, int *sample);
+};
+
+#endif // PLOTBENCH_H
@@ -0,0 +1,25 @@
+######################################################################
+# qgraphicsplot versus Qwt benchmark harness.
+# Needs Qwt 6 (qwt.prf installed in the qmake features path).
+# Run qmake CONFIG+=noqwt to benchmark qgraphicsplot alone.
+######################################################################
+
+include(../examples.pro)
+
+TEMPLATE = app
+TARGET = plotbench
+DEPENDPATH += .
+INCLUDEPATH += . ../../src ../../src/curve ../../src/axes
+
+QMAKE_CXXFLAGS += -O2
+
+# Input
+HEADERS += plotbackend.h plotbench.h qgraphicsplotbackend.h
+SOURCES += main.cpp plotbench.cpp qgraphicsplotbackend.cpp
+
+!noqwt {
+    CONFIG += qwt
+    DEFINES += BENCH_WITH_QWT
+    HEADERS += qwtbackend.h
+    SOURCES += qwtbackend.cpp
+}
@@ -0,0 +1,61 @@
+#include "qgraphicsplotbackend.h"
+#include "plotscenewidget.h"
+#include "curve/scenecurve.h"
+#include "curve/curveitem.h"
+#include "curve/painters/linepainter.h"
+#include <QApplication>
+#include <QImage>
+
+QGraphicsPlotBackend::QGraphicsPlotBackend()
+{
+    mPlot = new PlotSceneWidget(0);
+    mPlot->xScaleItem()->setAxisAutoscaleEnabled(true);
+    mPlot->yScaleItem()->setAxisAutoscaleEnabled(true);
+}
+
+QGraphicsPlotBackend::~QGraphicsPlotBackend()
+{
+    delete mPlot;
+}
+
+QWidget *QGraphicsPlotBackend::widget()
+{
+    return mPlot;
+}
+
+void QGraphicsPlotBackend::addCurves(int n, int bufsiz)
+{
+    for(int i = 0; i < n; i++)
+    {
+        SceneCurve *c = mPlot->addCurve(QString("Curve %1").arg(i + 1));
+        c->setBufferSize(bufsiz);
+        CurveItem *curveItem = new CurveItem(c);
+        mPlot->scene()->addItem(curveItem);
+        c->installCurveChangeListener(curveItem);
+        new LinePainter(curveItem);
+        mCurves << c;
+    }
+}
+
+void QGraphicsPlotBackend::append(int curve, const QVector<double> &x, const QVector<double> &y)
+{
+    mCurves.at(curve)->addPoints(x, y);
+}
+
+void QGraphicsPlotBackend::replace(int curve, const QVector<double> &x, const QVector<double> &y)
+{
+    mCurves.at(curve)->setData(x, y);
+}
+
+void QGraphicsPlotBackend::setXRange(double lo, double hi)
+{
+    mPlot->xScaleItem()->setAxisAutoscaleEnabled(false);
+    mPlot->xScaleItem()->setBounds(lo, hi);
+}
+
+void QGraphicsPlotBackend::render(QImage *image)
+{
+    /* deliver the queued item updates, as the event loop would */
+    qApp->processEvents();
+    mPlot->render(image);
+}
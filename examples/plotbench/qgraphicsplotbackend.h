@@ -0,0 +1,37 @@
+#ifndef QGRAPHICSPLOTBACKEND_H
+#define QGRAPHICSPLOTBACKEND_H
+
+#include "plotbackend.h"
+#include <QList>
+
+class PlotSceneWidget;
+class SceneCurve;
+
+class QGraphicsPlotBackend : public PlotBackend
+{
+public:
+    QGraphicsPlotBackend();
+
+    virtual ~QGraphicsPlotBackend();
+
+    QString name() const { return "qgraphicsplot"; }
+
+    QWidget *widget();
+
+    void addCurves(int n, int bufsiz);
+
+    void append(int curve, const QVector<double>& x, const QVector<double>& y);
+
+    void replace(int curve, const QVector<double>& x, const QVector<double>& y);
+
+    void setXRange(double lo, double hi);
+
+    void render(QImage *image);
+
+private:
+    PlotSceneWidget *mPlot;
+
+    QList<SceneCurve *> mCurves;
+};
+
+#endif // QGRAPHICSPLOTBACKEND_H
@@ -0,0 +1,68 @@
+#include "qwtbackend.h"
+#include <qwt_plot.h>
+#include <qwt_plot_curve.h>
+#include <QImage>
+
+QwtBackend::QwtBackend() : mBufsiz(0)
+{
+    mPlot = new QwtPlot(0);
+    mPlot->setAutoReplot(false);
+    mPlot->setAxisAutoScale(QwtPlot::xBottom, true);
+    mPlot->setAxisAutoScale(QwtPlot::yLeft, true);
+}
+
+QwtBackend::~QwtBackend()
+{
+    delete mPlot;
+}
+
+QWidget *QwtBackend::widget()
+{
+    return mPlot;
+}
+
+void QwtBackend::addCurves(int n, int bufsiz)
+{
+    mBufsiz = bufsiz;
+    for(int i = 0; i < n; i++)
+    {
+        QwtPlotCurve *c = new QwtPlotCurve(QString("Curve %1").arg(i + 1));
+        c->attach(mPlot);
+        mCurves << c;
+        mX << QVector<double>();
+        mY << QVector<double>();
+    }
+}
+
+void QwtBackend::append(int curve, const QVector<double> &x, const QVector<double> &y)
+{
+    QVector<double> &xs = mX[curve];
+    QVector<double> &ys = mY[curve];
+    xs += x;
+    ys += y;
+    int excess = xs.size() - mBufsiz;
+    if(excess > 0)
+    {
+        xs.remove(0, excess);
+        ys.remove(0, excess);
+    }
+    mCurves.at(curve)->setSamples(xs, ys);
+}
+
+void QwtBackend::replace(int curve, const QVector<double> &x, const QVector<double> &y)
+{
+    mX[curve] = x;
+    mY[curve] = y;
+    mCurves.at(curve)->setSamples(x, y);
+}
+
+void QwtBackend::setXRange(double lo, double hi)
+{
+    mPlot->setAxisScale(QwtPlot::xBottom, lo, hi);
+}
+
+void QwtBackend::render(QImage *image)
+{
+    mPlot->replot();
+    mPlot->render(image);
+}
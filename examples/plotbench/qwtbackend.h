@@ -0,0 +1,42 @@
+#ifndef QWTBACKEND_H
+#define QWTBACKEND_H
+
+#include "plotbackend.h"
+#include <QList>
+
+class QwtPlot;
+class QwtPlotCurve;
+
+class QwtBackend : public PlotBackend
+{
+public:
+    QwtBackend();
+
+    virtual ~QwtBackend();
+
+    QString name() const { return "qwt"; }
+
+    QWidget *widget();
+
+    void addCurves(int n, int bufsiz);
+
+    void append(int curve, const QVector<double>& x, const QVector<double>& y);
+
+    void replace(int curve, const QVector<double>& x, const QVector<double>& y);
+
+    void setXRange(double lo, double hi);
+
+    void render(QImage *image);
+
+private:
+    QwtPlot *mPlot;
+
+    QList<QwtPlotCurve *> mCurves;
+
+    /* QwtPlotCurve does not evict: the sliding buffers are kept here */
+    QList<QVector<double> > mX, mY;
+
+    int mBufsiz;
+};
+
+#endif // QWTBACKEND_H
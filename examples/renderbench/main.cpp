@@ -0,0 +1,83 @@
+#include <QApplication>
+#include <QFile>
+#include <QStringList>
+#include <stdio.h>
+#include "renderbench.h"
+
+/* renders the fixed benchmark matrix offscreen and prints the results as JSON.
+ *
+ * usage: renderbench [frames] [output.json]
+ */
+int main(int argc, char *argv[])
+{
+#if QT_VERSION >= 0x050000
+    /* headless: render under the offscreen platform unless told otherwise */
+    if(qgetenv("QT_QPA_PLATFORM").isEmpty())
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+#endif
+    QApplication a( argc, argv );
+
+    a.setOrganizationName("QGraphicsPlot");
+    a.setApplicationName("RenderBench");
+
+    int frames = 50;
+    QString outFile;
+    bool ok;
+    if(a.arguments().size() > 1)
+    {
+        frames = a.arguments().at(1).toInt(&ok);
+        if(!ok || frames <= 0)
+        {
+            printf("usage: %s [frames] [output.json]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if(a.arguments().size() > 2)
+        outFile = a.arguments().at(2);
+
+    const QSize size(800, 600);
+    const QList<int> curveCounts = QList<int>() << 1 << 4 << 16;
+    const QList<int> bufferSizes = QList<int>() << 1000 << 10000 << 100000;
+
+    /* workload, painter */
+    QList<QStringList> workloads;
+    workloads << (QStringList() << "scalartime" << "line");
+    workloads << (QStringList() << "spectrum" << "line");
+    workloads << (QStringList() << "spectrum" << "dots");
+    workloads << (QStringList() << "spectrum" << "steps");
+    workloads << (QStringList() << "spectrum" << "histogram");
+    workloads << (QStringList() << "agingcircles" << "circles");
+
+    RenderBench bench(frames, size);
+    QList<BenchResult> results;
+    foreach(QStringList w, workloads)
+    {
+        foreach(int nCurves, curveCounts)
+        {
+            foreach(int bufsiz, bufferSizes)
+            {
+                /* the aging circles are meant for small buffers */
+                if(w.at(1) == "circles" && bufsiz > 10000)
+                    continue;
+                fprintf(stderr, "%s/%s curves %d bufsiz %d...\n", qPrintable(w.at(0)),
+                        qPrintable(w.at(1)), nCurves, bufsiz);
+                results << bench.run(w.at(0), w.at(1), nCurves, bufsiz);
+            }
+        }
+    }
+
+    QString json = RenderBench::toJson(results, frames, size);
+    if(outFile.isEmpty())
+        printf("%s", json.toUtf8().constData());
+    else
+    {
+        QFile f(outFile);
+        if(!f.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            fprintf(stderr, "renderbench: cannot open \"%s\"\n", qPrintable(outFile));
+            return EXIT_FAILURE;
+        }
+        f.write(json.toUtf8());
+    }
+    return EXIT_SUCCESS;
+}
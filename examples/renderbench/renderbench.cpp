@@ -0,0 +1,206 @@
+#include "renderbench.h"
+#include "plotscenewidget.h"
+#include "frametimings.h"
+#include "curve/scenecurve.h"
+#include "curve/curveitem.h"
+#include "curve/painters/linepainter.h"
+#include "curve/painters/dotspainter.h"
+#include "curve/painters/stepspainter.h"
+#include "curve/painters/histogrampainter.h"
+#include "curve/painters/circleitemset.h"
+#include "../../src/colors.h"
+
+#include <QApplication>
+#include <QImage>
+#include <QElapsedTimer>
+#include <QVector>
+#include <math.h>
+#include <stdio.h>
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+RenderBench::RenderBench(int frames, const QSize &size) : mFrames(frames), mSize(size)
+{
+}
+
+long RenderBench::rssKb()
+{
+#ifdef Q_OS_UNIX
+    /* size and resident pages: Linux only, -1 where /proc is missing */
+    long size, resident = -1;
+    FILE *f = fopen("/proc/self/statm", "r");
+    if(f)
+    {
+        if(fscanf(f, "%ld %ld", &size, &resident) != 2)
+            resident = -1;
+        fclose(f);
+    }
+    if(resident >= 0)
+        return resident * (sysconf(_SC_PAGESIZE) / 1024);
+#endif
+    return -1;
+}
+
+void RenderBench::mSetupCurve(PlotSceneWidget *plot, SceneCurve *c, const QString &painter, int bufsiz)
+{
+    QList<QColor> palette = QList<QColor> () << KDARKWATER << KDARKBLUE << KGRAY <<
+                                                KYELLOW << KCAMEL << KDARKCYAN << KDARKPINK;
+    c->setBufferSize(bufsiz);
+    CurveItem *curveItem = new CurveItem(c);
+    plot->scene()->addItem(curveItem);
+    c->installCurveChangeListener(curveItem);
+    if(painter == "line")
+        new LinePainter(curveItem);
+    else if(painter == "dots")
+        new DotsPainter(curveItem);
+    else if(painter == "steps")
+        new StepsPainter(curveItem);
+    else if(painter == "histogram")
+        new HistogramPainter(curveItem);
+    else if(painter == "circles")
+    {
+        CircleItemSet* circleItemSet = new CircleItemSet(curveItem, bufsiz);
+        circleItemSet->setColorList(palette);
+    }
+}
+
+/* deterministic data: the same run always produces the same points */
+unsigned long RenderBench::mFeed(const QString &workload, QList<SceneCurve *> &curves,
+                                 int bufsiz, int firstSample, int npoints)
+{
+    unsigned long ingested = 0;
+    for(int i = 0; i < curves.size(); i++)
+    {
+        SceneCurve *c = curves.at(i);
+        double maxAmplitude = 1 + i * 2;
+        if(workload == "spectrum")
+        {
+            double amplitude = maxAmplitude * (0.5 + 0.5 * sin(firstSample * 0.1 + i));
+            QVector<double> xData(bufsiz), yData(bufsiz);
+            for(int j = 0; j < bufsiz; j++)
+            {
+                xData[j] = j / 10.0;
+                yData[j] = sin(xData[j]) * amplitude;
+            }
+            c->setData(xData, yData);
+            ingested += bufsiz;
+        }
+        else /* scalartime, agingcircles */
+        {
+            for(int j = firstSample; j < firstSample + npoints; j++)
+                c->addPoint(j * 0.03, sin(j * 0.03) * maxAmplitude);
+            ingested += npoints;
+        }
+    }
+    return ingested;
+}
+
+BenchResult RenderBench::run(const QString &workload, const QString &painter, int nCurves, int bufsiz)
+{
+    BenchResult r;
+    r.workload = workload;
+    r.painter = painter;
+    r.nCurves = nCurves;
+    r.bufsiz = bufsiz;
+    r.frames = mFrames;
+    r.pointsIngested = 0;
+    r.ingestMs = r.frameMs = 0.0;
+    r.baseRssKb = r.peakRssKb = rssKb();
+
+    PlotSceneWidget *plot = new PlotSceneWidget(0);
+    plot->setAttribute(Qt::WA_DontShowOnScreen);
+    plot->resize(mSize);
+    plot->show();
+    plot->xScaleItem()->setAxisAutoscaleEnabled(true);
+    plot->yScaleItem()->setAxisAutoscaleEnabled(true);
+
+    QList<SceneCurve *> curves;
+    for(int i = 0; i < nCurves; i++)
+    {
+        SceneCurve *c = plot->addCurve(QString("Curve %1").arg(i + 1));
+        mSetupCurve(plot, c, painter, bufsiz);
+        curves << c;
+    }
+
+    bool streaming = (workload != "spectrum");
+    int sample = 0;
+    if(streaming) /* fill the buffers */
+    {
+        mFeed(workload, curves, bufsiz, sample, bufsiz);
+        sample += bufsiz;
+    }
+
+    QImage image(mSize, QImage::Format_ARGB32_Premultiplied);
+    qApp->processEvents();
+    plot->render(&image); /* warm up */
+
+    plot->setFrameTimingsEnabled(true);
+    FrameTimings *timings = plot->frameTimings();
+    QVector<double> stageTotals(FrameTimings::StageCount, 0.0);
+    QElapsedTimer timer;
+    for(int f = 0; f < mFrames; f++)
+    {
+        timings->clear();
+        timer.start();
+        if(streaming)
+        {
+            r.pointsIngested += mFeed(workload, curves, bufsiz, sample, pointsPerFrame);
+            sample += pointsPerFrame;
+        }
+        else
+            r.pointsIngested += mFeed(workload, curves, bufsiz, f, bufsiz);
+        r.ingestMs += timer.nsecsElapsed() / 1e6;
+
+        /* deliver the queued item updates, as the event loop would */
+        qApp->processEvents();
+        timer.start();
+        plot->render(&image);
+        r.frameMs += timer.nsecsElapsed() / 1e6;
+
+        for(int s = 0; s < FrameTimings::StageCount; s++)
+            stageTotals[s] += timings->mean(s) * timings->sampleCount(s) / 1000.0;
+        r.peakRssKb = qMax(r.peakRssKb, rssKb());
+    }
+
+    r.frameMs /= mFrames;
+    for(int s = 0; s < FrameTimings::StageCount; s++)
+        if(stageTotals[s] > 0.0)
+            r.stageMs.insert(FrameTimings::stageName(s), stageTotals[s] / mFrames);
+
+    delete plot;
+    return r;
+}
+
+QString RenderBench::toJson(const QList<BenchResult> &results, int frames, const QSize &size)
+{
+    QString json = QString("{\n  \"benchmark\": \"renderbench\",\n  \"qt\": \"%1\",\n"
+                           "  \"platform\": \"%2\",\n  \"frames\": %3,\n  \"width\": %4,\n"
+                           "  \"height\": %5,\n  \"runs\": [\n").arg(qVersion())
+#if QT_VERSION >= 0x050000
+            .arg(QGuiApplication::platformName())
+#else
+            .arg("qt4")
+#endif
+            .arg(frames).arg(size.width()).arg(size.height());
+
+    for(int i = 0; i < results.size(); i++)
+    {
+        const BenchResult &r = results.at(i);
+        double pps = r.ingestMs > 0 ? r.pointsIngested / (r.ingestMs / 1000.0) : 0.0;
+        QStringList stages;
+        foreach(QString s, r.stageMs.keys())
+            stages << QString("\"%1\": %2").arg(s).arg(r.stageMs.value(s), 0, 'f', 4);
+
+        json += QString("    {\"workload\": \"%1\", \"painter\": \"%2\", \"curves\": %3, \"bufsiz\": %4, "
+                        "\"pointsIngested\": %5, \"ingestMs\": %6, \"pointsPerSecond\": %7, "
+                        "\"msPerFrame\": %8, \"stageMsPerFrame\": {%9}, \"baseRssKb\": %10, \"peakRssKb\": %11}")
+                .arg(r.workload).arg(r.painter).arg(r.nCurves).arg(r.bufsiz)
+                .arg(r.pointsIngested).arg(r.ingestMs, 0, 'f', 3).arg(pps, 0, 'f', 0)
+                .arg(r.frameMs, 0, 'f', 4).arg(stages.join(", ")).arg(r.baseRssKb)
+                .arg(r.peakRssKb);
+        json += (i < results.size() - 1) ? ",\n" : "\n";
+    }
+    json += "  ]\n}\n";
+    return json;
+}
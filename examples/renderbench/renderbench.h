@@ -0,0 +1,68 @@
+#ifndef RENDERBENCH_H
+#define RENDERBENCH_H
+
+#include <QString>
+#include <QStringList>
+#include <QMap>
+#include <QSize>
+
+class PlotSceneWidget;
+class SceneCurve;
+
+/* the result of one cell of the benchmark matrix */
+struct BenchResult
+{
+    QString workload, painter;
+
+    int nCurves, bufsiz, frames;
+
+    unsigned long pointsIngested;
+
+    double ingestMs, frameMs;
+
+    /* stage name, milliseconds per frame */
+    QMap<QString, double> stageMs;
+
+    /* resident set size before the plot is created and the highest one sampled
+     * after each frame, in kilobytes
+     */
+    long baseRssKb, peakRssKb;
+};
+
+/** \brief drives the workloads of the scalartime, spectrum and agingcircles examples
+ *         deterministically and renders the plot offscreen.
+ *
+ * \li scalartime: each frame appends pointsPerFrame points to each curve (addPoint)
+ *     drawn with a LinePainter, with a sliding buffer of bufsiz points;
+ * \li spectrum: each frame replaces the data of each curve with bufsiz points
+ *     (setData), drawn with a LinePainter, DotsPainter, StepsPainter or HistogramPainter;
+ * \li agingcircles: as scalartime, drawn with a CircleItemSet.
+ *
+ * Streaming workloads fill the buffers before the measured frames.
+ */
+class RenderBench
+{
+public:
+    RenderBench(int frames, const QSize& size);
+
+    BenchResult run(const QString& workload, const QString& painter, int nCurves, int bufsiz);
+
+    static QString toJson(const QList<BenchResult>& results, int frames, const QSize& size);
+
+    /* current resident set size of the process, in kilobytes, -1 if unknown */
+    static long rssKb();
+
+private:
+    int mFrames;
+
+    QSize mSize;
+
+    static const int pointsPerFrame = 10;
+
+    void mSetupCurve(PlotSceneWidget *plot, SceneCurve *c, const QString& painter, int bufsiz);
+
+    unsigned long mFeed(const QString& workload, QList<SceneCurve *>& curves,
+                        int bufsiz, int frame, int npoints);
+};
+
+#endif // RENDERBENCH_H
@@ -0,0 +1,17 @@
+######################################################################
+# Headless render benchmark: drives the scalartime, spectrum and
+# agingcircles workloads offscreen and prints JSON results.
+######################################################################
+
+include(../examples.pro)
+
+TEMPLATE = app
+TARGET = renderbench
+DEPENDPATH += .
+INCLUDEPATH += . ../../src ../../src/curve ../../src/axes
+
+QMAKE_CXXFLAGS += -O2
+
+# Input
+HEADERS += renderbench.h
+SOURCES += main.cpp renderbench.cpp
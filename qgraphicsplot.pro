@@ -59,6 +59,10 @@ TEMPLATE = lib
 
 #DEFINES += DEBUG_PAINT=1
 
+# uncomment to remove the frame timing and trace instrumentation (see FrameTimings
+# and TraceRecorder)
+#DEFINES += QGRAPHICSPLOT_NO_TIMINGS
+
 CONFIG += release
 
 DEFINES += QT_NO_DEBUG_OUTPUT
@@ -133,17 +137,30 @@ PUBLICHEADERS= src/plotscenewidget.h \
     src/curve/painters/linepainter.h \
     src/curve/painters/stepspainter.h \
     src/curve/data.h \
+    src/curve/datapool.h \
            src/curve/painters/circleitemset.h \
     src/curve/painters/histogrampainter.h \
     src/scalelabelinterface.h \
     src/scalelabels/timescalelabel.h \
+    src/scalelabels/timelabelformatter.h \
     src/qgraphicszoomer.h \
     src/externalscalewidget.h \
     src/horizontalscalewidget.h \
     src/items/legenditem.h \
+    src/items/stripchartitem.h \
+    src/items/performancehuditem.h \
+    src/items/crosshairitem.h \
     src/verticalscalewidget.h \
     src/plotgeometryeventlistener.h \
     src/qgraphicsplotmacros.h \
+    src/refreshscheduler.h \
+    src/refreshcoordinator.h \
+    src/frametimings.h \
+    src/tracerecorder.h \
+    src/memorybudget.h \
+    src/doubleformatter.h \
+    src/plotsaver/csvexporter.h \
+    src/plotsaver/columnarfile.h \
     src/extscaleplotscenewidget/extscaleplotscenewidget.h \
     src/extscaleplotscenewidget/curvesmap.h
 
@@ -151,7 +168,9 @@ HPRIVATES = src/plotscenewidget_private.h \
            src/axes/scaleitemprivate.h \
            src/curve/curveitemprivate.h \
            src/curve/scenecurveprivate.h \
-           src/curve/pointprivate.h
+           src/curve/pointprivate.h \
+           src/curve/pointindex.h \
+           src/statictextcache.h
 
 HEADERS += $${HPRIVATES} \
     src/items/markeritemprivate.h \
@@ -181,7 +200,9 @@ SOURCES += src/plotscenewidget.cpp \
            src/properties/settingsloader.cpp \
     src/curve/point.cpp \
     src/curve/pointprivate.cpp \
+    src/curve/pointindex.cpp \
     src/curve/data.cpp \
+    src/curve/datapool.cpp \
     src/graphicsscene.cpp \
     src/curve/curveitem.cpp \
     src/curve/curveitemprivate.cpp \
@@ -199,14 +220,27 @@ SOURCES += src/plotscenewidget.cpp \
     src/curve/painters/histogrampainterprivate.cpp \
     src/scalelabelinterface.cpp \
     src/scalelabels/timescalelabel.cpp \
+    src/scalelabels/timelabelformatter.cpp \
     src/graphicsscene_private.cpp \
     src/qgraphicszoomer.cpp \
+    src/refreshscheduler.cpp \
+    src/refreshcoordinator.cpp \
+    src/frametimings.cpp \
+    src/tracerecorder.cpp \
+    src/memorybudget.cpp \
+    src/statictextcache.cpp \
+    src/doubleformatter.cpp \
     src/externalscalewidget.cpp \
     src/horizontalscalewidget.cpp \
     src/verticalscalewidget.cpp \
     src/colorpalette.cpp \
     src/items/legenditem.cpp \
+    src/items/stripchartitem.cpp \
+    src/items/performancehuditem.cpp \
+    src/items/crosshairitem.cpp \
     src/plotsaver/plotscenewidgetsaver.cpp \
+    src/plotsaver/csvexporter.cpp \
+    src/plotsaver/columnarfile.cpp \
     src/curve/painters/stepspainter.cpp \
     src/curve/painters/stepspainterprivate.cpp \
     src/extscaleplotscenewidget/extscaleplotscenewidget.cpp \
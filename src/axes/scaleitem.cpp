@@ -10,6 +10,8 @@
 #include <QDateTime>
 #include <QPainter>
 #include "plotscenewidget.h"
+#include "frametimings.h"
+#include "tracerecorder.h"
 
 #include "qgraphicsplotmacros.h"
 #include <math.h>
@@ -131,9 +133,7 @@ QString ScaleItem::label(double value) const
     if(d_ptr->scaleLabelInterface)
         return d_ptr->scaleLabelInterface->label(value);
 
-    QString l;
-    l.sprintf(qstoc(d_ptr->actualLabelsFormat), value);
-    return l;
+    return d_ptr->labelFormatter.format(value);
 }
 
 /** \brief Provide a custom label manager for the ScaleItem.
@@ -152,6 +152,7 @@ QString ScaleItem::label(double value) const
 void ScaleItem::installScaleLabelInterface(ScaleLabelInterface *iface)
 {
     d_ptr->scaleLabelInterface = iface;
+    clearLabelCache();
     this->updateLabelsCache();
     update();
 }
@@ -164,6 +165,8 @@ void ScaleItem::installScaleLabelInterface(ScaleLabelInterface *iface)
 void ScaleItem::removeScaleLabelInterface()
 {
     d_ptr->scaleLabelInterface = NULL;
+    clearLabelCache();
+    updateLabelsCache();
     update();
 }
 
@@ -186,6 +189,7 @@ void ScaleItem::removeAxisChangeListener(AxisChangeListener *l)
 
 void ScaleItem::setOrientation(Orientation o)
 {
+    mInvalidateLayer();
     d_ptr->orientation = o;
 }
 
@@ -515,6 +519,7 @@ double ScaleItem::axisLabelDist() const
 void ScaleItem::setAxisLabelDist(double d)
 {
     d_ptr->axisLabelDist = d;
+    mInvalidateLayer();
     scene()->update();
 }
 
@@ -540,6 +545,7 @@ void ScaleItem::setAxisLabelDist(double d)
 void ScaleItem::setAxisLabelsOutsideCanvas(bool outside)
 {
     d_ptr->axisLabelsOutsideCanvas = outside;
+    mInvalidateLayer();
     scene()->update();
     /// updateLabelsCache(); /* updates full scene */
 }
@@ -665,6 +671,7 @@ QColor ScaleItem::gridColor() const
 void ScaleItem::setFont(const QFont& f)
 {
     d_ptr->font = f;
+    clearLabelCache();
     updateLabelsCache();
     scene()->update();
 }
@@ -700,6 +707,8 @@ void ScaleItem::setAxisTitleFont(const QFont &fo)
 void ScaleItem::setAxisTitleColor(const QColor & co)
 {
     d_ptr->axisTitleColor = co;
+    mInvalidateLayer();
+    update();
 }
 
 void ScaleItem::setAxisTitle(const QString & ti)
@@ -826,6 +835,7 @@ void ScaleItem::mRecalculateAxisTitleSize()
     QFontMetrics fm(d_ptr->axisTitleFont);
     d_ptr->mAxisTitleHeight = fm.height();
     d_ptr->mAxisTitleWidth = fm.width(d_ptr->axisTitle);
+    mInvalidateLayer();
 }
 
 /* updates the actualLabelsFormat private variable.
@@ -857,6 +867,8 @@ void ScaleItem::updateLabelsFormat(const QString& desiredFormat)
     /* notify axis label format has changed */
     if(previousFormat != d_ptr->actualLabelsFormat)
     {
+        d_ptr->labelFormatter.setFormat(d_ptr->actualLabelsFormat);
+        clearLabelCache();
         foreach(AxisChangeListener *l, d_ptr->axisChangeListeners)
             l->labelsFormatChanged(d_ptr->actualLabelsFormat);
     }
@@ -869,6 +881,8 @@ void ScaleItem::updateLabelsFormat(const QString& desiredFormat)
  */
 void ScaleItem::updateLabelsCache()
 {
+    PLOT_TRACE_SCOPE("axis labels");
+    mInvalidateLayer();
     double x, x0 = 0;
     double max = 0.0;
     double width;
@@ -897,17 +911,15 @@ void ScaleItem::updateLabelsCache()
     if(associatedAxis && ok)
         x0 = x1 + (x2 - x1) * originPercent;
 
+    /* paint starts from the same tick, so that the labelsCacheHash keys match */
+    x0 = mFirstTick(x0, tickDist);
     x = x0;
     while(x <= x2)
     {
-        if(d_ptr->scaleLabelInterface)
-            textLabel = d_ptr->scaleLabelInterface->label(x);
-        else /* no, just return the number */
-            textLabel.sprintf(qstoc(d_ptr->actualLabelsFormat), x);
+        mLabel(x, tickDist, fm, textLabel, width);
         /* add item to cache */
         d_ptr->labelsCacheHash.insert(x, textLabel);
 
-        width = fm.width(textLabel);
         if(max < width)
         {
             max = width;
@@ -919,14 +931,10 @@ void ScaleItem::updateLabelsCache()
     x = x0 - tickDist;
     while(x >= x1)
     {
-        if(d_ptr->scaleLabelInterface)
-            textLabel = d_ptr->scaleLabelInterface->label(x);
-        else /* no, just return the number */
-            textLabel.sprintf(qstoc(d_ptr->actualLabelsFormat), x);
+        mLabel(x, tickDist, fm, textLabel, width);
         /* add item to cache */
         d_ptr->labelsCacheHash.insert(x, textLabel);
 
-        width = fm.width(textLabel);
         if(max < width)
         {
             max = width;
@@ -935,14 +943,118 @@ void ScaleItem::updateLabelsCache()
         x -= tickDist;
     }
     d_ptr->maxLabelWidth = max;
+    mEvictLabels();
+}
+
+/* returns the text and the width of the label of the tick x. Labels are kept across
+ * calls to updateLabelsCache, keyed on the tick lattice: only the ticks entering the
+ * view are formatted and measured.
+ */
+void ScaleItem::mLabel(double x, double tickDist, const QFontMetrics& fm, QString& text, double& width)
+{
+    ScaleItemLabelKey key;
+    key.step = tickDist;
+    key.index = tickDist > 0 ? qRound64(x / tickDist) : 0;
+    QHash<ScaleItemLabelKey, ScaleItemLabel>::iterator it = d_ptr->labelCache.find(key);
+    /* ticks are snapped on the lattice: allow for the rounding of the accumulated steps */
+    if(it == d_ptr->labelCache.end() || fabs(it.value().value - x) > tickDist * 1e-6)
+    {
+        ScaleItemLabel l;
+        l.value = x;
+        if(d_ptr->scaleLabelInterface)
+            l.text = d_ptr->scaleLabelInterface->label(x);
+        else /* no, just return the number */
+            l.text = d_ptr->labelFormatter.format(x);
+        l.width = fm.width(l.text);
+        it = d_ptr->labelCache.insert(key, l);
+        d_ptr->labelCacheMisses++;
+    }
+    else
+        d_ptr->labelCacheHits++;
+    it.value().lastUse = ++d_ptr->labelUseCount;
+    text = it.value().text;
+    width = it.value().width;
+}
+
+/* the first tick at or after origin lying on the lattice of the multiples of step.
+ * The origin follows the bounds of the axis when the view scrolls: ticks starting
+ * from it would get new values (and labels) at each scroll step.
+ */
+double ScaleItem::mFirstTick(double origin, double step) const
+{
+    if(step <= 0)
+        return origin;
+    return ceil(origin / step) * step;
+}
+
+/* drops the labels not used recently when the cache is full */
+void ScaleItem::mEvictLabels()
+{
+    if(d_ptr->labelCache.size() <= ScaleItemPrivate::labelCacheCapacity)
+        return;
+    unsigned long threshold = d_ptr->labelUseCount - ScaleItemPrivate::labelCacheCapacity / 2;
+    QHash<ScaleItemLabelKey, ScaleItemLabel>::iterator it = d_ptr->labelCache.begin();
+    while(it != d_ptr->labelCache.end())
+    {
+        if(it.value().lastUse <= threshold)
+            it = d_ptr->labelCache.erase(it);
+        else
+            ++it;
+    }
+}
+
+void ScaleItem::clearLabelCache()
+{
+    d_ptr->labelCache.clear();
+}
+
+unsigned long ScaleItem::labelCacheHits() const
+{
+    return d_ptr->labelCacheHits;
+}
+
+unsigned long ScaleItem::labelCacheMisses() const
+{
+    return d_ptr->labelCacheMisses;
 }
 
 void ScaleItem::redraw()
 {
     d_ptr->mNeedFullRedraw = true;
+    mInvalidateLayer();
     update();
 }
 
+/* the layer is rendered again at the next paint event */
+void ScaleItem::mInvalidateLayer()
+{
+    d_ptr->layerStamp++;
+}
+
+bool ScaleItem::cacheEnabled() const
+{
+    return d_ptr->cacheEnabled;
+}
+
+void ScaleItem::setCacheEnabled(bool en)
+{
+    d_ptr->cacheEnabled = en;
+    if(!en)
+        releaseLayer();
+    update();
+}
+
+unsigned long ScaleItem::layerMemoryUsage() const
+{
+    return d_ptr->layer.bytesPerLine() * d_ptr->layer.height();
+}
+
+void ScaleItem::releaseLayer()
+{
+    d_ptr->layer = QImage();
+    mInvalidateLayer();
+}
+
 /* recalculates the step len.
  * This method needs to be called when upper or lower bound changes or
  * when the plot zoom level changes.
@@ -997,21 +1109,27 @@ double ScaleItem::updateStepLen()
 
 void ScaleItem::setBoundsFromCurves()
 {
+    PLOT_TIMING_SCOPE(d_ptr->view->frameTimings(), FrameTimings::Bounds);
+    PLOT_TRACE_SCOPE("axis bounds");
     d_ptr->minMaxUnset = true;
-    QList<SceneCurve *> curves = d_ptr->view->curvesForAxes(d_ptr->axisId, d_ptr->orientation);
-    if(!curves.size())
-        return;
+    /* getCurves does not build a new list: filter the curves of this axis here
+     * rather than with curvesForAxes, that allocates at each paint.
+     */
+    QList<SceneCurve *> curves = d_ptr->view->getCurves();
     int i;
     double min = 0.0, max = 0.0, span;
     SceneCurve *c;
     Data *d ;
-    unsigned int visibleCurvesCnt = 0;
+    unsigned int visibleCurvesCnt = 0, axisCurvesCnt = 0;
     switch(d_ptr->orientation)
     {
     case Horizontal:
         for(i = 0; i < curves.size(); i++)
         {
             c = curves[i];
+            if(c->associatedXAxisId() != d_ptr->axisId)
+                continue;
+            axisCurvesCnt++;
             if(c->curveItem() && c->curveItem()->isVisible())
             {
                 d = c->data();
@@ -1027,6 +1145,9 @@ void ScaleItem::setBoundsFromCurves()
         for(i = 0; i < curves.size(); i++)
         {
             c = curves[i];
+            if(c->associatedYAxisId() != d_ptr->axisId)
+                continue;
+            axisCurvesCnt++;
             if(c->curveItem() && c->curveItem()->isVisible())
             {
                 d = c->data();
@@ -1039,6 +1160,8 @@ void ScaleItem::setBoundsFromCurves()
         }
         break;
     }
+    if(axisCurvesCnt == 0)
+        return;
     if(max >= min)
     {
         /* apply scale span adjustment (default is 2 % ) */
@@ -1092,8 +1215,9 @@ void ScaleItem::setBoundsFromCurves()
         perr("ScaleItem::setBoundsFromCurves: max %f < min %f", max, min);
 }
 
-void ScaleItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * option, QWidget *  )
+void ScaleItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * option, QWidget * widget)
 {
+    PLOT_TIMING_SCOPE(d_ptr->view->frameTimings(), FrameTimings::Axes);
     QPen axisPen(d_ptr->axisColor), gridPen(d_ptr->gridColor);
     axisPen.setWidthF(0.0);
     gridPen.setWidthF(0.0);
@@ -1108,7 +1232,7 @@ void ScaleItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * option
     painter->setClipRect(option->exposedRect.toRect());
     //    if(d_ptr->orientation == ScaleItem::Vertical)
     //        printf("\e[1;36mpaint [vertical](%s) z value %f\e[0m\n", qstoc(objectName()), zValue());
-    double x1, x2, y1, y2, x, y, x0, y0;
+    double x1, x2, y1, y2, x, y, x0, y0, tick0;
     qreal px,  py, px0, py0;
     /* initialize canvas rect, width and height to plot rect */
 
@@ -1147,6 +1271,8 @@ void ScaleItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * option
     QString textLabel;
     QRectF txtRect(0, 0, 0, 0);
     painter->setFont(d_ptr->font);
+    /* labels are drawn as QStaticText laid out with the same font */
+    d_ptr->labelTexts.setFont(d_ptr->font);
     QFontMetrics fm(painter->font());
     labelHeight = fm.height();
 
@@ -1264,6 +1390,64 @@ void ScaleItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * option
         canvasHeight = rect.height();
     }
 
+    /* the static layer. Not used when printing or rendering to other devices (no widget) */
+    QPainter *target = painter, layerPainter;
+    bool renderLayer = false;
+    if(d_ptr->cacheEnabled && widget)
+    {
+        ScaleItemLayerKey key;
+        key.x1 = x1;
+        key.x2 = x2;
+        key.y1 = y1;
+        key.y2 = y2;
+        key.x0 = x0;
+        key.y0 = y0;
+        key.tickStepLen = tickStepLen;
+        key.scaledRect = scaledRect;
+        key.transform = painter->worldTransform();
+        key.deviceRect = key.transform.mapRect(tran.mapRect(scene()->sceneRect())).toAlignedRect();
+#if QT_VERSION >= 0x050600
+        key.devicePixelRatio = painter->device()->devicePixelRatioF();
+#elif QT_VERSION >= 0x050000
+        key.devicePixelRatio = painter->device()->devicePixelRatio();
+#endif
+        key.stamp = d_ptr->layerStamp;
+        if(key == d_ptr->layerKey && !d_ptr->layer.isNull())
+        {
+            /* blit in device coordinates. The exposed rect clip still applies */
+            painter->save();
+            painter->setWorldTransform(QTransform());
+            painter->drawImage(key.deviceRect.topLeft(), d_ptr->layer);
+            painter->restore();
+            return;
+        }
+        /* render the layer only if the geometry has not changed since the previous
+         * paint: an axis that changes at each frame is drawn directly
+         */
+        renderLayer = (key == d_ptr->lastPaintKey) && !key.deviceRect.isEmpty();
+        d_ptr->lastPaintKey = key;
+        if(renderLayer)
+        {
+            /* one layer pixel per device pixel, so that the axis stays sharp on HiDPI
+             * screens. The painter of the layer scales by the device pixel ratio
+             */
+            QSize layerSize = QSize((int) ceil(key.deviceRect.width() * key.devicePixelRatio),
+                                    (int) ceil(key.deviceRect.height() * key.devicePixelRatio));
+            if(d_ptr->layer.size() != layerSize)
+                d_ptr->layer = QImage(layerSize, QImage::Format_ARGB32_Premultiplied);
+#if QT_VERSION >= 0x050000
+            d_ptr->layer.setDevicePixelRatio(key.devicePixelRatio);
+#endif
+            d_ptr->layer.fill(Qt::transparent);
+            layerPainter.begin(&d_ptr->layer);
+            layerPainter.setRenderHints(painter->renderHints());
+            layerPainter.setWorldTransform(key.transform * QTransform::fromTranslate(-key.deviceRect.x(), -key.deviceRect.y()));
+            layerPainter.setFont(d_ptr->font);
+            d_ptr->layerKey = key;
+            painter = &layerPainter;
+        }
+    }
+
     double prevx;
     switch(d_ptr->orientation)
     {
@@ -1295,9 +1479,10 @@ void ScaleItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * option
         painter->drawLine(mappedRectLeft, py0 , mappedRectRight, py0);
 
         /* draw ticks starting from origin */
-        d_ptr->mLastTickPos = (scaledRect.height() - 1) * (x0 - x1) / (x2 - x1) + mappedRectLeft;
+        tick0 = mFirstTick(x0, tickStepLen);
+        d_ptr->mLastTickPos = (scaledRect.width() - 1) * (tick0 - x1) / (x2 - x1) + mappedRectLeft;
 
-        x = x0;
+        x = tick0;
 
         while(x <= x2)
         {
@@ -1305,7 +1490,7 @@ void ScaleItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * option
 
             //            printf("\e[1;32m dist from prev %.10f\e[0m, ", px - prevx);
             prevx = px;
-            if(d_ptr->gridEnabled && x != x0)/* x != x0 not to draw grid over axes */
+            if(d_ptr->gridEnabled && fabs(x - x0) > tickStepLen * 1e-6)/* not to draw grid over axes */
             {
                 painter->setPen(gridPen);
                 painter->drawLine(px, mappedRectTop, px, mappedRectBottom);
@@ -1314,13 +1499,13 @@ void ScaleItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * option
             {
                 /* ScaleLabelInterface installed ? */
                 textLabel = d_ptr->labelsCacheHash.value(x);
-                if(px - fm.height() > d_ptr->mLastTickPos || x == x0)
+                if(px - fm.height() > d_ptr->mLastTickPos || x == tick0)
                 {
                     painter->setPen(axisPen);
                     txtRect.setRect(0, 0, d_ptr->maxLabelWidth, labelHeight);
                     painter->translate(px + labelHeight/2, labelPos + py0);
                     painter->rotate(d_ptr->axisLabelRotation);
-                    painter->drawText(txtRect, textLabel);
+                    painter->drawStaticText(txtRect.topLeft(), d_ptr->labelTexts.text(textLabel));
                     painter->rotate(-d_ptr->axisLabelRotation);
                     painter->translate(-px - labelHeight/2, -labelPos - py0);
                     d_ptr->mLastTickPos = px;
@@ -1331,7 +1516,7 @@ void ScaleItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * option
                     painter->translate(px + labelHeight/2, yZoomLabel);
                     painter->rotate(d_ptr->axisLabelRotation);
                     txtRect.setRect(0, 0, d_ptr->maxLabelWidth, labelHeight);
-                    painter->drawText(txtRect, textLabel);
+                    painter->drawStaticText(txtRect.topLeft(), d_ptr->labelTexts.text(textLabel));
                     painter->rotate(-d_ptr->axisLabelRotation);
                     painter->translate(-px - labelHeight/2, -yZoomLabel);
                 }
@@ -1343,8 +1528,8 @@ void ScaleItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * option
         //        printf("\e[0m\n");
 
         /* draw ticks from origin backwards */
-        d_ptr->mLastTickPos = (scaledRect.width() - 1) * (x0 - x1) / (x2 - x1) + mappedRectLeft;
-        x = x0 - tickStepLen;
+        d_ptr->mLastTickPos = (scaledRect.width() - 1) * (tick0 - x1) / (x2 - x1) + mappedRectLeft;
+        x = tick0 - tickStepLen;
         prevx = x1;
         while( x >= x1)
         {
@@ -1366,10 +1551,10 @@ void ScaleItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * option
                 if(px + fm.height() < d_ptr->mLastTickPos)
                 {
                     painter->setPen(axisPen);
-                    txtRect.setRect(0, 0, fm.width(textLabel), labelHeight);
+                    txtRect.setRect(0, 0, d_ptr->maxLabelWidth, labelHeight);
                     painter->translate(px + labelHeight/2.0, py0 + labelPos);
                     painter->rotate(d_ptr->axisLabelRotation);
-                    painter->drawText(txtRect, textLabel);
+                    painter->drawStaticText(txtRect.topLeft(), d_ptr->labelTexts.text(textLabel));
                     painter->rotate(-d_ptr->axisLabelRotation);
                     painter->translate(-px - labelHeight/2.0, -py0 - labelPos);
                     d_ptr->mLastTickPos = px;
@@ -1380,7 +1565,7 @@ void ScaleItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * option
                     painter->translate(px + labelHeight/2.0, yZoomLabel);
                     txtRect.setRect(0, 0, d_ptr->maxLabelWidth, labelHeight);
                     painter->rotate(d_ptr->axisLabelRotation);
-                    painter->drawText(txtRect, textLabel);
+                    painter->drawStaticText(txtRect.topLeft(), d_ptr->labelTexts.text(textLabel));
                     painter->rotate(-d_ptr->axisLabelRotation);
                     painter->translate(-px - labelHeight/2.0, -yZoomLabel);
                 }
@@ -1432,15 +1617,15 @@ void ScaleItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * option
         painter->setPen(axisPen);
         painter->drawLine(px0, mappedRectTop , px0, mappedRectBottom);
 
-        d_ptr->mLastTickPos = scaledRect.height() - 1 - ((scaledRect.height() - 1) * (y0 - y1) / (y2 - y1) + mappedRectTop);
-
         /* draw ticks starting from origin */
-        y = y0;
+        tick0 = mFirstTick(y0, tickStepLen);
+        d_ptr->mLastTickPos = scaledRect.height() - 1 - ((scaledRect.height() - 1) * (tick0 - y1) / (y2 - y1) + mappedRectTop);
+        y = tick0;
         while(y <= y2)
         {
             py = (scaledRect.height() - 1) - ((scaledRect.height() - 1) * (y - y1) / (y2 - y1) + mappedRectTop);
 
-            if(d_ptr->gridEnabled && y != y0) /* y != y0 not to draw grid over axes */
+            if(d_ptr->gridEnabled && fabs(y - y0) > tickStepLen * 1e-6) /* not to draw grid over axes */
             {
                 painter->setPen(gridPen);
                 painter->drawLine(mappedRectLeft, py, mappedRectRight, py);
@@ -1455,11 +1640,11 @@ void ScaleItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * option
                 txtRect.setRect(labelPos, -labelHeight/2, d_ptr->maxLabelWidth, fm.height());
 
                 /* less than when  y positive, due to inverted Qt coordinate system for y axis */
-                if(py + fm.height() < d_ptr->mLastTickPos || y == y0)
+                if(py + fm.height() < d_ptr->mLastTickPos || y == tick0)
                 {
                     painter->translate(px0, py);
                     painter->rotate(d_ptr->axisLabelRotation);
-                    painter->drawText(txtRect, textLabel);
+                    painter->drawStaticText(txtRect.topLeft(), d_ptr->labelTexts.text(textLabel));
                     painter->rotate(-d_ptr->axisLabelRotation);
                     painter->translate(-px0, -py);
                     d_ptr->mLastTickPos = py;
@@ -1471,7 +1656,7 @@ void ScaleItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * option
                 painter->translate(xZoomLabel, py);
                 painter->rotate(d_ptr->axisLabelRotation);
                 txtRect.setRect(0, 0, d_ptr->maxLabelWidth, labelHeight);
-                painter->drawText(txtRect, textLabel);
+                painter->drawStaticText(txtRect.topLeft(), d_ptr->labelTexts.text(textLabel));
                 painter->rotate(-d_ptr->axisLabelRotation);
                 painter->translate(-xZoomLabel, -py);
             }
@@ -1479,9 +1664,9 @@ void ScaleItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * option
             y = y + tickStepLen;
         }
 
-        d_ptr->mLastTickPos = scaledRect.height() - 1 - ((scaledRect.height() - 1) * (y0 - y1) / (y2 - y1) + mappedRectTop);
+        d_ptr->mLastTickPos = scaledRect.height() - 1 - ((scaledRect.height() - 1) * (tick0 - y1) / (y2 - y1) + mappedRectTop);
         /* draw ticks from origin backwards */
-        y = y0 - tickStepLen;
+        y = tick0 - tickStepLen;
         while(y >= y1)
         {
             /* y axis direction is inverted with respect to Qt coordinates system.
@@ -1501,14 +1686,14 @@ void ScaleItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * option
             if(d_ptr->labelsEnabled)
             {
                 textLabel = d_ptr->labelsCacheHash.value(y);
-                txtRect.setRect(labelPos, -labelHeight/2, fm.width(textLabel), labelHeight);
+                txtRect.setRect(labelPos, -labelHeight/2, d_ptr->maxLabelWidth, labelHeight);
                 /* > due to inverted Qt coordinate system for y axis
                  */
                 if(py - labelHeight > d_ptr->mLastTickPos)
                 {
                     painter->translate(px0, py);
                     painter->rotate(d_ptr->axisLabelRotation);
-                    painter->drawText(txtRect, textLabel);
+                    painter->drawStaticText(txtRect.topLeft(), d_ptr->labelTexts.text(textLabel));
                     painter->rotate(-d_ptr->axisLabelRotation);
                     painter->translate(-px0, -py);
                     d_ptr->mLastTickPos = py;
@@ -1519,7 +1704,7 @@ void ScaleItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * option
                 painter->setPen(d_ptr->gridColor.darker());
                 painter->translate(xZoomLabel, py);
                 txtRect.setRect(0, 0, d_ptr->maxLabelWidth, labelHeight);
-                painter->drawText(txtRect, textLabel);
+                painter->drawStaticText(txtRect.topLeft(), d_ptr->labelTexts.text(textLabel));
                 painter->translate(-xZoomLabel, -py);
 
             }
@@ -1566,6 +1751,15 @@ void ScaleItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * option
     painter->drawRect(scaledRect);
 
     */
+
+    if(renderLayer)
+    {
+        layerPainter.end();
+        target->save();
+        target->setWorldTransform(QTransform());
+        target->drawImage(d_ptr->layerKey.deviceRect.topLeft(), d_ptr->layer);
+        target->restore();
+    }
 }
 
 QRectF ScaleItem::boundingRect () const
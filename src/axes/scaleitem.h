@@ -11,6 +11,7 @@ class PlotSceneWidget;
 class AxisChangeListener;
 class ScaleLabelInterface;
 class QDateTime;
+class QFontMetrics;
 
 
 /** \brief The QGraphicsObject that draws a plot scale on a PlotSceneWidget
@@ -39,6 +40,7 @@ class QDateTime;
   * \li axisLabelsEnabled enables or disables the text labels on the axis.
   * \li gridEnabled shows or hides the grid on the plot
   * \li axisLabelsFormat the format of the number to display on the axis (it's printf() format)
+  *     "%r" displays the shortest representation of each value, see DoubleFormatter.
   * \li upperBound sets the upper bound on the scale item. axisAutoscaleEnabled must be set to false
   * \li lowerBound sets the lower bound on the scale item. axisAutoscaleEnabled must be set to false
   * \li axisAutoscaleEnabled enables or disables auto scaling.
@@ -66,6 +68,7 @@ Q_OBJECT
     Q_PROPERTY(double axisLabelDist READ axisLabelDist WRITE setAxisLabelDist)
     Q_PROPERTY(bool axisLabelsOutsideCanvas READ axisLabelsOutsideCanvas WRITE setAxisLabelsOutsideCanvas)
     Q_PROPERTY(QFont font READ font WRITE setFont)
+    Q_PROPERTY(bool cacheEnabled READ cacheEnabled WRITE setCacheEnabled)
     Q_PROPERTY(qreal zValue READ zValue WRITE setZValue)
 
 public:
@@ -188,6 +191,26 @@ public:
 
     double autoscaleMargin() const;
 
+    bool cacheEnabled() const;
+
+    /** \brief the memory, in bytes, used by the cached layer, 0 if the cache is disabled
+     *         or the layer has not been rendered yet.
+     */
+    unsigned long layerMemoryUsage() const;
+
+    /** \brief frees the cached layer. If the cache is enabled, the layer is rendered
+     *         again at the next paint event.
+     */
+    void releaseLayer();
+
+    /** \brief the number of labels taken from the label cache by updateLabelsCache
+     */
+    unsigned long labelCacheHits() const;
+
+    /** \brief the number of labels formatted and measured by updateLabelsCache
+     */
+    unsigned long labelCacheMisses() const;
+
 public slots:
 
     void setTickStepLen(double len);
@@ -232,8 +255,43 @@ public slots:
 
     void setAxisTitle(const QString & ti);
 
+    /** \brief rebuilds the labels of the ticks in view
+     *
+     * Labels are kept across calls, keyed on the tick step and the tick index, together
+     * with their measured width: when the bounds change, only the ticks entering the
+     * view are formatted and measured. The least recently used labels are dropped.
+     */
     void updateLabelsCache();
 
+    /** \brief drops all the labels kept by updateLabelsCache.
+     *
+     * The cache is cleared automatically when the labels format, the font or the
+     * ScaleLabelInterface change. Call it if the output of the installed
+     * ScaleLabelInterface changes for the same value, for instance after
+     * TimeScaleLabel::setShowDate, then call updateLabelsCache.
+     */
+    void clearLabelCache();
+
+    /** \brief enables or disables the cached layer of the axis
+     *
+     * @param en true (default) the grid, the axis line, the ticks, the labels and the
+     *        title are rendered into an offscreen image that is blitted on the following
+     *        paint events, as long as the bounds of the axis and of its associated axis,
+     *        the tick step, the canvas, the view transform and the style do not change.
+     * @param en false the axis is drawn on each paint event.
+     *
+     * The layer is rendered only once the axis geometry is the same as at the
+     * previous paint: while the bounds change at every frame, as with autoscale on
+     * streaming data, the axis is drawn directly and no time is spent on the layer.
+     * Printing and rendering to other devices through QGraphicsScene::render always
+     * draw directly.
+     *
+     * The layer is as large as the scene rect in device coordinates.
+     *
+     * @see PlotSceneWidget::setLayeredRendering
+     */
+    void setCacheEnabled(bool en);
+
 signals:
 
     /** \brief this signal is emitted when the axis upper bound changes
@@ -281,6 +339,14 @@ private:
 
     void mRecalculateAxisTitleSize();
 
+    void mInvalidateLayer();
+
+    void mLabel(double x, double tickDist, const QFontMetrics& fm, QString& text, double& width);
+
+    double mFirstTick(double origin, double step) const;
+
+    void mEvictLabels();
+
 
     Q_DECLARE_PRIVATE(ScaleItem)
 };
@@ -30,4 +30,9 @@ ScaleItemPrivate::ScaleItemPrivate()
 
     mNeedFullRedraw = false;
     minMaxUnset = true;
+
+    labelUseCount = labelCacheHits = labelCacheMisses = 0;
+
+    cacheEnabled = true;
+    layerStamp = 1;
 }
@@ -2,15 +2,81 @@
 #define SCALEITEMPRIVATE_H
 
 #include "scaleitem.h"
+#include "statictextcache.h"
+#include "doubleformatter.h"
+#include <string.h>
 #include <QPen>
 #include <QList>
 #include <QRectF>
 #include <QFont>
 #include <QMap>
+#include <QHash>
+#include <QImage>
+#include <QTransform>
 
 class AxisChangeListener;
 class ScaleLabelInterface;
 
+/* what the static layer of a ScaleItem depends on, besides the style */
+class ScaleItemLayerKey
+{
+public:
+    ScaleItemLayerKey() : x1(0), x2(0), y1(0), y2(0), x0(0), y0(0), tickStepLen(0),
+        devicePixelRatio(1.0), stamp(0) {}
+
+    double x1, x2, y1, y2, x0, y0, tickStepLen;
+
+    QRectF scaledRect;
+
+    QTransform transform;
+
+    QRect deviceRect;
+
+    /* device pixels per logical pixel of the paint device (HiDPI screens) */
+    qreal devicePixelRatio;
+
+    /* incremented each time the style or the labels change */
+    unsigned long stamp;
+
+    bool operator==(const ScaleItemLayerKey& o) const
+    {
+        return stamp == o.stamp && x1 == o.x1 && x2 == o.x2 && y1 == o.y1 && y2 == o.y2 &&
+                x0 == o.x0 && y0 == o.y0 && tickStepLen == o.tickStepLen &&
+                scaledRect == o.scaledRect && transform == o.transform && deviceRect == o.deviceRect &&
+                devicePixelRatio == o.devicePixelRatio;
+    }
+};
+
+/* a tick on the lattice k * step: the step and the index k */
+class ScaleItemLabelKey
+{
+public:
+    double step;
+
+    qint64 index;
+
+    bool operator==(const ScaleItemLabelKey& o) const { return index == o.index && step == o.step; }
+};
+
+inline uint qHash(const ScaleItemLabelKey& k)
+{
+    quint64 bits;
+    memcpy(&bits, &k.step, sizeof(bits));
+    return qHash(bits) ^ qHash(k.index);
+}
+
+/* a formatted and measured label */
+class ScaleItemLabel
+{
+public:
+    double value, width;
+
+    QString text;
+
+    /* value of ScaleItemPrivate::labelUseCount when the label was last used */
+    unsigned long lastUse;
+};
+
 class ScaleItemPrivate
 {
 public:
@@ -34,6 +100,9 @@ public:
 
     QString axisLabelsFormat,  actualLabelsFormat, axisTitle;
 
+    /* actualLabelsFormat, parsed */
+    DoubleFormatter labelFormatter;
+
     bool gridEnabled, autoScale;
 
     QColor gridColor, axisColor, axisTitleColor;
@@ -64,9 +133,29 @@ public:
 
     QMap<double, QString> labelsCacheHash;
 
+    /* labels formatted so far, least recently used evicted beyond labelCacheCapacity */
+    QHash<ScaleItemLabelKey, ScaleItemLabel> labelCache;
+
+    unsigned long labelUseCount, labelCacheHits, labelCacheMisses;
+
+    static const int labelCacheCapacity = 512;
+
     QFont font, axisTitleFont;
 
+    /* the labels laid out with font, see ScaleItem::paint */
+    StaticTextCache labelTexts;
+
     int plotZoomLevel;
+
+    /* static layer: the grid, the axis, the labels and the title */
+    bool cacheEnabled;
+
+    QImage layer;
+
+    /* layerKey: the key of the rendered layer. lastPaintKey: the key of the last paint */
+    ScaleItemLayerKey layerKey, lastPaintKey;
+
+    unsigned long layerStamp;
 };
 
 
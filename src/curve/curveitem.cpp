@@ -6,8 +6,13 @@
 #include "data.h"
 #include "pointdata.h"
 #include "itempainterinterface.h"
+#include "frametimings.h"
+#include "tracerecorder.h"
+#include "plotscenewidget.h"
+#include "refreshscheduler.h"
 #include <QtDebug>
 #include <QStyleOptionGraphicsItem>
+#include <QPainter>
 
 /** \brief The constructor of this QGraphicsObject that connects the elements
            of the associated SceneCurve by means of lines.
@@ -59,12 +64,16 @@ QList<ItemPainterInterface *> CurveItem::itemPainters() const
 void CurveItem::installItemPainterInterface(ItemPainterInterface *itemPainterInterface)
 {
     d_ptr->itemPainters.append(itemPainterInterface);
+    invalidateBoundingRect();
 }
 
 void CurveItem::removeItemPainterInterface(ItemPainterInterface *itemPainterInterface)
 {
     if(d_ptr->itemPainters.contains(itemPainterInterface))
+    {
         d_ptr->itemPainters.removeAll(itemPainterInterface);
+        invalidateBoundingRect();
+    }
 }
 
 /* we are ItemChangeListeners, itemAdded is invoked after  SceneCurve::addPoint(XYItem *item)
@@ -91,9 +100,9 @@ void CurveItem::itemAdded(const Point &)
     ScaleItem *xScale = d_ptr->curve->getXAxis();
     ScaleItem *yScale =d_ptr->curve->getYAxis();
 
-    if(data->xData.last() < xScale->upperBound() &&
-            data->yData.last() < yScale->upperBound() &&
-            data->yData.last() > yScale->lowerBound())
+    /* the new segment grows the bounding rect and is the only region to update. If the
+     * axes change because of the new point, the curve is invalidated by the axes
+     */
     {
         double x1, x2, y1, y2;
 
@@ -114,15 +123,18 @@ void CurveItem::itemAdded(const Point &)
         QPointF topLeft(qMin(x1, x2), qMin(y1, y2));
         QPointF botRight(qMax(x1, x2), qMax(y1, y2));
         QRectF updateRect(topLeft, botRight);
+        if(scene()) /* the segment may lie partly outside the canvas */
+            updateRect = updateRect.intersected(scene()->sceneRect());
         d_ptr->updateRect = updateRect;
-        update(updateRect);
-
-//        qDebug() << __FUNCTION__ << ":-) partial update possible";
-    }
-    else if(itemCnt > 1)
-    {
-//        qDebug() << __FUNCTION__ << ":-( partial update NOT possible";
-        update();
+        /* the bounding rect only grows here, without projecting the whole curve:
+         * it is shrunk when it is calculated again
+         */
+        if(d_ptr->boundingRectValid && !updateRect.isEmpty() && !d_ptr->boundingRect.contains(updateRect))
+        {
+            prepareGeometryChange();
+            d_ptr->boundingRect |= updateRect;
+        }
+        mScheduleUpdate(updateRect, false);
     }
 }
 
@@ -165,14 +177,137 @@ void CurveItem::itemAboutToBeRemoved(const Point &)
 
 void CurveItem::fullVectorUpdate()
 {
-    update();
+    invalidateBoundingRect();
 }
 
+/** \brief returns the bounding rect of the projected curve points, enlarged by the
+ *         element size of the installed item painters.
+ *
+ * The rect is cached and calculated again when invalidateBoundingRect is called.
+ */
 QRectF CurveItem::boundingRect() const
+{
+    return d_ptr->boundingRect;
+}
+
+void CurveItem::invalidateBoundingRect()
+{
+    d_ptr->boundingRectValid = false;
+    mScheduleUpdate(QRectF(), true);
+}
+
+void CurveItem::mScheduleUpdate(const QRectF &rect, bool full)
+{
+    d_ptr->updateRequestCount++;
+    if(full)
+        d_ptr->fullUpdatePending = true;
+    else
+        d_ptr->dirtyRect |= rect;
+    PlotSceneWidget *plot = d_ptr->curve->plot();
+    if(plot->manualSceneUpdate() && plot->refreshScheduler() && plot->refreshScheduler()->isRunning())
+    {
+        /* a running scheduler flushes once per frame: no event is posted per request */
+        d_ptr->flushScheduled = true;
+        if(full)
+            plot->requestRefresh();
+        else
+            plot->requestRefresh(mapRectToScene(rect));
+    }
+    else if(!d_ptr->flushScheduled)
+    {
+        d_ptr->flushScheduled = true;
+        QMetaObject::invokeMethod(this, "flushUpdates", Qt::QueuedConnection);
+    }
+}
+
+void CurveItem::flushUpdates()
+{
+    d_ptr->flushScheduled = false;
+    if(!scene())
+        return;
+    if(!d_ptr->boundingRectValid)
+        mUpdateBoundingRect();
+
+    QRectF r;
+    if(d_ptr->fullUpdatePending)
+        r = d_ptr->boundingRect;
+    else
+        r = d_ptr->dirtyRect.intersected(d_ptr->boundingRect);
+    d_ptr->fullUpdatePending = false;
+    d_ptr->dirtyRect = QRectF();
+
+    if(!r.isEmpty())
+    {
+        QRectF sr = scene()->sceneRect();
+        update(r);
+        d_ptr->updateCount++;
+        d_ptr->updatedArea += r.width() * r.height();
+        d_ptr->savedArea += sr.width() * sr.height() - r.width() * r.height();
+    }
+}
+
+void CurveItem::mUpdateBoundingRect()
 {
     QRectF br;
-    br = scene()->sceneRect();
-    return br;
+    /* painters that do not draw around the points (histograms, custom painters)
+     * need the whole scene rect, as in the past.
+     */
+    bool tight = true;
+    foreach(ItemPainterInterface* i, d_ptr->itemPainters)
+        if(i->type() != ItemPainterInterface::Line && i->type() != ItemPainterInterface::Dot &&
+                i->type() != ItemPainterInterface::Cross && i->type() != ItemPainterInterface::Step &&
+                i->type() != ItemPainterInterface::CircleItemSet)
+            tight = false;
+
+    if(!tight)
+        br = scene()->sceneRect();
+    else if(d_ptr->curve->dataSize() > 0 && d_ptr->curve->points() != NULL)
+    {
+        /* item painters may need extra space to take into account. The minimum
+         * accounts for antialiasing and for the ellipses drawn when the curve
+         * has very few points.
+         */
+        double extraX = 4.0, extraY = 4.0;
+        foreach(ItemPainterInterface* i, d_ptr->itemPainters)
+        {
+            extraX = qMax(extraX, i->elementSize().width() + 1.0);
+            extraY = qMax(extraY, i->elementSize().height() + 1.0);
+        }
+        br = d_ptr->curve->pointsBoundingRect().adjusted(-extraX, -extraY, extraX, extraY);
+        br = br.intersected(scene()->sceneRect());
+    }
+    if(br != d_ptr->boundingRect)
+    {
+        prepareGeometryChange();
+        d_ptr->boundingRect = br;
+    }
+    d_ptr->boundingRectValid = true;
+}
+
+unsigned long CurveItem::updateRequestCount() const
+{
+    return d_ptr->updateRequestCount;
+}
+
+unsigned long CurveItem::updateCount() const
+{
+    return d_ptr->updateCount;
+}
+
+double CurveItem::updatedArea() const
+{
+    return d_ptr->updatedArea;
+}
+
+double CurveItem::savedArea() const
+{
+    return d_ptr->savedArea;
+}
+
+void CurveItem::resetUpdateStats()
+{
+    d_ptr->updateRequestCount = d_ptr->updateCount = 0;
+    d_ptr->updatedArea = d_ptr->savedArea = 0.0;
 }
 
 void CurveItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
@@ -186,13 +321,34 @@ void CurveItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
      */
     painter->setClipRect(option->exposedRect.toRect());
 
-    if(d_ptr->itemPainters.size())
+    /* in scroll render mode the curves are drawn by the StripChartItem */
+    if(d_ptr->curve->plot()->scrollRenderMode())
+        return;
+
+    if(d_ptr->itemPainters.isEmpty())
+        perr("CurveItem::paint(): no item painters installed!");
+    else if(d_ptr->cacheEnabled)
+    {
+        if(!mLayerUpToDate(painter->worldTransform()))
+            mRenderLayer(painter, option, widget);
+        /* blit the layer in device coordinates. The clip rect set above still applies */
+        painter->save();
+        painter->setWorldTransform(QTransform());
+        painter->drawImage(d_ptr->layerDeviceRect.topLeft(), d_ptr->layer);
+        painter->restore();
+    }
+    else
     {
+        FrameTimings *timings = d_ptr->curve->plot()->frameTimings();
+        /* project here, so that the Projection stage is not counted by the painter stages too */
+        d_ptr->curve->points();
         foreach(ItemPainterInterface* ipi, d_ptr->itemPainters)
+        {
+            PLOT_TIMING_SCOPE(timings, FrameTimings::painterStage(ipi->type()));
+            PLOT_TRACE_SCOPE(TraceRecorder::painterEventName(ipi->type()));
             ipi->draw(d_ptr->curve, d_ptr->curve->plot(), painter, option, widget);
+        }
     }
-    else
-        perr("CurveItem::paint(): no item painters installed!");
 
     #ifdef DEBUG_PAINT
 
@@ -214,3 +370,83 @@ void CurveItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
 
 
 
+
+bool CurveItem::cacheEnabled() const
+{
+    return d_ptr->cacheEnabled;
+}
+
+void CurveItem::setCacheEnabled(bool en)
+{
+    d_ptr->cacheEnabled = en;
+    if(!en)
+        d_ptr->layer = QImage();
+    invalidateCache();
+}
+
+unsigned long CurveItem::layerMemoryUsage() const
+{
+    return d_ptr->layer.bytesPerLine() * d_ptr->layer.height();
+}
+
+void CurveItem::releaseLayer()
+{
+    d_ptr->layer = QImage();
+    d_ptr->layerValid = false;
+}
+
+void CurveItem::invalidateCache()
+{
+    d_ptr->layerValid = false;
+    update();
+}
+
+/* the layer is valid as long as the data generation, the axes bounds, the canvas
+ * rect and the transformation to device coordinates are the same it was rendered with.
+ */
+bool CurveItem::mLayerUpToDate(const QTransform &deviceTransform) const
+{
+    ScaleItem *xScale = d_ptr->curve->getXAxis();
+    ScaleItem *yScale = d_ptr->curve->getYAxis();
+    return d_ptr->layerValid && !d_ptr->layer.isNull() &&
+            d_ptr->layerGeneration == d_ptr->curve->data()->generation() &&
+            d_ptr->layerXlb == xScale->lowerBound() && d_ptr->layerXub == xScale->upperBound() &&
+            d_ptr->layerYlb == yScale->lowerBound() && d_ptr->layerYub == yScale->upperBound() &&
+            d_ptr->layerCanvasRect == xScale->canvasRect() &&
+            d_ptr->layerTransform == deviceTransform &&
+            d_ptr->layerDeviceRect == deviceTransform.mapRect(boundingRect()).toAlignedRect();
+}
+
+void CurveItem::mRenderLayer(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    ScaleItem *xScale = d_ptr->curve->getXAxis();
+    ScaleItem *yScale = d_ptr->curve->getYAxis();
+    QTransform deviceTransform = painter->worldTransform();
+    QRectF br = boundingRect();
+    QRect deviceRect = deviceTransform.mapRect(br).toAlignedRect();
+
+    if(d_ptr->layer.size() != deviceRect.size())
+        d_ptr->layer = QImage(deviceRect.size(), QImage::Format_ARGB32_Premultiplied);
+    d_ptr->layer.fill(Qt::transparent);
+
+    /* render the whole item, not only the exposed rect, so that the layer can be reused */
+    QStyleOptionGraphicsItem layerOption(*option);
+    layerOption.exposedRect = br;
+    QPainter layerPainter(&d_ptr->layer);
+    layerPainter.setRenderHints(painter->renderHints());
+    layerPainter.setWorldTransform(deviceTransform * QTransform::fromTranslate(-deviceRect.x(), -deviceRect.y()));
+    layerPainter.setClipRect(br);
+    foreach(ItemPainterInterface* ipi, d_ptr->itemPainters)
+        ipi->draw(d_ptr->curve, d_ptr->curve->plot(), &layerPainter, &layerOption, widget);
+    layerPainter.end();
+
+    d_ptr->layerDeviceRect = deviceRect;
+    d_ptr->layerGeneration = d_ptr->curve->data()->generation();
+    d_ptr->layerXlb = xScale->lowerBound();
+    d_ptr->layerXub = xScale->upperBound();
+    d_ptr->layerYlb = yScale->lowerBound();
+    d_ptr->layerYub = yScale->upperBound();
+    d_ptr->layerCanvasRect = xScale->canvasRect();
+    d_ptr->layerTransform = deviceTransform;
+    d_ptr->layerValid = true;
+}
@@ -52,6 +52,7 @@ class CurveItem : public QGraphicsObject, public CurveChangeListener
 
     Q_PROPERTY(bool visible READ isVisible WRITE setVisible)
     Q_PROPERTY(qreal zValue READ zValue WRITE setZValue)
+    Q_PROPERTY(bool cacheEnabled READ cacheEnabled WRITE setCacheEnabled)
 
     Q_OBJECT
 public:
@@ -94,6 +95,84 @@ public:
 
     ItemPainterInterface *itemPainter() const;
 
+    bool cacheEnabled() const;
+
+    /** \brief the memory, in bytes, used by the raster layer, 0 if the cache is disabled
+     *         or the layer has not been rendered yet.
+     */
+    unsigned long layerMemoryUsage() const;
+
+    /** \brief frees the raster layer. If the cache is enabled, the layer is rendered
+     *         again at the next paint.
+     */
+    void releaseLayer();
+
+    /** \brief marks the bounding rect as invalid and schedules a full update of the item.
+     *
+     * The bounding rect is calculated again from the projection of the curve points
+     * before the next coalesced update is submitted to the scene.
+     * SceneCurve calls this method whenever its points cache is invalidated.
+     */
+    void invalidateBoundingRect();
+
+    /** \brief the number of update requests (one per added point or per full update)
+     *         received since the last call to resetUpdateStats
+     */
+    unsigned long updateRequestCount() const;
+
+    /** \brief the number of coalesced updates actually submitted to the scene
+     */
+    unsigned long updateCount() const;
+
+    /** \brief the total area, in scene coordinates, of the updates submitted to the scene
+     */
+    double updatedArea() const;
+
+    /** \brief the area, in scene coordinates, saved with respect to updating the whole
+     *         scene rect at each submitted update, as CurveItem used to do.
+     */
+    double savedArea() const;
+
+    void resetUpdateStats();
+
+public slots:
+
+    /** \brief enables or disables the raster layer cache of the curve
+     *
+     * @param en true the curve is rendered once into an offscreen QImage that is
+     *        simply blitted on the subsequent paint events, as long as the curve data,
+     *        the x and y axes bounds, the canvas rect and the view transform do not change.
+     * @param en false (default) the item painters draw the curve on each paint event.
+     *
+     * The cache pays off when the scene is often repainted for reasons that do not
+     * involve the curve, for instance when a MarkerItem is moved or the zoom rectangle
+     * is being drawn.
+     *
+     * \note If you change the appearance of an ItemPainterInterface that does not
+     * call invalidateCache by itself, call invalidateCache afterwards.
+     *
+     * @see invalidateCache
+     * @see PlotSceneWidget::setLayeredRendering
+     */
+    void setCacheEnabled(bool en);
+
+    /** \brief marks the raster layer as invalid and schedules an update of the item
+     *
+     * The next paint event renders the curve again through the installed item painters.
+     *
+     * @see setCacheEnabled
+     */
+    void invalidateCache();
+
+    /** \brief submits to the scene a single update for the dirty region accumulated
+     *         since the last flush.
+     *
+     * When the plot is refreshed by a running RefreshScheduler (manualSceneUpdate),
+     * the scheduler calls it once per frame, before the scene is updated. Otherwise
+     * it is invoked once per event loop iteration after one or more update requests.
+     */
+    void flushUpdates();
+
 protected:
     /** \brief draws the lines connecting the XYItems in the associated curve
       *
@@ -103,6 +182,14 @@ protected:
 
 private:
 
+    void mScheduleUpdate(const QRectF& rect, bool full);
+
+    void mUpdateBoundingRect();
+
+    bool mLayerUpToDate(const QTransform& deviceTransform) const;
+
+    void mRenderLayer(QPainter *painter, const QStyleOptionGraphicsItem * option, QWidget * widget);
+
     Q_DECLARE_PRIVATE(CurveItem)
 
     CurveItemPrivate *d_ptr;
@@ -2,5 +2,12 @@
 
 CurveItemPrivate::CurveItemPrivate()
 {
+    cacheEnabled = false;
+    layerValid = false;
+    layerGeneration = 0;
+    layerXlb = layerXub = layerYlb = layerYub = 0.0;
+    boundingRectValid = fullUpdatePending = flushScheduled = false;
+    updateRequestCount = updateCount = 0;
+    updatedArea = savedArea = 0.0;
 
 }
@@ -6,6 +6,8 @@ class SceneCurve;
 #include <QRectF>
 #include <QPen>
 #include <QList>
+#include <QImage>
+#include <QTransform>
 
 class ItemPainterInterface;
 
@@ -20,6 +22,32 @@ public:
 
     QList<ItemPainterInterface *>itemPainters;
 
+    /* cached bounding rect and dirty region accumulated until the next flush */
+    QRectF boundingRect, dirtyRect;
+
+    bool boundingRectValid, fullUpdatePending, flushScheduled;
+
+    /* repaint statistics */
+    unsigned long updateRequestCount, updateCount;
+
+    double updatedArea, savedArea;
+
+    /* raster layer cache: see CurveItem::setCacheEnabled */
+    bool cacheEnabled, layerValid;
+
+    QImage layer;
+
+    QRect layerDeviceRect;
+
+    /* the key the layer was rendered with */
+    unsigned int layerGeneration;
+
+    double layerXlb, layerXub, layerYlb, layerYub;
+
+    QRectF layerCanvasRect;
+
+    QTransform layerTransform;
+
 };
 
 #endif // CURVEITEMPRIVATE_H
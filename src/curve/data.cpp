@@ -1,9 +1,11 @@
 #include "data.h"
 #include "scenecurve.h"
+#include "datapool.h"
 #include "../qgraphicsplotmacros.h"
 #include <math.h>
 
 #include <QtDebug>
+#include <QtAlgorithms>
 
 using namespace std;
 
@@ -12,16 +14,22 @@ Data::Data()
     lastValidXPos = lastValidYPos = -1;
     xMinMaxUnset = yMinMaxUnset = true;
     mXDataChanged = mYDataChanged = false;
+    mGeneration = mResetGeneration = mEvictionGeneration = 0;
+    mIngestedCount = 0;
     xMin = xMax = 0.0;
     yMin = yMax = 0.0;
     scalarMode = true;
     xDataOrdered = true;
     yDataOrdered = false;
+    DataPool::instance()->registerData(this);
 }
 
 Data::~Data()
 {
-    printf("\e[1;31mdata destroyed\e[0m\n");
+    DataPool *pool = DataPool::instance();
+    pool->unregisterData(this);
+    pool->release(xData);
+    pool->release(yData);
 }
 
 void Data::resetMaxMin()
@@ -32,6 +40,7 @@ void Data::resetMaxMin()
 void Data::setData(const QVector<double> &vx, const QVector<double> &vy)
 {
     scalarMode = false;
+    mIngestedCount += vy.size();
     if(vx != xData)
     {
         lastValidXPos = -1;
@@ -49,6 +58,8 @@ void Data::setData(const QVector<double> &vx, const QVector<double> &vy)
     }
     else
         mYDataChanged = false;
+    if(mXDataChanged || mYDataChanged)
+        incrementGeneration();
 }
 
 void Data::setData(const QVector<double> &yDat)
@@ -62,8 +73,10 @@ void Data::setData(const QVector<double> &yDat)
         mXDataChanged = true;
     }
     yData = yDat;
+    mIngestedCount += yDat.size();
     /* suppose yData changes */
     mYDataChanged = true;
+    incrementGeneration();
 }
 
 /** \brief Returns a vector of double containing the abscissa values whose Y values
@@ -74,12 +87,18 @@ void Data::setData(const QVector<double> &yDat)
 QVector<double> Data::invalidDataPoints() const
 {
     QVector<double> xinvalid;
+    invalidDataPoints(xinvalid);
+    return xinvalid;
+}
+
+void Data::invalidDataPoints(QVector<double> &xInvalid) const
+{
+    xInvalid.resize(0);
     int xsiz = xData.size();
     int ysiz = yData.size();
     for(int i = 0; i < xData.size() && xsiz == ysiz; i++)
         if(isnan(yData.at(i)))
-            xinvalid << xData.at(i);
-    return xinvalid;
+            xInvalid << xData.at(i);
 }
 
 void Data::addPoints(const QVector<double> &xData, const QVector<double> &yData)
@@ -128,6 +147,8 @@ void Data::addPoint(double x, double y)
 
     mYDataChanged = true;
     mXDataChanged = true;
+    mGeneration++;
+    mIngestedCount++;
 }
 
 Point Data::point(int index) const
@@ -141,7 +162,89 @@ void Data::remove(int index)
     {
         xData.remove(index);
         yData.remove(index);
+        mGeneration++;
+        mResetGeneration++;
+    }
+}
+
+void Data::remove(int index, int count)
+{
+    count = qMin(count, xData.size() - index);
+    if(index >= 0 && count > 0)
+    {
+        xData.remove(index, count);
+        yData.remove(index, count);
+        mGeneration++;
+        mResetGeneration++;
+    }
+}
+
+void Data::removeOldest(int count)
+{
+    count = qMin(count, xData.size());
+    if(count > 0)
+    {
+        xData.remove(0, count);
+        yData.remove(0, count);
+        mGeneration++;
+        mEvictionGeneration++;
+    }
+}
+
+int Data::compact(int count, int factor)
+{
+    count = qMin(count, qMin(xData.size(), yData.size()));
+    if(factor < 2 || count < factor)
+        return 0;
+    double *x = xData.data();
+    double *y = yData.data();
+    int out = 0;
+    for(int start = 0; start < count; start += factor)
+    {
+        int end = qMin(start + factor, count);
+        int imin = start, imax = start;
+        for(int i = start + 1; i < end; i++)
+        {
+            if(y[i] < y[imin])
+                imin = i;
+            if(y[i] > y[imax])
+                imax = i;
+        }
+        int first = qMin(imin, imax), second = qMax(imin, imax);
+        /* out never goes past start: read the group before overwriting it */
+        double x1 = x[first], y1 = y[first], x2 = x[second], y2 = y[second];
+        x[out] = x1;
+        y[out++] = y1;
+        if(second != first)
+        {
+            x[out] = x2;
+            y[out++] = y2;
+        }
+    }
+    int removed = count - out;
+    remove(out, removed);
+    return removed;
+}
+
+bool Data::interpolateY(double x, double *y) const
+{
+    int n = qMin(xData.size(), yData.size());
+    if(!xDataOrdered || n == 0 || isnan(x))
+        return false;
+    const double *xd = xData.constData();
+    if(x < xd[0] || x > xd[n - 1])
+        return false;
+    /* first x greater than or equal to x */
+    int i = qLowerBound(xd, xd + n, x) - xd;
+    if(xd[i] == x || i == 0)
+        *y = yData.at(i);
+    else
+    {
+        double x0 = xd[i - 1], x1 = xd[i];
+        double y0 = yData.at(i - 1), y1 = yData.at(i);
+        *y = (x1 == x0) ? y1 : y0 + (y1 - y0) * (x - x0) / (x1 - x0);
     }
+    return true;
 }
 
 int Data::size() const
@@ -39,6 +39,39 @@ public:
 
     void remove(int index);
 
+    /** \brief removes count values starting at index from both xData and yData
+     */
+    void remove(int index, int count);
+
+    /** \brief removes the count oldest values from both xData and yData, as the
+     *         buffer size of a SceneCurve does.
+     *
+     * The remaining points are left untouched: the generation and the eviction
+     * generation are incremented, the reset generation is not.
+     */
+    void removeOldest(int count);
+
+    /** \brief replaces the first count points with their aggregates.
+     *
+     * The points are split into consecutive groups of factor points. Each group is
+     * replaced by the points holding its minimum and maximum y value, in their
+     * original order, so that the envelope of the old data is preserved.
+     * The bounds are not recalculated.
+     *
+     * @return the number of points removed.
+     */
+    int compact(int count, int factor);
+
+    /** \brief linearly interpolates the y value at x.
+     *
+     * The neighbours of x are found with a binary search, so xData must be sorted
+     * in ascending order (xDataOrdered).
+     *
+     * @return false if the x data is not ordered or x lies outside the data range.
+     *         The interpolated value may be NaN if one of the neighbours is NaN.
+     */
+    bool interpolateY(double x, double *y) const;
+
     void calculateXBounds();
 
     void calculateYBounds();
@@ -84,8 +117,52 @@ public:
 
     QVector<double> invalidDataPoints() const;
 
+    /** \brief stores the x values of the invalid (NaN) y data into xInvalid
+     *
+     * xInvalid is emptied first. Its capacity is kept, so that passing the same
+     * vector at each call does not allocate memory.
+     */
+    void invalidDataPoints(QVector<double>& xInvalid) const;
+
     void resetMaxMin();
 
+    /** \brief returns a counter that is incremented each time the data changes
+     *
+     * Caches built upon the data (e.g. the CurveItem raster layer) can store the
+     * generation they were built with and compare it later to know whether they
+     * are still valid.
+     */
+    unsigned int generation() const { return mGeneration; }
+
+    /** \brief returns a counter that is incremented only when the data is replaced
+     *         rather than appended to (setData or a direct modification).
+     *
+     * A cache that is able to follow the data point by point (see StripChartItem)
+     * must be rebuilt from scratch when the reset generation changes.
+     */
+    unsigned int resetGeneration() const { return mResetGeneration; }
+
+    /** \brief returns a counter that is incremented each time the oldest points are
+     *         removed by removeOldest.
+     *
+     * A cache following the data point by point must drop what it has drawn of the
+     * points preceding the first one when the eviction generation changes.
+     */
+    unsigned int evictionGeneration() const { return mEvictionGeneration; }
+
+    /** \brief increments the data generation and the reset generation.
+     *
+     * Call this if you modify xData or yData directly.
+     */
+    void incrementGeneration() { mGeneration++; mResetGeneration++; }
+
+    /** \brief returns the total number of points received through addPoint, addPoints
+     *         and setData since the Data was created.
+     *
+     * Sampling the counter periodically gives the ingestion rate of the curve.
+     */
+    unsigned long ingestedCount() const { return mIngestedCount; }
+
 private:
 
     int lastValidXPos, lastValidYPos;
@@ -94,6 +171,10 @@ private:
     bool mXDataChanged, mYDataChanged;
     bool dataChanged;
 
+    unsigned int mGeneration, mResetGeneration, mEvictionGeneration;
+
+    unsigned long mIngestedCount;
+
 };
 
 #endif // DATA_H
@@ -0,0 +1,194 @@
+#include "datapool.h"
+#include "data.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <QMap>
+#include <QList>
+#include <QSet>
+#include <string.h>
+
+class DataPoolPrivate
+{
+public:
+    mutable QMutex mutex;
+
+    /* chunk size in samples, free chunks of that size */
+    QMap<int, QList<QVector<double> > > freeChunks;
+
+    QSet<const Data *> liveData;
+
+    qint64 pooledBytes, maxPooledBytes;
+
+    unsigned long hits, misses;
+};
+
+DataPool *DataPool::instance()
+{
+    /* never destroyed: curves may be released until the very end of the process */
+    static DataPool *pool = new DataPool();
+    return pool;
+}
+
+DataPool::DataPool()
+{
+    d_ptr = new DataPoolPrivate();
+    d_ptr->pooledBytes = 0;
+    d_ptr->maxPooledBytes = 64 * 1024 * 1024;
+    d_ptr->hits = d_ptr->misses = 0;
+}
+
+DataPool::~DataPool()
+{
+    delete d_ptr;
+}
+
+int DataPool::chunkSamples(int samples)
+{
+    int chunk = MinChunkSamples;
+    while(chunk < samples && chunk < (1 << 30))
+        chunk <<= 1;
+    return chunk;
+}
+
+void DataPool::reserve(QVector<double> &v, int samples)
+{
+    if(v.capacity() >= samples)
+        return;
+    QVector<double> buf = mTakeChunk(chunkSamples(samples), v);
+    release(v);
+    v = buf;
+}
+
+void DataPool::shrink(QVector<double> &v, int samples)
+{
+    int chunk = chunkSamples(qMax(samples, v.size()));
+    if(v.capacity() <= chunk)
+        return;
+    /* the old buffer is freed when v is assigned */
+    v = mTakeChunk(chunk, v);
+}
+
+QVector<double> DataPool::mTakeChunk(int chunk, const QVector<double> &contents)
+{
+    QVector<double> buf;
+    {
+        QMutexLocker locker(&d_ptr->mutex);
+        QList<QVector<double> > &free = d_ptr->freeChunks[chunk];
+        if(!free.isEmpty())
+        {
+            buf = free.takeLast();
+            d_ptr->pooledBytes -= chunk * sizeof(double);
+            d_ptr->hits++;
+        }
+        else
+            d_ptr->misses++;
+    }
+    if(buf.capacity() < chunk)
+        buf.reserve(chunk);
+    /* copy rather than append the vector: appending to an empty QVector may
+     * just share the other vector and drop the chunk
+     */
+    buf.resize(contents.size());
+    if(contents.size() > 0)
+        memcpy(buf.data(), contents.constData(), contents.size() * sizeof(double));
+    return buf;
+}
+
+void DataPool::release(QVector<double> &v)
+{
+    int capacity = v.capacity();
+    if(capacity >= MinChunkSamples && capacity == chunkSamples(capacity) && v.isDetached())
+    {
+        v.resize(0);
+        if(v.capacity() == capacity) /* still the whole chunk */
+        {
+            QMutexLocker locker(&d_ptr->mutex);
+            qint64 bytes = capacity * sizeof(double);
+            if(d_ptr->pooledBytes + bytes <= d_ptr->maxPooledBytes)
+            {
+                d_ptr->freeChunks[capacity].append(v);
+                d_ptr->pooledBytes += bytes;
+            }
+        }
+    }
+    v = QVector<double>();
+}
+
+qint64 DataPool::reservedBytes() const
+{
+    QMutexLocker locker(&d_ptr->mutex);
+    qint64 bytes = d_ptr->pooledBytes;
+    foreach(const Data *d, d_ptr->liveData)
+        bytes += (d->xData.capacity() + d->yData.capacity()) * sizeof(double);
+    return bytes;
+}
+
+qint64 DataPool::usedBytes() const
+{
+    QMutexLocker locker(&d_ptr->mutex);
+    qint64 bytes = 0;
+    foreach(const Data *d, d_ptr->liveData)
+        bytes += (d->xData.size() + d->yData.size()) * sizeof(double);
+    return bytes;
+}
+
+qint64 DataPool::pooledBytes() const
+{
+    QMutexLocker locker(&d_ptr->mutex);
+    return d_ptr->pooledBytes;
+}
+
+unsigned long DataPool::hitCount() const
+{
+    QMutexLocker locker(&d_ptr->mutex);
+    return d_ptr->hits;
+}
+
+unsigned long DataPool::missCount() const
+{
+    QMutexLocker locker(&d_ptr->mutex);
+    return d_ptr->misses;
+}
+
+qint64 DataPool::maxPooledBytes() const
+{
+    QMutexLocker locker(&d_ptr->mutex);
+    return d_ptr->maxPooledBytes;
+}
+
+void DataPool::setMaxPooledBytes(qint64 bytes)
+{
+    QMutexLocker locker(&d_ptr->mutex);
+    d_ptr->maxPooledBytes = bytes;
+    /* drop the largest chunks first */
+    while(d_ptr->pooledBytes > d_ptr->maxPooledBytes && !d_ptr->freeChunks.isEmpty())
+    {
+        QMap<int, QList<QVector<double> > >::iterator it = d_ptr->freeChunks.end() - 1;
+        if(!it.value().isEmpty())
+        {
+            it.value().removeLast();
+            d_ptr->pooledBytes -= it.key() * sizeof(double);
+        }
+        if(it.value().isEmpty())
+            d_ptr->freeChunks.erase(it);
+    }
+}
+
+void DataPool::trim()
+{
+    QMutexLocker locker(&d_ptr->mutex);
+    d_ptr->freeChunks.clear();
+    d_ptr->pooledBytes = 0;
+}
+
+void DataPool::registerData(const Data *d)
+{
+    QMutexLocker locker(&d_ptr->mutex);
+    d_ptr->liveData.insert(d);
+}
+
+void DataPool::unregisterData(const Data *d)
+{
+    QMutexLocker locker(&d_ptr->mutex);
+    d_ptr->liveData.remove(d);
+}
@@ -0,0 +1,109 @@
+#ifndef DATAPOOL_H
+#define DATAPOOL_H
+
+#include <QVector>
+#include <QtGlobal>
+
+class Data;
+class DataPoolPrivate;
+
+/** \brief A process wide pool of the sample buffers of the curves.
+ *
+ * Bounded curves (see SceneCurve::setBufferSize) take their x and y buffers from
+ * the pool. Buffers are handed out in fixed size chunks: the capacity of a chunk
+ * is the power of two greater than or equal to the requested number of samples,
+ * and never less than MinChunkSamples.
+ * When a curve is destroyed its buffers go back to the pool and are given to the
+ * next curve asking for a chunk of the same size, instead of being returned
+ * to the heap. Plots that continuously add and remove curves (addLineCurve,
+ * removeCurve) thus reuse the same few chunk sizes and the heap is not fragmented
+ * by vectors of many different capacities.
+ *
+ * Buffers shared with the application (e.g. after SceneCurve::setData, that
+ * shares the vectors passed) are never pooled.
+ *
+ * At most maxPooledBytes are kept in the pool: buffers released beyond that
+ * limit are freed. trim frees all the pooled buffers.
+ *
+ * \par Statistics
+ * \li reservedBytes: memory held by the sample buffers of the live curves plus the
+ *     memory kept in the pool;
+ * \li usedBytes: memory actually occupied by samples;
+ * \li pooledBytes: memory kept in the pool, ready to be reused;
+ * \li hitCount and missCount: number of chunks taken from the pool and allocated
+ *     from the heap respectively.
+ *
+ * The pool can be used from any thread. The statistics read the sizes of the
+ * curves data and should be queried from the thread that feeds the curves.
+ */
+class DataPool
+{
+public:
+    /* the smallest chunk handed out, in samples */
+    enum { MinChunkSamples = 1024 };
+
+    static DataPool *instance();
+
+    /** \brief the number of samples of the chunk used for a buffer of the given size
+     */
+    static int chunkSamples(int samples);
+
+    /** \brief makes v able to store at least samples values without reallocating.
+     *
+     * If the capacity of v is not enough, a chunk is taken from the pool (or allocated),
+     * the contents of v are copied into it and the old buffer of v is released.
+     */
+    void reserve(QVector<double>& v, int samples);
+
+    /** \brief gives the buffer of v back to the pool. v is left empty.
+     *
+     * The buffer is pooled only if it is a chunk, it is not shared and the pool
+     * has not reached maxPooledBytes. Otherwise it is freed.
+     */
+    void release(QVector<double>& v);
+
+    /** \brief moves the contents of v into the smallest chunk able to hold samples
+     *         values, if smaller than the current buffer of v.
+     *
+     * The old buffer is freed rather than pooled: shrink is meant to give memory
+     * back (see MemoryBudget).
+     */
+    void shrink(QVector<double>& v, int samples);
+
+    qint64 reservedBytes() const;
+
+    qint64 usedBytes() const;
+
+    qint64 pooledBytes() const;
+
+    unsigned long hitCount() const;
+
+    unsigned long missCount() const;
+
+    qint64 maxPooledBytes() const;
+
+    /** \brief sets the maximum amount of memory kept in the pool. Default: 64MB
+     */
+    void setMaxPooledBytes(qint64 bytes);
+
+    /** \brief frees all the buffers kept in the pool
+     */
+    void trim();
+
+    /* used by Data to account for the buffers in use */
+    void registerData(const Data *d);
+
+    void unregisterData(const Data *d);
+
+private:
+    DataPool();
+
+    /* a chunk of the given size from the pool or the heap, holding a copy of contents */
+    QVector<double> mTakeChunk(int chunk, const QVector<double>& contents);
+
+    ~DataPool();
+
+    DataPoolPrivate *d_ptr;
+};
+
+#endif // DATAPOOL_H
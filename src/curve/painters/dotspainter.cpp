@@ -12,6 +12,7 @@ DotsPainter::DotsPainter(CurveItem *curveItem) : QObject(curveItem)
     d_ptr->pen = QPen(KMAROON);
     d_ptr->pen.setWidthF(0.0);
     d_ptr->radius = 1.0;
+    d_ptr->penBrush = QBrush(d_ptr->pen.color());
     curveItem->installItemPainterInterface(this);
     setObjectName("DotsPainter");
 }
@@ -32,20 +33,22 @@ void DotsPainter::draw(SceneCurve *curve,
     if(dataSiz < 2)
         return;
 
-    painter->save();
+    /* save and restore just pen and brush: painter->save() allocates a new state */
+    QPen previousPen = painter->pen();
+    QBrush previousBrush = painter->brush();
     painter->setPen(d_ptr->pen);
+    painter->setBrush(d_ptr->penBrush);
     const QPointF *points = curve->points();
-    for(int i = 0; i < curve->dataSize(); i++)
+    for(int i = 0; i < dataSiz; i++)
     {
-        painter->setBrush(d_ptr->pen.color());
-        painter->setPen(d_ptr->pen);
         QPointF p = points[i];
      //   painter->fillRect(QRectF(p.x() - d_ptr->radius, p.y() - d_ptr->radius,
        //                   p.x() + d_ptr->radius, p.y() + d_ptr->radius), d_ptr->pen.color());
       painter->drawEllipse(p, d_ptr->radius, d_ptr->radius);
     }
     /* draw NaNs (invalid data) */
-    QVector<double> xInvalid = curve->data()->invalidDataPoints();
+    QVector<double> &xInvalid = d_ptr->xInvalid;
+    curve->data()->invalidDataPoints(xInvalid);
     if(xInvalid.size() > 0)
     {
         painter->setPen(Qt::red);
@@ -58,7 +61,8 @@ void DotsPainter::draw(SceneCurve *curve,
         painter->setPen(d_ptr->pen);
     }
 
-    painter->restore();
+    painter->setPen(previousPen);
+    painter->setBrush(previousBrush);
 }
 
 int DotsPainter::type() const
@@ -103,25 +107,27 @@ QPen DotsPainter::pen() const
 void DotsPainter::setDotsColor(const QColor &c)
 {
     d_ptr->brush.setColor(c);
-    d_ptr->curveItem->update();
+    d_ptr->curveItem->invalidateCache();
 }
 
 void DotsPainter::setBorderColor(const QColor& c)
 
 {
     d_ptr->pen.setColor(c);
-    d_ptr->curveItem->update();
+    d_ptr->penBrush = QBrush(c);
+    d_ptr->curveItem->invalidateCache();
 }
 
 void DotsPainter::setRadius(double w)
 {
     d_ptr->pen.setWidthF(w);
-    d_ptr->curveItem->update();
+    d_ptr->curveItem->invalidateCache();
 }
 
 void DotsPainter::setPen(const QPen& p)
 {
     d_ptr->pen = p;
-    d_ptr->curveItem->update();
+    d_ptr->penBrush = QBrush(p.color());
+    d_ptr->curveItem->invalidateCache();
 }
 
@@ -1,5 +1,7 @@
-#include "linepainterprivate.h"
+#include "dotspainterprivate.h"
 
-LinePainterPrivate::LinePainterPrivate()
+DotsPainterPrivate::DotsPainterPrivate()
 {
+    curveItem = NULL;
+    radius = 1.0;
 }
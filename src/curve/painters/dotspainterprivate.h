@@ -2,6 +2,8 @@
 #define DOTSPAINTERPRIVATE_H
 
 #include <QPen>
+#include <QBrush>
+#include <QVector>
 
 class CurveItem;
 
@@ -17,6 +19,14 @@ public:
     double radius;
 
     CurveItem* curveItem;
+
+    /* solid brush of the pen color. Kept in sync with the pen rather than
+     * built at each draw.
+     */
+    QBrush penBrush;
+
+    /* x of the invalid (NaN) data, reused at each draw */
+    QVector<double> xInvalid;
 };
 
-#endif // LINEPAINTERPRIVATE_H
+#endif // DOTSPAINTERPRIVATE_H
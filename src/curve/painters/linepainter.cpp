@@ -12,6 +12,7 @@ LinePainter::LinePainter(CurveItem *curveItem) : QObject(curveItem)
     d_ptr = new LinePainterPrivate();
     d_ptr->curveItem = curveItem;
     d_ptr->pen.setWidthF(0.0);
+    d_ptr->penBrush = QBrush(d_ptr->pen.color());
     curveItem->installItemPainterInterface(this);
     setObjectName("LinePainter");
 }
@@ -36,7 +37,7 @@ void LinePainter::draw(SceneCurve *curve,
     const QPointF *points = curve->points();
     if(dataSiz <= 2)
     {
-        painter->setBrush(QBrush(d_ptr->pen.color()));
+        painter->setBrush(d_ptr->penBrush);
         for(int i = 0; i < dataSiz; i++)
         {
             painter->drawEllipse(points[i], 3, 2.5);
@@ -44,13 +45,37 @@ void LinePainter::draw(SceneCurve *curve,
     }
     if(points)
     {
-        painter->drawPolyline(points, dataSiz);
+        /* after a deep zoom most of the points lie far outside the canvas: feeding
+         * them to drawPolyline makes the raster engine waste time clipping huge
+         * coordinates. Trim the polyline to the canvas (one pixel plus the pen
+         * width of margin) and draw only the visible runs.
+         */
+        QRectF clipRect = curve->getXAxis()->canvasRect();
+        if(clipRect.isValid() && dataSiz > 2)
+        {
+            double margin = 1.0 + d_ptr->pen.widthF();
+            clipRect.adjust(-margin, -margin, margin, margin);
+            /* partial updates: do not go beyond the painter clip */
+            if(painter->hasClipping())
+                clipRect = clipRect.intersected(painter->clipBoundingRect().adjusted(-margin, -margin, margin, margin));
+            int nRuns = d_ptr->clipPolyline(points, dataSiz, clipRect);
+            const QPointF *runPoints = d_ptr->runPoints.constData();
+            for(int r = 0; r < nRuns; r++)
+            {
+                int start = d_ptr->runStarts[r];
+                int end = (r < nRuns - 1) ? d_ptr->runStarts[r + 1] : d_ptr->runPoints.size();
+                painter->drawPolyline(runPoints + start, end - start);
+            }
+        }
+        else
+            painter->drawPolyline(points, dataSiz);
 //        for(int i = 0; i < dataSiz; i++)
 //            printf("\e[1;33m(%f,%f), ", points[i].x(), points[i].y());
 //        printf("\e[0m\n\n");
     }
     /* draw NaNs (invalid data */
-    QVector<double> xInvalid = curve->data()->invalidDataPoints();
+    QVector<double> &xInvalid = d_ptr->xInvalid;
+    curve->data()->invalidDataPoints(xInvalid);
     if(xInvalid.size() > 0)
     {
         QPen invalidDataPen(Qt::red);
@@ -105,17 +130,19 @@ void LinePainter::setLineColor(const QColor& c)
 
 {
     d_ptr->pen.setColor(c);
-    d_ptr->curveItem->update();
+    d_ptr->penBrush = QBrush(c);
+    d_ptr->curveItem->invalidateCache();
 }
 
 void LinePainter::setLineWidth(double w)
 {
     d_ptr->pen.setWidthF(w);
-    d_ptr->curveItem->update();
+    d_ptr->curveItem->invalidateCache();
 }
 
 void LinePainter::setLinePen(const QPen& p)
 {
     d_ptr->pen = p;
-    d_ptr->curveItem->update();
+    d_ptr->penBrush = QBrush(p.color());
+    d_ptr->curveItem->invalidateCache();
 }
@@ -1,5 +1,87 @@
-#include "dotspainterprivate.h"
+#include "linepainterprivate.h"
+#include <QRectF>
 
-DotsPainterPrivate::DotsPainterPrivate()
+LinePainterPrivate::LinePainterPrivate()
 {
+    curveItem = NULL;
+}
+
+/* Liang-Barsky parametric clip test for one boundary */
+static inline bool clipTest(double p, double q, double &t0, double &t1)
+{
+    if(p == 0.0)
+        return q >= 0.0;
+    double r = q / p;
+    if(p < 0.0)
+    {
+        if(r > t1)
+            return false;
+        if(r > t0)
+            t0 = r;
+    }
+    else
+    {
+        if(r < t0)
+            return false;
+        if(r < t1)
+            t1 = r;
+    }
+    return true;
+}
+
+/* clips the segment p0-p1 against r. Returns false if the segment lies entirely
+ * outside r, otherwise modifies p0 and p1 so that they lie inside r.
+ */
+static inline bool clipSegment(const QRectF &r, QPointF &p0, QPointF &p1)
+{
+    double t0 = 0.0, t1 = 1.0;
+    double dx = p1.x() - p0.x();
+    double dy = p1.y() - p0.y();
+    if(clipTest(-dx, p0.x() - r.left(), t0, t1) &&
+            clipTest(dx, r.right() - p0.x(), t0, t1) &&
+            clipTest(-dy, p0.y() - r.top(), t0, t1) &&
+            clipTest(dy, r.bottom() - p0.y(), t0, t1))
+    {
+        QPointF origin = p0;
+        if(t1 < 1.0)
+            p1 = QPointF(origin.x() + t1 * dx, origin.y() + t1 * dy);
+        if(t0 > 0.0)
+            p0 = QPointF(origin.x() + t0 * dx, origin.y() + t0 * dy);
+        return true;
+    }
+    return false;
+}
+
+int LinePainterPrivate::clipPolyline(const QPointF *points, int count, const QRectF &clipRect)
+{
+    runPoints.resize(0);
+    runStarts.resize(0);
+    bool runOpen = false;
+    for(int i = 1; i < count; i++)
+    {
+        QPointF p0 = points[i - 1];
+        QPointF p1 = points[i];
+        bool p1Inside = clipRect.contains(p1);
+        if(runOpen && p1Inside) /* most common case: the run simply goes on */
+        {
+            runPoints.append(p1);
+            continue;
+        }
+        if(!clipSegment(clipRect, p0, p1))
+        {
+            runOpen = false;
+            continue;
+        }
+        if(!runOpen)
+        {
+            runStarts.append(runPoints.size());
+            runPoints.append(p0);
+            runOpen = true;
+        }
+        runPoints.append(p1);
+        /* the segment leaves the clip rect: close the run */
+        if(!p1Inside)
+            runOpen = false;
+    }
+    return runStarts.size();
 }
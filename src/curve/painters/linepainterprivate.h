@@ -2,17 +2,44 @@
 #define LINEPAINTERPRIVATE_H
 
 #include <QPen>
+#include <QVector>
+#include <QPointF>
 
 class CurveItem;
+class QRectF;
 
 class LinePainterPrivate
 {
 public:
     LinePainterPrivate();
 
+    /** \brief splits the polyline into the runs that are visible inside clipRect
+     *
+     * Segments are clipped against clipRect (Liang-Barsky). Consecutive visible
+     * segments are merged into a single run. The result is stored into runPoints,
+     * while runStarts holds the index of the first point of each run into runPoints.
+     * Both vectors are reused across calls, so that no allocation takes place
+     * once they have grown to the size of the curve.
+     *
+     * @return the number of runs found.
+     */
+    int clipPolyline(const QPointF* points, int count, const QRectF& clipRect);
+
     QPen pen;
 
     CurveItem* curveItem;
+
+    /* solid brush of the pen color. Kept in sync with the pen rather than
+     * built at each draw.
+     */
+    QBrush penBrush;
+
+    /* x of the invalid (NaN) data, reused at each draw */
+    QVector<double> xInvalid;
+
+    QVector<QPointF> runPoints;
+
+    QVector<int> runStarts;
 };
 
 #endif // LINEPAINTERPRIVATE_H
@@ -13,6 +13,7 @@ StepsPainter::StepsPainter(CurveItem *curveItem) :  QObject(curveItem)
     d_ptr = new StepsPainterPrivate();
     d_ptr->curveItem = curveItem;
     d_ptr->pen.setWidthF(0.0);
+    d_ptr->penBrush = QBrush(d_ptr->pen.color());
     curveItem->installItemPainterInterface(this);
     setObjectName("StepsPainter");
 }
@@ -34,7 +35,7 @@ void StepsPainter::draw(SceneCurve *curve,
     int dataSiz = curve->dataSize();
     painter->setPen(d_ptr->pen);
     const QPointF *points = curve->points();
-    painter->setBrush(QBrush(d_ptr->pen.color()));
+    painter->setBrush(d_ptr->penBrush);
     if(dataSiz == 1)
         painter->drawEllipse(points[0], 3, 2.5);
     else
@@ -46,7 +47,8 @@ void StepsPainter::draw(SceneCurve *curve,
         }
     }
     /* draw NaNs (invalid data */
-    QVector<double> xInvalid = curve->data()->invalidDataPoints();
+    QVector<double> &xInvalid = d_ptr->xInvalid;
+    curve->data()->invalidDataPoints(xInvalid);
     if(xInvalid.size() > 0)
     {
         painter->setPen(Qt::red);
@@ -104,18 +106,20 @@ void StepsPainter::setLineColor(const QColor& c)
 
 {
     d_ptr->pen.setColor(c);
-    d_ptr->curveItem->update();
+    d_ptr->penBrush = QBrush(c);
+    d_ptr->curveItem->invalidateCache();
 }
 
 void StepsPainter::setLineWidth(double w)
 {
     d_ptr->pen.setWidthF(w);
-    d_ptr->curveItem->update();
+    d_ptr->curveItem->invalidateCache();
 }
 
 void StepsPainter::setLinePen(const QPen& p)
 {
     d_ptr->pen = p;
-    d_ptr->curveItem->update();
+    d_ptr->penBrush = QBrush(p.color());
+    d_ptr->curveItem->invalidateCache();
 }
 
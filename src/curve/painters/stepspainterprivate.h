@@ -2,6 +2,8 @@
 #define STEPSPAINTERPRIVATE_H
 
 #include <QPen>
+#include <QBrush>
+#include <QVector>
 
 class CurveItem;
 
@@ -13,6 +15,14 @@ public:
     QPen pen;
 
     CurveItem* curveItem;
+
+    /* solid brush of the pen color. Kept in sync with the pen rather than
+     * built at each draw.
+     */
+    QBrush penBrush;
+
+    /* x of the invalid (NaN) data, reused at each draw */
+    QVector<double> xInvalid;
 };
 
 #endif // STEPSPAINTERPRIVATE_H
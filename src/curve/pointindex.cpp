@@ -0,0 +1,189 @@
+#include "pointindex.h"
+#include <QtAlgorithms>
+#include <math.h>
+
+static bool xLessThan(const QPointF &p1, const QPointF &p2)
+{
+    return p1.x() < p2.x();
+}
+
+static inline double squaredDist(const QPointF &p1, const QPointF &p2)
+{
+    double dx = p1.x() - p2.x();
+    double dy = p1.y() - p2.y();
+    return dx * dx + dy * dy;
+}
+
+PointIndex::PointIndex()
+{
+    mValid = mOrdered = false;
+    mStamp = 0;
+    mCount = 0;
+    mCols = mRows = 0;
+    mCellW = mCellH = 1.0;
+}
+
+bool PointIndex::isValid(unsigned int stamp) const
+{
+    return mValid && mStamp == stamp;
+}
+
+void PointIndex::invalidate()
+{
+    mValid = false;
+}
+
+void PointIndex::build(const QPointF *points, int count, const QRectF &boundingRect, unsigned int stamp)
+{
+    mStamp = stamp;
+    mValid = true;
+    mCount = count;
+    mOrdered = true;
+    for(int i = 1; i < count && mOrdered; i++)
+        mOrdered = points[i].x() >= points[i - 1].x();
+    if(mOrdered || count == 0)
+    {
+        /* binary search: release the grid memory */
+        mCellStart = QVector<int>();
+        mCellPoints = QVector<int>();
+        return;
+    }
+
+    /* about four points per cell, on a square-ish grid */
+    mRect = boundingRect;
+    int side = qBound(1, (int) sqrt(count / 4.0), 1024);
+    mCols = mRows = side;
+    mCellW = mRect.width() > 0 ? mRect.width() / mCols : 1.0;
+    mCellH = mRect.height() > 0 ? mRect.height() / mRows : 1.0;
+
+    /* counting sort of the point indexes by cell */
+    int cells = mCols * mRows;
+    mCellStart.fill(0, cells + 1);
+    mCellPoints.resize(count);
+    QVector<int> cellOf(count);
+    for(int i = 0; i < count; i++)
+    {
+        int cx = qBound(0, (int) floor((points[i].x() - mRect.left()) / mCellW), mCols - 1);
+        int cy = qBound(0, (int) floor((points[i].y() - mRect.top()) / mCellH), mRows - 1);
+        cellOf[i] = cy * mCols + cx;
+        mCellStart[cellOf[i] + 1]++;
+    }
+    for(int c = 0; c < cells; c++)
+        mCellStart[c + 1] += mCellStart[c];
+    QVector<int> fill = mCellStart;
+    for(int i = 0; i < count; i++)
+        mCellPoints[fill[cellOf[i]]++] = i;
+}
+
+unsigned long PointIndex::memoryUsage() const
+{
+    return (mCellStart.capacity() + mCellPoints.capacity()) * sizeof(int);
+}
+
+int PointIndex::closest(const QPointF *points, const QPointF &pos, double *squaredDistance) const
+{
+    if(!mValid || mCount == 0 || !points)
+        return -1;
+    if(mOrdered)
+        return mClosestOrdered(points, pos, squaredDistance);
+    return mClosestGrid(points, pos, squaredDistance);
+}
+
+int PointIndex::mClosestOrdered(const QPointF *points, const QPointF &pos, double *squaredDistance) const
+{
+    const QPointF *end = points + mCount;
+    int start = qLowerBound(points, end, pos, xLessThan) - points;
+    int best = -1;
+    double bestDist = 0.0, d, dx;
+    /* right: x grows, stop when the x distance alone exceeds the best distance */
+    for(int i = start; i < mCount; i++)
+    {
+        dx = points[i].x() - pos.x();
+        if(best >= 0 && dx * dx >= bestDist)
+            break;
+        d = squaredDist(points[i], pos);
+        if(best < 0 || d < bestDist)
+        {
+            bestDist = d;
+            best = i;
+        }
+    }
+    for(int i = start - 1; i >= 0; i--)
+    {
+        dx = pos.x() - points[i].x();
+        if(best >= 0 && dx * dx >= bestDist)
+            break;
+        d = squaredDist(points[i], pos);
+        if(best < 0 || d <= bestDist) /* prefer the lower index on ties */
+        {
+            bestDist = d;
+            best = i;
+        }
+    }
+    if(squaredDistance)
+        *squaredDistance = bestDist;
+    return best;
+}
+
+int PointIndex::mClosestGrid(const QPointF *points, const QPointF &pos, double *squaredDistance) const
+{
+    int cx = qBound(0, (int) floor((pos.x() - mRect.left()) / mCellW), mCols - 1);
+    int cy = qBound(0, (int) floor((pos.y() - mRect.top()) / mCellH), mRows - 1);
+    int best = -1;
+    double bestDist = 0.0;
+    for(int r = 0; ; r++)
+    {
+        int x0 = cx - r, x1 = cx + r, y0 = cy - r, y1 = cy + r;
+        /* visit the cells at Chebyshev distance r from (cx, cy) */
+        for(int y = qMax(y0, 0); y <= qMin(y1, mRows - 1); y++)
+        {
+            if(y == y0 || y == y1) /* top and bottom rows of the ring */
+            {
+                for(int x = qMax(x0, 0); x <= qMin(x1, mCols - 1); x++)
+                    mScanCell(y * mCols + x, points, pos, &best, &bestDist);
+            }
+            else /* left and right cells */
+            {
+                if(x0 >= 0)
+                    mScanCell(y * mCols + x0, points, pos, &best, &bestDist);
+                if(x1 < mCols)
+                    mScanCell(y * mCols + x1, points, pos, &best, &bestDist);
+            }
+        }
+        /* the points not visited yet lie beyond the edges of the box covering the rings
+         * visited so far. Edges on the grid boundary have no points beyond them.
+         */
+        bool left = x0 > 0, right = x1 < mCols - 1, top = y0 > 0, bottom = y1 < mRows - 1;
+        if(!left && !right && !top && !bottom)
+            break;
+        double margin = 1e300;
+        if(left)
+            margin = qMin(margin, pos.x() - (mRect.left() + x0 * mCellW));
+        if(right)
+            margin = qMin(margin, mRect.left() + (x1 + 1) * mCellW - pos.x());
+        if(top)
+            margin = qMin(margin, pos.y() - (mRect.top() + y0 * mCellH));
+        if(bottom)
+            margin = qMin(margin, mRect.top() + (y1 + 1) * mCellH - pos.y());
+        if(best >= 0 && margin > 0 && margin * margin >= bestDist)
+            break;
+    }
+    if(squaredDistance)
+        *squaredDistance = bestDist;
+    return best;
+}
+
+void PointIndex::mScanCell(int cell, const QPointF *points, const QPointF &pos, int *best, double *bestDist) const
+{
+    double d;
+    for(int k = mCellStart[cell]; k < mCellStart[cell + 1]; k++)
+    {
+        int i = mCellPoints[k];
+        d = squaredDist(points[i], pos);
+        if(*best < 0 || d < *bestDist || (d == *bestDist && i < *best))
+        {
+            *bestDist = d;
+            *best = i;
+        }
+    }
+}
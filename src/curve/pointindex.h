@@ -0,0 +1,69 @@
+#ifndef POINTINDEX_H
+#define POINTINDEX_H
+
+#include <QVector>
+#include <QPointF>
+#include <QRectF>
+
+/** \brief a nearest point index over the projected points of a SceneCurve.
+ *
+ * The index is built from the projection cache (SceneCurve::points) and is tagged
+ * with the stamp of the projection it was built from: SceneCurve builds it again
+ * lazily, at the first query after the points have been projected again.
+ *
+ * \li if the x coordinates of the points are not decreasing (the usual case of time
+ *     and ordered x data), no structure is needed: the nearest point is found with a
+ *     binary search on x, then by scanning outwards while the x distance alone is
+ *     smaller than the best distance found;
+ * \li otherwise (scatter data) the points are bucketed into a uniform grid covering
+ *     their bounding rect, and the cells are visited in rings around the query point.
+ *
+ * Both searches are exact.
+ */
+class PointIndex
+{
+public:
+    PointIndex();
+
+    bool isValid(unsigned int stamp) const;
+
+    void invalidate();
+
+    void build(const QPointF *points, int count, const QRectF& boundingRect, unsigned int stamp);
+
+    /** \brief the index of the point closest to pos, -1 if the index is empty.
+     *
+     * @param points the same points the index was built from
+     * @param squaredDistance if not NULL, stores the squared distance of the closest point
+     */
+    int closest(const QPointF *points, const QPointF& pos, double *squaredDistance) const;
+
+    bool ordered() const { return mOrdered; }
+
+    /* the memory, in bytes, used by the grid */
+    unsigned long memoryUsage() const;
+
+private:
+    int mClosestOrdered(const QPointF *points, const QPointF& pos, double *squaredDistance) const;
+
+    int mClosestGrid(const QPointF *points, const QPointF& pos, double *squaredDistance) const;
+
+    void mScanCell(int cell, const QPointF *points, const QPointF& pos, int *best, double *bestDist) const;
+
+    bool mValid, mOrdered;
+
+    unsigned int mStamp;
+
+    int mCount;
+
+    /* grid: cellStart[c] is the first entry of cell c into cellPoints */
+    QRectF mRect;
+
+    int mCols, mRows;
+
+    double mCellW, mCellH;
+
+    QVector<int> mCellStart, mCellPoints;
+};
+
+#endif // POINTINDEX_H
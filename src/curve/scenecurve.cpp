@@ -7,6 +7,9 @@
 #include "qgraphicsplotmacros.h"
 #include "pointprivate.h"
 #include "curveitem.h"
+#include "frametimings.h"
+#include "tracerecorder.h"
+#include "datapool.h"
 #include <math.h> /* for isnan() */
 #include <QtDebug>
 #include <QPainterPath>
@@ -182,6 +185,11 @@ SceneCurve::SceneCurve(PlotSceneWidget *sceneWidget,
 }
 
 SceneCurve::~SceneCurve() {
+    /* the sample buffers go back to the DataPool. d_ptr is kept: the PlotSceneWidget
+     * still reads the curve name and axes when notified by the destroyed signal
+     */
+    delete d_ptr->data;
+    d_ptr->data = NULL;
 }
 
 QString SceneCurve::name() const
@@ -209,6 +217,11 @@ void SceneCurve::setBufferSize(int size)
     if(size > 0)
     {
         d_ptr->bufferSize = size;
+        /* appending to a full buffer shall not reallocate the data. The buffers
+         * are taken from the DataPool
+         */
+        DataPool::instance()->reserve(d_ptr->data->xData, size);
+        DataPool::instance()->reserve(d_ptr->data->yData, size);
         foreach(CurveChangeListener *listener, d_ptr->itemChangeListeners)
             listener->bufferSizeChanged(size);
     }
@@ -251,6 +264,9 @@ void SceneCurve::removeCurveItem()
 void SceneCurve::setCurveItem(CurveItem *curveItem)
 {
     d_ptr->curveItem = curveItem;
+    /* see PlotSceneWidget::setLayeredRendering */
+    if(curveItem && d_ptr->plot->layeredRendering())
+        curveItem->setCacheEnabled(true);
 }
 
 /** \brief Returns the last curve item that was attached to the curve.
@@ -306,19 +322,26 @@ void SceneCurve::invalidateCache()
 {
     d_ptr->lastValidXPos = -1;
     d_ptr->lastValidYPos = -1;
-    d_ptr->mPoints.clear();
+    /* keep the memory: the points are projected again into the same buffer */
+    d_ptr->mPoints.resize(0);
+    if(d_ptr->curveItem)
+        d_ptr->curveItem->invalidateBoundingRect();
 }
 
 void SceneCurve::invalidateXCache()
 {
     d_ptr->lastValidXPos = -1;
-    d_ptr->mPoints.clear();
+    d_ptr->mPoints.resize(0);
+    if(d_ptr->curveItem)
+        d_ptr->curveItem->invalidateBoundingRect();
 }
 
 void SceneCurve::invalidateYCache()
 {
     d_ptr->lastValidYPos = -1;
-    d_ptr->mPoints.clear();
+    d_ptr->mPoints.resize(0);
+    if(d_ptr->curveItem)
+        d_ptr->curveItem->invalidateBoundingRect();
 }
 
 ScaleItem* SceneCurve::getXAxis() const
@@ -400,37 +423,53 @@ Data *SceneCurve::data() const
  */
 void SceneCurve::addPoint(double x, double y)
 {
-    /* remove items if the size is about to be greater than bufferSize */
-    mCheckBufferSize();
+    PLOT_TRACE_SCOPE("appendData");
+    {
+        PLOT_TIMING_SCOPE(d_ptr->plot->frameTimings(), FrameTimings::Ingest);
+        /* remove items if the size is about to be greater than bufferSize */
+        mCheckBufferSize();
 
-    /* addPoint updates max and min of the curve */
-    d_ptr->data->addPoint(x, y);
-    d_ptr->data->scalarMode = true;
+        /* addPoint updates max and min of the curve */
+        d_ptr->data->addPoint(x, y);
+        d_ptr->data->scalarMode = true;
+    }
 
     foreach(CurveChangeListener *listener, d_ptr->itemChangeListeners)
     {
         listener->itemAdded(Point(x, y));
     }
+    d_ptr->plot->requestRefresh();
 }
 
 void SceneCurve::setData(const QVector<double>& xData, const QVector<double> &yData)
 {
-    d_ptr->data->setData(xData, yData);
-    d_ptr->data->scalarMode = false;
-
+    PLOT_TRACE_SCOPE("setData");
+    FrameTimings *timings = d_ptr->plot->frameTimings();
+    {
+        PLOT_TIMING_SCOPE(timings, FrameTimings::Ingest);
+        d_ptr->data->setData(xData, yData);
+        d_ptr->data->scalarMode = false;
+    }
 
-    if(d_ptr->xAxis->axisAutoscaleEnabled() && d_ptr->yAxis->axisAutoscaleEnabled())
-        d_ptr->data->calculateBounds(); /* just one cycle */
-    else if(d_ptr->xAxis->axisAutoscaleEnabled())
-        d_ptr->data->calculateXBounds();
-    else if(d_ptr->yAxis->axisAutoscaleEnabled())
-        d_ptr->data->calculateYBounds();
+    {
+        PLOT_TIMING_SCOPE(timings, FrameTimings::Bounds);
+        PLOT_TRACE_SCOPE("bounds");
+        if(d_ptr->xAxis->axisAutoscaleEnabled() && d_ptr->yAxis->axisAutoscaleEnabled())
+            d_ptr->data->calculateBounds(); /* just one cycle */
+        else if(d_ptr->xAxis->axisAutoscaleEnabled())
+            d_ptr->data->calculateXBounds();
+        else if(d_ptr->yAxis->axisAutoscaleEnabled())
+            d_ptr->data->calculateYBounds();
+    }
 
     if(!d_ptr->plot->manualSceneUpdate())
     {
         foreach(CurveChangeListener *listener, d_ptr->itemChangeListeners)
             listener->fullVectorUpdate();
     }
+    else if(d_ptr->curveItem) /* geometry must follow the data anyway */
+        d_ptr->curveItem->invalidateBoundingRect();
+    d_ptr->plot->requestRefresh();
 }
 
 
@@ -444,35 +483,61 @@ void SceneCurve::addPoints(const QVector<double>& xData, const QVector<double> &
         addPoint(xData.first(), yData.first());
     else
     {
-        d_ptr->data->addPoints(xData, yData);
-        d_ptr->data->scalarMode = true;
+        PLOT_TRACE_SCOPE("addPoints");
+        FrameTimings *timings = d_ptr->plot->frameTimings();
+        int removed = 0;
+        {
+            PLOT_TIMING_SCOPE(timings, FrameTimings::Ingest);
+            d_ptr->data->addPoints(xData, yData);
+            d_ptr->data->scalarMode = true;
+            /* keep the newest bufferSize points, removed at once */
+            if(d_ptr->bufferSize > -1 && d_ptr->data->size() > d_ptr->bufferSize)
+            {
+                removed = d_ptr->data->size() - d_ptr->bufferSize;
+                d_ptr->data->removeOldest(removed);
+            }
+        }
 
-        /* the same is equivalent to setData above */
-        if(d_ptr->xAxis->axisAutoscaleEnabled() && d_ptr->yAxis->axisAutoscaleEnabled())
-            d_ptr->data->calculateBounds(); /* just one cycle */
-        else if(d_ptr->xAxis->axisAutoscaleEnabled())
-            d_ptr->data->calculateXBounds();
-        else if(d_ptr->yAxis->axisAutoscaleEnabled())
-            d_ptr->data->calculateYBounds();
+        /* the same is equivalent to setData above. The removed points may have
+         * been the minimum or maximum on any axis
+         */
+        {
+            PLOT_TIMING_SCOPE(timings, FrameTimings::Bounds);
+            PLOT_TRACE_SCOPE("bounds");
+            if(removed > 0 || (d_ptr->xAxis->axisAutoscaleEnabled() && d_ptr->yAxis->axisAutoscaleEnabled()))
+                d_ptr->data->calculateBounds(); /* just one cycle */
+            else if(d_ptr->xAxis->axisAutoscaleEnabled())
+                d_ptr->data->calculateXBounds();
+            else if(d_ptr->yAxis->axisAutoscaleEnabled())
+                d_ptr->data->calculateYBounds();
+        }
 
         if(!d_ptr->plot->manualSceneUpdate())
         {
             foreach(CurveChangeListener *listener, d_ptr->itemChangeListeners)
                 listener->fullVectorUpdate();
         }
-
+        else if(d_ptr->curveItem) /* geometry must follow the data anyway */
+            d_ptr->curveItem->invalidateBoundingRect();
+        d_ptr->plot->requestRefresh();
     }
 }
 
 void SceneCurve::setData(const QVector<double> &yData)
 {
-    d_ptr->data->yData = yData;
+    PLOT_TRACE_SCOPE("setData");
+    {
+        PLOT_TIMING_SCOPE(d_ptr->plot->frameTimings(), FrameTimings::Ingest);
+        d_ptr->data->yData = yData;
+        d_ptr->data->incrementGeneration();
+    }
 
     if(d_ptr->curveItem && d_ptr->curveItem->isVisible())
     {
         foreach(CurveChangeListener *listener, d_ptr->itemChangeListeners)
             listener->fullVectorUpdate();
     }
+    d_ptr->plot->requestRefresh();
 }
 
 const QPointF *SceneCurve::points()
@@ -487,6 +552,9 @@ const QPointF *SceneCurve::points()
         return d_ptr->mPoints.constData();
     }
 
+    PLOT_TIMING_SCOPE(d_ptr->plot->frameTimings(), FrameTimings::Projection);
+    PLOT_TRACE_SCOPE("projection");
+    d_ptr->projectionStamp++;
 
     int index;
     /* calls of points() between subsequend calls of setData/appendData do not need
@@ -495,7 +563,15 @@ const QPointF *SceneCurve::points()
     d_ptr->data->cacheData();
 
     if(siz != d_ptr->mPoints.size())
+    {
+        /* reserved capacity survives the resize(0) in invalidateCache also with Qt 4 */
+        d_ptr->mPoints.reserve(siz);
         d_ptr->mPoints.resize(siz);
+    }
+
+    double xpMin = 0.0, xpMax = 0.0, ypMin = 0.0, ypMax = 0.0;
+    bool hasInvalidData = false;
+    d_ptr->pointsBoundingRect = QRectF();
 
     for(index = 0; index < siz; index++)
     {
@@ -523,6 +599,7 @@ const QPointF *SceneCurve::points()
             /* if y is NaN, then let the curve display the first valid value on the y axis */
             if(isnan(y)) /* put the previous value if available, lower bound otherwise */
             {
+                hasInvalidData = true;
                 int backidx = index;
                 while(--backidx >= 0)
                 {
@@ -543,7 +620,30 @@ const QPointF *SceneCurve::points()
 
 
         d_ptr->mPoints[index] = QPointF(xp, yp);
+
+        if(index == 0)
+        {
+            xpMin = xpMax = xp;
+            ypMin = ypMax = yp;
+        }
+        else
+        {
+            if(xp < xpMin)
+                xpMin = xp;
+            else if(xp > xpMax)
+                xpMax = xp;
+            if(yp < ypMin)
+                ypMin = yp;
+            else if(yp > ypMax)
+                ypMax = yp;
+        }
     }
+    if(hasInvalidData) /* invalid data markers span the whole canvas height */
+    {
+        ypMin = qMin(ypMin, d_ptr->canvasRectTop);
+        ypMax = qMax(ypMax, d_ptr->canvasRectTop + d_ptr->canvasRectH);
+    }
+    d_ptr->pointsBoundingRect = QRectF(QPointF(xpMin, ypMin), QPointF(xpMax, ypMax));
     /* we made the data object calculate all the positions for its points.
          * From the curve point of view, all its points positions are determined
          * We mark the x and y scene coordinates positions valid.
@@ -557,6 +657,129 @@ const QPointF *SceneCurve::points()
 }
 
 
+QRectF SceneCurve::pointsBoundingRect() const
+{
+    return d_ptr->pointsBoundingRect;
+}
+
+int SceneCurve::closestPoint(const QPointF &pos, double *distance)
+{
+    const QPointF *pts = points();
+    int siz = d_ptr->data->size();
+    if(!pts || siz <= 0 || siz != d_ptr->mPoints.size())
+        return -1;
+    if(!d_ptr->pointIndex.isValid(d_ptr->projectionStamp))
+        d_ptr->pointIndex.build(pts, siz, d_ptr->pointsBoundingRect, d_ptr->projectionStamp);
+    double squaredDistance;
+    int index = d_ptr->pointIndex.closest(pts, pos, &squaredDistance);
+    if(index >= 0 && distance)
+        *distance = sqrt(squaredDistance);
+    return index;
+}
+
+QPointF SceneCurve::scenePos(double x, double y) const
+{
+    double xp = (d_ptr->canvasRectW - 1) * (x - d_ptr->xlb) / (d_ptr->xextension) + d_ptr->canvasRectLeft;
+    double yp = d_ptr->canvasRectH - 1 - ((d_ptr->canvasRectH - 1) * (y - d_ptr->ylb) / (d_ptr->yextension) + d_ptr->canvasRectTop);
+    return QPointF(xp, yp);
+}
+
+double SceneCurve::xValue(double sceneX) const
+{
+    if(d_ptr->canvasRectW <= 1)
+        return d_ptr->xlb;
+    return d_ptr->xlb + (sceneX - d_ptr->canvasRectLeft) * d_ptr->xextension / (d_ptr->canvasRectW - 1);
+}
+
+unsigned long SceneCurve::memoryUsage() const
+{
+    return dataMemoryUsage() + projectionMemoryUsage() + layerMemoryUsage();
+}
+
+unsigned long SceneCurve::dataMemoryUsage() const
+{
+    const Data *d = d_ptr->data;
+    return (d->xData.capacity() + d->yData.capacity()) * sizeof(double);
+}
+
+unsigned long SceneCurve::projectionMemoryUsage() const
+{
+    return d_ptr->mPoints.capacity() * sizeof(QPointF) + d_ptr->pointIndex.memoryUsage();
+}
+
+unsigned long SceneCurve::layerMemoryUsage() const
+{
+    if(d_ptr->curveItem)
+        return d_ptr->curveItem->layerMemoryUsage();
+    return 0;
+}
+
+unsigned long SceneCurve::releaseCaches()
+{
+    unsigned long before = projectionMemoryUsage() + layerMemoryUsage();
+    d_ptr->mPoints = QVector<QPointF>();
+    d_ptr->pointIndex = PointIndex();
+    d_ptr->lastValidXPos = d_ptr->lastValidYPos = -1;
+    if(d_ptr->curveItem)
+    {
+        d_ptr->curveItem->releaseLayer();
+        d_ptr->curveItem->invalidateBoundingRect();
+    }
+    return before - (projectionMemoryUsage() + layerMemoryUsage());
+}
+
+unsigned long SceneCurve::compactHistory(double fraction, int factor)
+{
+    Data *d = d_ptr->data;
+    if(!d->scalarMode || fraction <= 0.0)
+        return 0;
+    unsigned long before = dataMemoryUsage();
+    if(d->compact(qRound(qMin(fraction, 1.0) * d->size()), factor) == 0)
+        return 0;
+    if(d_ptr->bufferSize > 0)
+    {
+        d_ptr->bufferSize = qMax(d->size(), 1);
+        foreach(CurveChangeListener *listener, d_ptr->itemChangeListeners)
+            listener->bufferSizeChanged(d_ptr->bufferSize);
+    }
+    mDataShrunk();
+    unsigned long after = dataMemoryUsage();
+    return before > after ? before - after : 0;
+}
+
+unsigned long SceneCurve::trimBuffer(int bufSiz)
+{
+    if(bufSiz <= 0)
+        return 0;
+    unsigned long before = dataMemoryUsage();
+    d_ptr->bufferSize = bufSiz;
+    foreach(CurveChangeListener *listener, d_ptr->itemChangeListeners)
+        listener->bufferSizeChanged(bufSiz);
+    d_ptr->data->remove(0, d_ptr->data->size() - bufSiz);
+    mDataShrunk();
+    unsigned long after = dataMemoryUsage();
+    return before > after ? before - after : 0;
+}
+
+/* after compactHistory or trimBuffer: give back the unused capacity, recalculate
+ * the bounds and let the listeners rebuild from the whole data
+ */
+void SceneCurve::mDataShrunk()
+{
+    Data *d = d_ptr->data;
+    int samples = qMax(d->size(), d_ptr->bufferSize);
+    DataPool::instance()->shrink(d->xData, samples);
+    DataPool::instance()->shrink(d->yData, samples);
+    d->calculateBounds();
+    invalidateCache();
+    foreach(CurveChangeListener *listener, d_ptr->itemChangeListeners)
+    {
+        listener->fullVectorUpdate();
+        listener->affectingBoundsPointsRemoved();
+    }
+    d_ptr->plot->requestRefresh();
+}
+
 bool SceneCurve::mRemovedItemAffectsBounds(const Point& toRemovePt)
 {
     return (toRemovePt.x == d_ptr->data->xMin) || (toRemovePt.x == d_ptr->data->xMax) ||
@@ -565,11 +788,11 @@ bool SceneCurve::mRemovedItemAffectsBounds(const Point& toRemovePt)
 
 int SceneCurve::mCheckBufferSize()
 {
-    QList<Point> itemsRemoved;
     int itemCount = d_ptr->data->size();
     bool removedItemAffectsBounds = false;
     if(d_ptr->bufferSize > -1)
     {
+        d_ptr->removedCount = 0;
         /* +1 because this is called before adding a new item
          */
         while(itemCount + 1 - d_ptr->bufferSize > 0)
@@ -581,9 +804,11 @@ int SceneCurve::mCheckBufferSize()
                 listener->itemAboutToBeRemoved(firstPoint);
 
             /* remove x and y data associated to the index of the first element */
-            d_ptr->data->remove(0);
+            d_ptr->data->removeOldest(1);
 
-            itemsRemoved << firstPoint;
+            if(d_ptr->removedCount == d_ptr->removedPoints.size())
+                d_ptr->removedPoints.resize(d_ptr->removedCount + 1);
+            d_ptr->removedPoints[d_ptr->removedCount++] = QPointF(firstPoint.x, firstPoint.y);
 
             itemCount--;
 
@@ -601,16 +826,19 @@ int SceneCurve::mCheckBufferSize()
         /* update curve y and x minimum and maximum values */
         if(removedItemAffectsBounds)
         {
+            PLOT_TIMING_SCOPE(d_ptr->plot->frameTimings(), FrameTimings::Bounds);
+            PLOT_TRACE_SCOPE("bounds");
             d_ptr->data->calculateBounds();
         }
         /* at the end, notify which items have been removed. At this point,
          * the curve bounds are up to date, so that the itemRemoved listeners can
          * obtain the correct bounds of the curve
          */
-        foreach(Point point, itemsRemoved)
+        for(int i = 0; i < d_ptr->removedCount; i++)
         {
+            const QPointF &removed = d_ptr->removedPoints.at(i);
             foreach(CurveChangeListener *listener, d_ptr->itemChangeListeners)
-                listener->itemRemoved(point);
+                listener->itemRemoved(Point(removed.x(), removed.y()));
         }
 
         if(removedItemAffectsBounds)
@@ -66,6 +66,11 @@ public:
 
     virtual void addPoint(double x, double y);
 
+    /** \brief appends xData and yData to the curve.
+      *
+      * If the curve is bounded (bufferSize), the oldest points exceeding the buffer
+      * size are removed at once.
+      */
     virtual void addPoints(const QVector<double>& xData, const QVector<double> &yData);
 
     Data *data() const;
@@ -148,6 +153,87 @@ public:
       */
     const QPointF* points();
 
+    /** \brief the bounding rect, in scene coordinates, of the points returned by the last
+     *         call to points()
+     *
+     * The rectangle is calculated by points() while projecting the data, so it is
+     * up to date after points() has been called. If the curve contains NaN y values,
+     * the rectangle spans the whole height of the canvas, so that the invalid data
+     * markers drawn by the item painters are included.
+     */
+    QRectF pointsBoundingRect() const;
+
+    /** \brief the index of the point closest to pos, in scene coordinates, -1 if the
+     *         curve has no points.
+     *
+     * The points are projected if needed (see points). The search uses an index
+     * that is built at the first query after each projection: a binary search when
+     * the projected x are ordered, a uniform grid otherwise. Queries are about
+     * O(log n) instead of a scan of all the points.
+     *
+     * @param distance if not NULL, stores the distance from pos, in scene coordinates
+     */
+    int closestPoint(const QPointF& pos, double *distance = NULL);
+
+    /** \brief the position, in scene coordinates, of the value (x, y), as projected
+     *         by points()
+     */
+    QPointF scenePos(double x, double y) const;
+
+    /** \brief the x value at the scene x coordinate sceneX, the inverse of the
+     *         projection used by points()
+     */
+    double xValue(double sceneX) const;
+
+    /** \brief an estimate of the memory, in bytes, allocated by the curve: the sum of
+     *         dataMemoryUsage, projectionMemoryUsage and layerMemoryUsage.
+     *
+     * The capacity of the vectors is taken into account, not only their size.
+     */
+    unsigned long memoryUsage() const;
+
+    /** \brief the memory, in bytes, allocated for the x and y data
+     */
+    unsigned long dataMemoryUsage() const;
+
+    /** \brief the memory, in bytes, allocated for the cache of the projected points
+     */
+    unsigned long projectionMemoryUsage() const;
+
+    /** \brief the memory, in bytes, of the raster layer of the CurveItem, if cached
+     *
+     * @see CurveItem::setCacheEnabled
+     */
+    unsigned long layerMemoryUsage() const;
+
+    /** \brief frees the cache of the projected points and the CurveItem layer.
+     *
+     * Both are built again at the next paint.
+     *
+     * @return the number of bytes freed
+     */
+    unsigned long releaseCaches();
+
+    /** \brief replaces the oldest part of the data with its min/max envelope.
+     *
+     * The oldest fraction of the points is compacted by Data::compact into two points
+     * every factor points. If the curve is bounded, the buffer size is lowered to the
+     * new number of points, so that the memory saved is not taken again by new data.
+     * Only curves fed with addPoint or addPoints are compacted.
+     *
+     * @return the number of bytes freed
+     */
+    unsigned long compactHistory(double fraction = 0.5, int factor = 8);
+
+    /** \brief lowers the buffer size to bufSiz, removing at once the oldest points that
+     *         exceed it, and frees the memory no longer needed.
+     *
+     * @return the number of bytes freed
+     *
+     * @see setBufferSize
+     */
+    unsigned long trimBuffer(int bufSiz);
+
     virtual void canvasRectChanged(const QRectF& newRect);
 
 signals:
@@ -167,6 +253,8 @@ private:
 
     int mCheckBufferSize();
 
+    void mDataShrunk();
+
     bool mRemovedItemAffectsBounds(const Point &toRemovePt);
 
     SceneCurvePrivate *d_ptr;
@@ -2,5 +2,6 @@
 
 SceneCurvePrivate::SceneCurvePrivate()
 {
-
+    removedCount = 0;
+    projectionStamp = 0;
 }
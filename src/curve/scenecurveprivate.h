@@ -14,6 +14,7 @@ class CurveItem;
 #include <QVector>
 #include <QRectF>
 #include "data.h"
+#include "pointindex.h"
 
 class SceneCurvePrivate
 {
@@ -47,7 +48,23 @@ public:
 
     QVector<QPointF> mPoints;
 
+    /* bounding rect of mPoints, computed together with the projection */
+    QRectF pointsBoundingRect;
+
+    /* incremented each time mPoints is projected again */
+    unsigned int projectionStamp;
+
+    /* nearest point index over mPoints, built lazily by closestPoint */
+    PointIndex pointIndex;
+
     QPolygon polygon;
+
+    /* x, y of the points evicted by mCheckBufferSize, notified after the bounds
+     * are up to date. Grows only: removedCount tells how many are valid.
+     */
+    QVector<QPointF> removedPoints;
+
+    int removedCount;
 };
 
 #endif // SCENECURVEPRIVATE_H
@@ -0,0 +1,549 @@
+#include "doubleformatter.h"
+#include "qgraphicsplotmacros.h"
+#include <string.h>
+#include <math.h>
+#include <locale.h>
+
+/* Grisu2, after "Printing Floating-Point Numbers Quickly and Accurately with
+ * Integers", F. Loitsch, PLDI 2010.
+ *
+ * The double is scaled by a cached power of ten into a 64 bit significand, the
+ * digits are generated from the scaled upper boundary of the rounding interval
+ * and the last one is adjusted towards the value. The result always reads back to
+ * the value and is the shortest one for the vast majority of the inputs; when it
+ * is not, it is one digit longer.
+ */
+
+/* a floating point number f * 2^e with a 64 bit significand */
+class DiyFp
+{
+public:
+    DiyFp(quint64 f, int e) : f(f), e(e) {}
+
+    explicit DiyFp(double d)
+    {
+        quint64 u;
+        memcpy(&u, &d, sizeof(d));
+        int biasedE = static_cast<int>((u & ExponentMask) >> SignificandSize);
+        quint64 significand = u & SignificandMask;
+        if(biasedE != 0)
+        {
+            f = significand + HiddenBit;
+            e = biasedE - ExponentBias;
+        }
+        else /* subnormal */
+        {
+            f = significand;
+            e = 1 - ExponentBias;
+        }
+    }
+
+    DiyFp operator-(const DiyFp& other) const
+    {
+        return DiyFp(f - other.f, e);
+    }
+
+    /* the upper 64 bits of the product, rounded */
+    DiyFp operator*(const DiyFp& other) const
+    {
+        const quint64 M32 = Q_UINT64_C(0xFFFFFFFF);
+        quint64 a = f >> 32, b = f & M32, c = other.f >> 32, d = other.f & M32;
+        quint64 ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+        quint64 tmp = (bd >> 32) + (ad & M32) + (bc & M32);
+        tmp += Q_UINT64_C(1) << 31;
+        return DiyFp(ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), e + other.e + 64);
+    }
+
+    DiyFp normalized() const
+    {
+        DiyFp r = *this;
+        while(!(r.f & HiddenBit))
+        {
+            r.f <<= 1;
+            r.e--;
+        }
+        r.f <<= 64 - SignificandSize - 1;
+        r.e -= 64 - SignificandSize - 1;
+        return r;
+    }
+
+    /* the boundaries m- and m+ of the rounding interval, with the exponent of m+ */
+    void boundaries(DiyFp *minus, DiyFp *plus) const
+    {
+        DiyFp p((f << 1) + 1, e - 1);
+        while(!(p.f & (HiddenBit << 1)))
+        {
+            p.f <<= 1;
+            p.e--;
+        }
+        p.f <<= 64 - SignificandSize - 2;
+        p.e -= 64 - SignificandSize - 2;
+        /* the lower boundary is closer for powers of two */
+        DiyFp m = (f == HiddenBit) ? DiyFp((f << 2) - 1, e - 2) : DiyFp((f << 1) - 1, e - 1);
+        m.f <<= m.e - p.e;
+        m.e = p.e;
+        *plus = p;
+        *minus = m;
+    }
+
+    quint64 f;
+
+    int e;
+
+    static const int SignificandSize = 52;
+
+    static const int ExponentBias = 0x3FF + SignificandSize;
+
+    static const quint64 ExponentMask = Q_UINT64_C(0x7FF0000000000000);
+
+    static const quint64 SignificandMask = Q_UINT64_C(0x000FFFFFFFFFFFFF);
+
+    static const quint64 HiddenBit = Q_UINT64_C(0x0010000000000000);
+};
+
+/* 10^k for k = -348, -340, ..., 340, normalized and rounded to 64 bits */
+static DiyFp cachedPower(int e, int *K)
+{
+    static const quint64 powF[] = {
+        Q_UINT64_C(0xfa8fd5a0081c0288), Q_UINT64_C(0xbaaee17fa23ebf76), Q_UINT64_C(0x8b16fb203055ac76), Q_UINT64_C(0xcf42894a5dce35ea),
+        Q_UINT64_C(0x9a6bb0aa55653b2d), Q_UINT64_C(0xe61acf033d1a45df), Q_UINT64_C(0xab70fe17c79ac6ca), Q_UINT64_C(0xff77b1fcbebcdc4f),
+        Q_UINT64_C(0xbe5691ef416bd60c), Q_UINT64_C(0x8dd01fad907ffc3c), Q_UINT64_C(0xd3515c2831559a83), Q_UINT64_C(0x9d71ac8fada6c9b5),
+        Q_UINT64_C(0xea9c227723ee8bcb), Q_UINT64_C(0xaecc49914078536d), Q_UINT64_C(0x823c12795db6ce57), Q_UINT64_C(0xc21094364dfb5637),
+        Q_UINT64_C(0x9096ea6f3848984f), Q_UINT64_C(0xd77485cb25823ac7), Q_UINT64_C(0xa086cfcd97bf97f4), Q_UINT64_C(0xef340a98172aace5),
+        Q_UINT64_C(0xb23867fb2a35b28e), Q_UINT64_C(0x84c8d4dfd2c63f3b), Q_UINT64_C(0xc5dd44271ad3cdba), Q_UINT64_C(0x936b9fcebb25c996),
+        Q_UINT64_C(0xdbac6c247d62a584), Q_UINT64_C(0xa3ab66580d5fdaf6), Q_UINT64_C(0xf3e2f893dec3f126), Q_UINT64_C(0xb5b5ada8aaff80b8),
+        Q_UINT64_C(0x87625f056c7c4a8b), Q_UINT64_C(0xc9bcff6034c13053), Q_UINT64_C(0x964e858c91ba2655), Q_UINT64_C(0xdff9772470297ebd),
+        Q_UINT64_C(0xa6dfbd9fb8e5b88f), Q_UINT64_C(0xf8a95fcf88747d94), Q_UINT64_C(0xb94470938fa89bcf), Q_UINT64_C(0x8a08f0f8bf0f156b),
+        Q_UINT64_C(0xcdb02555653131b6), Q_UINT64_C(0x993fe2c6d07b7fac), Q_UINT64_C(0xe45c10c42a2b3b06), Q_UINT64_C(0xaa242499697392d3),
+        Q_UINT64_C(0xfd87b5f28300ca0e), Q_UINT64_C(0xbce5086492111aeb), Q_UINT64_C(0x8cbccc096f5088cc), Q_UINT64_C(0xd1b71758e219652c),
+        Q_UINT64_C(0x9c40000000000000), Q_UINT64_C(0xe8d4a51000000000), Q_UINT64_C(0xad78ebc5ac620000), Q_UINT64_C(0x813f3978f8940984),
+        Q_UINT64_C(0xc097ce7bc90715b3), Q_UINT64_C(0x8f7e32ce7bea5c70), Q_UINT64_C(0xd5d238a4abe98068), Q_UINT64_C(0x9f4f2726179a2245),
+        Q_UINT64_C(0xed63a231d4c4fb27), Q_UINT64_C(0xb0de65388cc8ada8), Q_UINT64_C(0x83c7088e1aab65db), Q_UINT64_C(0xc45d1df942711d9a),
+        Q_UINT64_C(0x924d692ca61be758), Q_UINT64_C(0xda01ee641a708dea), Q_UINT64_C(0xa26da3999aef774a), Q_UINT64_C(0xf209787bb47d6b85),
+        Q_UINT64_C(0xb454e4a179dd1877), Q_UINT64_C(0x865b86925b9bc5c2), Q_UINT64_C(0xc83553c5c8965d3d), Q_UINT64_C(0x952ab45cfa97a0b3),
+        Q_UINT64_C(0xde469fbd99a05fe3), Q_UINT64_C(0xa59bc234db398c25), Q_UINT64_C(0xf6c69a72a3989f5c), Q_UINT64_C(0xb7dcbf5354e9bece),
+        Q_UINT64_C(0x88fcf317f22241e2), Q_UINT64_C(0xcc20ce9bd35c78a5), Q_UINT64_C(0x98165af37b2153df), Q_UINT64_C(0xe2a0b5dc971f303a),
+        Q_UINT64_C(0xa8d9d1535ce3b396), Q_UINT64_C(0xfb9b7cd9a4a7443c), Q_UINT64_C(0xbb764c4ca7a44410), Q_UINT64_C(0x8bab8eefb6409c1a),
+        Q_UINT64_C(0xd01fef10a657842c), Q_UINT64_C(0x9b10a4e5e9913129), Q_UINT64_C(0xe7109bfba19c0c9d), Q_UINT64_C(0xac2820d9623bf429),
+        Q_UINT64_C(0x80444b5e7aa7cf85), Q_UINT64_C(0xbf21e44003acdd2d), Q_UINT64_C(0x8e679c2f5e44ff8f), Q_UINT64_C(0xd433179d9c8cb841),
+        Q_UINT64_C(0x9e19db92b4e31ba9), Q_UINT64_C(0xeb96bf6ebadf77d9), Q_UINT64_C(0xaf87023b9bf0ee6b)
+    };
+    static const short powE[] = {
+        -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+        -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+        -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+        -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+        -157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+        109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+        375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+        641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+        907, 933, 960, 986, 1013, 1039, 1066
+    };
+    /* the power that brings the binary exponent into [-60, -32] */
+    double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int k = static_cast<int>(dk);
+    if(dk - k > 0.0)
+        k++;
+    unsigned index = static_cast<unsigned>((k >> 3) + 1);
+    *K = -(-348 + static_cast<int>(index << 3));
+    return DiyFp(powF[index], powE[index]);
+}
+
+static const quint32 pow10Int[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000,
+                                    100000000, 1000000000 };
+
+/* 10^0 ... 10^19, the powers of ten that fit in 64 bits */
+static const quint64 pow10Int64[] = {
+    Q_UINT64_C(1), Q_UINT64_C(10), Q_UINT64_C(100), Q_UINT64_C(1000), Q_UINT64_C(10000),
+    Q_UINT64_C(100000), Q_UINT64_C(1000000), Q_UINT64_C(10000000), Q_UINT64_C(100000000),
+    Q_UINT64_C(1000000000), Q_UINT64_C(10000000000), Q_UINT64_C(100000000000),
+    Q_UINT64_C(1000000000000), Q_UINT64_C(10000000000000), Q_UINT64_C(100000000000000),
+    Q_UINT64_C(1000000000000000), Q_UINT64_C(10000000000000000),
+    Q_UINT64_C(100000000000000000), Q_UINT64_C(1000000000000000000),
+    Q_UINT64_C(10000000000000000000) };
+
+static int decimalDigits(quint32 n)
+{
+    int d = 1;
+    while(d < 10 && n >= pow10Int[d])
+        d++;
+    return d;
+}
+
+/* moves the last digit towards the value while the result stays inside the interval */
+static void grisuRound(char *buf, int len, quint64 delta, quint64 rest, quint64 tenKappa, quint64 wpW)
+{
+    while(rest < wpW && delta - rest >= tenKappa &&
+          (rest + tenKappa < wpW || wpW - rest > rest + tenKappa - wpW))
+    {
+        buf[len - 1]--;
+        rest += tenKappa;
+    }
+}
+
+static void digitGen(const DiyFp& W, const DiyFp& Mp, quint64 delta, char *buf, int *len, int *K)
+{
+    const DiyFp one(Q_UINT64_C(1) << -Mp.e, Mp.e);
+    const DiyFp wpW = Mp - W;
+    quint32 p1 = static_cast<quint32>(Mp.f >> -one.e);
+    quint64 p2 = Mp.f & (one.f - 1);
+    int kappa = decimalDigits(p1);
+    *len = 0;
+    /* integral part */
+    while(kappa > 0)
+    {
+        quint32 div = pow10Int[kappa - 1];
+        quint32 d = p1 / div;
+        p1 %= div;
+        if(d || *len)
+            buf[(*len)++] = static_cast<char>('0' + d);
+        kappa--;
+        quint64 tmp = (static_cast<quint64>(p1) << -one.e) + p2;
+        if(tmp <= delta)
+        {
+            *K += kappa;
+            grisuRound(buf, *len, delta, tmp, static_cast<quint64>(pow10Int[kappa]) << -one.e, wpW.f);
+            return;
+        }
+    }
+    /* fractional part */
+    for(;;)
+    {
+        p2 *= 10;
+        delta *= 10;
+        char d = static_cast<char>(p2 >> -one.e);
+        if(d || *len)
+            buf[(*len)++] = static_cast<char>('0' + d);
+        p2 &= one.f - 1;
+        kappa--;
+        if(p2 < delta)
+        {
+            *K += kappa;
+            int index = -kappa;
+            grisuRound(buf, *len, delta, p2, one.f, wpW.f * (index < 20 ? pow10Int64[index] : 0));
+            return;
+        }
+    }
+}
+
+/* the digits of v > 0 into buf, v = digits * 10^K */
+static void grisu2(double v, char *buf, int *len, int *K)
+{
+    const DiyFp d(v);
+    DiyFp minus(0, 0), plus(0, 0);
+    d.boundaries(&minus, &plus);
+    const DiyFp c = cachedPower(plus.e, K);
+    const DiyFp W = d.normalized() * c;
+    DiyFp Wp = plus * c;
+    DiyFp Wm = minus * c;
+    /* stay inside the interval despite the rounding of the products */
+    Wm.f++;
+    Wp.f--;
+    digitGen(W, Wp, Wp.f - Wm.f, buf, len, K);
+}
+
+static int writeExponent(int e, char *buf)
+{
+    int n = 0;
+    if(e < 0)
+    {
+        buf[n++] = '-';
+        e = -e;
+    }
+    if(e >= 100)
+    {
+        buf[n++] = static_cast<char>('0' + e / 100);
+        e %= 100;
+        buf[n++] = static_cast<char>('0' + e / 10);
+    }
+    else if(e >= 10)
+        buf[n++] = static_cast<char>('0' + e / 10);
+    buf[n++] = static_cast<char>('0' + e % 10);
+    return n;
+}
+
+/* places the decimal point in the len digits of buf, worth digits * 10^k */
+static int prettify(char *buf, int len, int k)
+{
+    const int kk = len + k; /* 10^(kk - 1) <= v < 10^kk */
+    if(len <= kk && kk <= 21) /* 1234e7 -> 12340000000 */
+    {
+        for(int i = len; i < kk; i++)
+            buf[i] = '0';
+        return kk;
+    }
+    else if(0 < kk && kk <= 21) /* 1234e-2 -> 12.34 */
+    {
+        memmove(&buf[kk + 1], &buf[kk], len - kk);
+        buf[kk] = '.';
+        return len + 1;
+    }
+    else if(-6 < kk && kk <= 0) /* 1234e-6 -> 0.001234 */
+    {
+        const int offset = 2 - kk;
+        memmove(&buf[offset], &buf[0], len);
+        buf[0] = '0';
+        buf[1] = '.';
+        for(int i = 2; i < offset; i++)
+            buf[i] = '0';
+        return len + offset;
+    }
+    else if(len == 1) /* 1e30 */
+    {
+        buf[1] = 'e';
+        return 2 + writeExponent(kk - 1, &buf[2]);
+    }
+    /* 1234e30 -> 1.234e33 */
+    memmove(&buf[2], &buf[1], len - 1);
+    buf[1] = '.';
+    buf[len + 1] = 'e';
+    return len + 2 + writeExponent(kk - 1, &buf[len + 2]);
+}
+
+/* qsnprintf follows LC_NUMERIC: with a comma decimal locale, "%g" writes "1,5".
+ * Puts the point back in place of the decimal separator of the locale in the len
+ * characters of a number written by qsnprintf. Returns the new length.
+ */
+static int toCDecimalPoint(char *buf, int len)
+{
+    const char *dp = localeconv()->decimal_point;
+    if(!dp || dp[0] == 0 || (dp[0] == '.' && dp[1] == 0))
+        return len;
+    const int dplen = strlen(dp);
+    for(int i = 0; i + dplen <= len; i++)
+    {
+        if(memcmp(buf + i, dp, dplen) == 0)
+        {
+            buf[i] = '.';
+            memmove(buf + i + 1, buf + i + dplen, len - i - dplen);
+            return len - dplen + 1;
+        }
+    }
+    return len;
+}
+
+/* the literal text of a printf format, "%%" standing for "%" */
+static QByteArray printfText(const QByteArray& f)
+{
+    QByteArray t(f);
+    t.replace("%%", "%");
+    return t;
+}
+
+static inline bool isNegative(double v)
+{
+    return v < 0 || (v == 0 && 1.0 / v < 0);
+}
+
+DoubleFormatter::DoubleFormatter(const QString& format)
+{
+    setFormat(format);
+}
+
+void DoubleFormatter::setFormat(const QString& format)
+{
+    mFormat = format;
+    mPrintfFormat.clear();
+    mPrintfPrefix.clear();
+    mPrintfSuffix.clear();
+    mMode = Shortest;
+    mPrecision = -1;
+    if(format.isEmpty() || format == "%r")
+        return;
+
+    QByteArray f = format.toUtf8();
+    int conversions = 0, convBegin = 0, convEnd = 0;
+    bool valid = true;
+    for(int i = 0; i < f.size() && valid; i++)
+    {
+        if(f.at(i) != '%')
+            continue;
+        if(i + 1 < f.size() && f.at(i + 1) == '%')
+        {
+            i++;
+            continue;
+        }
+        /* %[flags][width][.precision][l|L]conversion */
+        int j = i + 1;
+        while(j < f.size() && f.at(j) != 0 && strchr("-+ #0", f.at(j)))
+            j++;
+        while(j < f.size() && f.at(j) >= '0' && f.at(j) <= '9')
+            j++;
+        if(j < f.size() && f.at(j) == '.')
+            for(j++; j < f.size() && f.at(j) >= '0' && f.at(j) <= '9'; j++)
+                ;
+        /* no effect on a double, or a long double expected: drop it */
+        if(j < f.size() && (f.at(j) == 'l' || f.at(j) == 'L'))
+            f.remove(j, 1);
+        if(j < f.size() && f.at(j) != 0 && strchr("eEfFgGaA", f.at(j)))
+        {
+            conversions++;
+            convBegin = i;
+            convEnd = j + 1;
+            i = j;
+        }
+        else
+            valid = false;
+    }
+    if(!valid || conversions != 1)
+    {
+        perr("DoubleFormatter::setFormat: \"%s\" is not a format for one double: "
+             "the shortest representation will be used", qstoc(format));
+        return;
+    }
+
+    if(f == "%f")
+        mPrecision = 6;
+    else if(f.size() >= 3 && f.startsWith("%.") && f.endsWith('f'))
+    {
+        /* only digits between the point and the conversion */
+        int p = 0;
+        for(int i = 2; i < f.size() - 1 && p >= 0; i++)
+            p = (f.at(i) >= '0' && f.at(i) <= '9' && p <= 17) ? p * 10 + f.at(i) - '0' : -1;
+        if(p >= 0 && p <= 17)
+            mPrecision = p;
+    }
+
+    if(mPrecision >= 0)
+        mMode = Fixed;
+    else
+    {
+        /* only the conversion goes through qsnprintf, so that the decimal separator
+         * can be told apart from the text around it
+         */
+        mMode = Printf;
+        mPrintfPrefix = printfText(f.left(convBegin));
+        mPrintfFormat = f.mid(convBegin, convEnd - convBegin);
+        mPrintfSuffix = printfText(f.mid(convEnd));
+    }
+}
+
+QString DoubleFormatter::formatString() const
+{
+    return mFormat;
+}
+
+DoubleFormatter::Mode DoubleFormatter::mode() const
+{
+    return mMode;
+}
+
+int DoubleFormatter::precision() const
+{
+    return mPrecision;
+}
+
+int DoubleFormatter::write(double v, char *buf) const
+{
+    if(mMode == Fixed)
+        return fixed(v, mPrecision, buf);
+    else if(mMode == Printf)
+    {
+        int n = qMin(mPrintfPrefix.size(), BufferSize - 1);
+        memcpy(buf, mPrintfPrefix.constData(), n);
+        int len = qBound(0, qsnprintf(buf + n, BufferSize - n, mPrintfFormat.constData(), v), BufferSize - 1 - n);
+        n += toCDecimalPoint(buf + n, len);
+        len = qMin(mPrintfSuffix.size(), BufferSize - 1 - n);
+        memcpy(buf + n, mPrintfSuffix.constData(), len);
+        return n + len;
+    }
+    return shortest(v, buf);
+}
+
+void DoubleFormatter::append(double v, QByteArray& out) const
+{
+    char buf[BufferSize];
+    out.append(buf, write(v, buf));
+}
+
+QString DoubleFormatter::format(double v) const
+{
+    char buf[BufferSize];
+    int len = write(v, buf);
+    /* the text around a printf conversion may be anything */
+    if(mMode == Printf)
+        return QString::fromUtf8(buf, len);
+    return QString::fromLatin1(buf, len);
+}
+
+int DoubleFormatter::shortest(double v, char *buf)
+{
+    if(v != v)
+    {
+        memcpy(buf, "nan", 3);
+        return 3;
+    }
+    int n = 0;
+    if(isNegative(v))
+    {
+        buf[n++] = '-';
+        v = -v;
+    }
+    if(v == 0)
+    {
+        buf[n++] = '0';
+        return n;
+    }
+    if(v > 1.7976931348623157e308)
+    {
+        memcpy(buf + n, "inf", 3);
+        return n + 3;
+    }
+    int len, K;
+    grisu2(v, buf + n, &len, &K);
+    return n + prettify(buf + n, len, K);
+}
+
+int DoubleFormatter::fixed(double v, int precision, char *buf)
+{
+    static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+                                    1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17 };
+    precision = qBound(0, precision, 17);
+    double a = fabs(v);
+    /* pow10 entries are exact, so the product is within half an ulp of a * 10^precision.
+     * Beyond 2^53 (and for nan and inf) the integer part is not exact anymore.
+     */
+    double s = a * pow10[precision];
+    if(s < 9007199254740992.0)
+    {
+        double fl = floor(s);
+        double tie = s - fl - 0.5; /* exact */
+        /* leave the ties (and what may be a tie before the rounding of the product) to printf */
+        if(fabs(tie) > s * 4.5e-16)
+        {
+            quint64 r = static_cast<quint64>(fl) + (tie > 0 ? 1 : 0);
+            quint64 scale = static_cast<quint64>(pow10[precision]);
+            quint64 ip = r / scale, fp = r % scale;
+            char digits[20];
+            int n = 0, nd = 0;
+            if(isNegative(v))
+                buf[n++] = '-';
+            do
+            {
+                digits[nd++] = static_cast<char>('0' + ip % 10);
+                ip /= 10;
+            } while(ip > 0);
+            while(nd > 0)
+                buf[n++] = digits[--nd];
+            if(precision > 0)
+            {
+                buf[n++] = '.';
+                for(int i = precision - 1; i >= 0; i--)
+                {
+                    buf[n + i] = static_cast<char>('0' + fp % 10);
+                    fp /= 10;
+                }
+                n += precision;
+            }
+            return n;
+        }
+    }
+    int len = qBound(0, qsnprintf(buf, BufferSize, "%.*f", precision, v), BufferSize - 1);
+    return toCDecimalPoint(buf, len);
+}
+
+QString DoubleFormatter::shortestString(double v)
+{
+    char buf[32];
+    return QString::fromLatin1(buf, shortest(v, buf));
+}
@@ -0,0 +1,107 @@
+#ifndef DOUBLEFORMATTER_H
+#define DOUBLEFORMATTER_H
+
+#include <QString>
+#include <QByteArray>
+
+/** \brief Converts doubles to text quickly, into caller provided buffers.
+ *
+ * QString::sprintf(qstoc(format), value) converts the format to a std::string and
+ * parses it at each call, then builds a QString. The DoubleFormatter parses the
+ * format once, in setFormat, and writes the digits into a char buffer of at least
+ * BufferSize bytes, so that labels and files can be composed without temporary
+ * strings.
+ *
+ * \par Modes
+ * \li Shortest: the shortest decimal representation that reads back (strtod,
+ *     QString::toDouble) to the very same double. Digits are generated with the
+ *     Grisu2 algorithm, that needs no big integer arithmetic. The notation is fixed
+ *     for decimal exponents between -6 and 21, scientific ("1.5e-7") otherwise.
+ *     Selected by an empty format or by "%r";
+ * \li Fixed: "%f" and "%.Nf" with N up to 17, with the same output as printf.
+ *     Values that can be scaled to an integer exactly are converted with integer
+ *     arithmetic; the others, and the values lying on (or too close to) a rounding
+ *     tie, are left to qsnprintf;
+ * \li Printf: any other format with a single floating point conversion
+ *     (e, E, f, F, g, G, a, A), possibly surrounded by text, is passed to qsnprintf.
+ *     The output is truncated to BufferSize - 1 characters.
+ *
+ * Formats without a floating point conversion, or with more than one, are rejected
+ * in favour of Shortest: printf would read arguments that are not there.
+ * The length modifiers l and L ("%.2lf", "%Lg") are accepted and dropped: the value
+ * is always a double.
+ *
+ * The decimal separator is always the point, as in QString::sprintf, whatever the
+ * LC_NUMERIC locale qsnprintf follows.
+ *
+ * \par Example
+ * \code
+ * DoubleFormatter f("%.3f");
+ * char buf[DoubleFormatter::BufferSize];
+ * int len = f.write(2.0 / 3.0, buf); // "0.667", len 5
+ * QString s = DoubleFormatter::shortestString(0.1); // "0.1"
+ * \endcode
+ *
+ * @see ScaleItem::setAxisLabelsFormat
+ * @see PlotSceneWidgetSaver
+ */
+class DoubleFormatter
+{
+public:
+    enum Mode { Shortest, Fixed, Printf };
+
+    /* the minimum size of the buffers passed to write */
+    enum { BufferSize = 384 };
+
+    DoubleFormatter(const QString& format = QString());
+
+    void setFormat(const QString& format);
+
+    QString formatString() const;
+
+    Mode mode() const;
+
+    /** \brief the number of decimals of the Fixed mode, -1 in the other modes
+     */
+    int precision() const;
+
+    /** \brief writes v into buf, that must be at least BufferSize bytes long.
+     *
+     * @return the number of characters written. The text is not null terminated.
+     */
+    int write(double v, char *buf) const;
+
+    /** \brief appends v to out
+     */
+    void append(double v, QByteArray& out) const;
+
+    QString format(double v) const;
+
+    /** \brief writes the shortest representation of v that reads back to v.
+     *
+     * At most 25 characters are written.
+     */
+    static int shortest(double v, char *buf);
+
+    /** \brief writes v with the given number of decimals, as printf "%.*f" would.
+     *
+     * @param precision between 0 and 17
+     */
+    static int fixed(double v, int precision, char *buf);
+
+    static QString shortestString(double v);
+
+private:
+    QString mFormat;
+
+    /* the conversion of the Printf mode, in the encoding of qsnprintf, and the
+     * text before and after it
+     */
+    QByteArray mPrintfFormat, mPrintfPrefix, mPrintfSuffix;
+
+    Mode mMode;
+
+    int mPrecision;
+};
+
+#endif // DOUBLEFORMATTER_H
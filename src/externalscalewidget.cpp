@@ -3,6 +3,7 @@
 #include <QPainter>
 #include "qgraphicsplotmacros.h"
 #include "scalelabelinterface.h"
+#include "statictextcache.h"
 #include <QtDebug>
 #include <math.h>
 #include <QScrollBar>
@@ -23,6 +24,8 @@ public:
     Qt::Alignment alignment;
     ScaleLabelInterface *scaleLabelInterface;
     QPen pen;
+    /* labels laid out with the widget font */
+    StaticTextCache labelTexts;
 };
 
 ExternalScaleWidget::ExternalScaleWidget(QWidget *parent, ScaleItem::Orientation orientation) :
@@ -422,6 +425,8 @@ void ExternalScaleWidget::paintEvent(QPaintEvent *)
     QFont f = p.font();
     QFontMetrics fm(f);
     int fontHeight = fm.height();
+    d_ptr->labelTexts.setFont(f);
+    QStaticText label;
 
     origin = (d_ptr->len - 1) * d_ptr->originPercentage;
     /* qRound(origin) % qRound(pixstep) */
@@ -506,12 +511,16 @@ void ExternalScaleWidget::paintEvent(QPaintEvent *)
                 p.translate(tick + offset_align, 0);
                 p.rotate(d_ptr->labelRotation);
 //                p.drawRect(QRect(0, -fontHeight/2, d_ptr->longestLabelWidth, fontHeight));
-                p.drawText(QRect(0, -fontHeight/2, d_ptr->longestLabelWidth, fontHeight), Qt::AlignRight, valueStr);
+                /* right aligned in a longestLabelWidth wide rect */
+                label = d_ptr->labelTexts.text(valueStr);
+                p.drawStaticText(QPointF(d_ptr->longestLabelWidth - label.size().width(), -fontHeight/2), label);
                 p.rotate(-d_ptr->labelRotation);
                 p.translate( -(tick + offset_align), -0);
             }
-            else
-                p.drawText(tick + offset_align, d_ptr->tickLen + d_ptr->labelDistFromTick + fm.height(), valueStr);
+            else /* the static text position is its top left corner, not the baseline */
+                p.drawStaticText(QPointF((int) (tick + offset_align),
+                                         d_ptr->tickLen + d_ptr->labelDistFromTick + fm.height() - fm.ascent()),
+                                 d_ptr->labelTexts.text(valueStr));
 
 
         }
@@ -577,7 +586,9 @@ void ExternalScaleWidget::paintEvent(QPaintEvent *)
             else
                 valueStr = QString().sprintf(qstoc(format), val);
 
-            p.drawText(txtx + d_ptr->labelDistFromTick, tick + fontHeight/2 + offset_align, valueStr);
+            p.drawStaticText(QPointF((int) (txtx + d_ptr->labelDistFromTick),
+                                     (int) (tick + fontHeight/2 + offset_align) - fm.ascent()),
+                             d_ptr->labelTexts.text(valueStr));
         }
         break;
     }
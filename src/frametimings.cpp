@@ -0,0 +1,165 @@
+#include "frametimings.h"
+#include "plotscenewidget.h"
+#include <QGraphicsScene>
+#include <QtAlgorithms>
+#include <math.h>
+
+class FrameTimingsPrivate
+{
+public:
+    int windowSize;
+
+    /* one ring buffer, write position and histogram per stage */
+    QVector<double> samples[FrameTimings::StageCount];
+
+    int writePos[FrameTimings::StageCount];
+
+    unsigned long totalCount[FrameTimings::StageCount];
+
+    QVector<int> histograms[FrameTimings::StageCount];
+
+    static int bucket(double us);
+};
+
+int FrameTimingsPrivate::bucket(double us)
+{
+    if(us < 1.0)
+        return 0;
+    int b = (int) (log(us) / log(2.0));
+    return qMin(b, (int) FrameTimings::HistogramBuckets - 1);
+}
+
+FrameTimings::FrameTimings(int windowSize)
+{
+    d_ptr = new FrameTimingsPrivate();
+    d_ptr->windowSize = qMax(1, windowSize);
+    for(int i = 0; i < StageCount; i++)
+    {
+        d_ptr->samples[i].reserve(d_ptr->windowSize);
+        d_ptr->histograms[i] = QVector<int>(HistogramBuckets, 0);
+        d_ptr->writePos[i] = 0;
+        d_ptr->totalCount[i] = 0;
+    }
+}
+
+FrameTimings::~FrameTimings()
+{
+    delete d_ptr;
+}
+
+int FrameTimings::painterStage(int painterType)
+{
+    /* ItemPainterInterface::Type: Line = 0, Dot, Cross, Histogram, Step, Pie, CircleItemSet */
+    if(painterType >= 0 && painterType <= PaintCircleItemSet - PaintLine)
+        return PaintLine + painterType;
+    return PaintUser;
+}
+
+QString FrameTimings::stageName(int stage)
+{
+    static const char *names[StageCount] = { "ingest", "bounds", "projection", "axes", "legend",
+                                             "overlay", "frame", "paint line", "paint dots",
+                                             "paint cross", "paint histogram", "paint steps",
+                                             "paint pie", "paint circle item set", "paint user" };
+    if(stage >= 0 && stage < StageCount)
+        return QString(names[stage]);
+    return QString();
+}
+
+FrameTimings *FrameTimings::forScene(QGraphicsScene *scene)
+{
+    /* the GraphicsScene is a child of the PlotSceneWidget */
+    if(scene)
+    {
+        PlotSceneWidget *plot = qobject_cast<PlotSceneWidget *>(scene->parent());
+        if(plot)
+            return plot->frameTimings();
+    }
+    return NULL;
+}
+
+void FrameTimings::addSample(int stage, double us)
+{
+    if(stage < 0 || stage >= StageCount)
+        return;
+    QVector<double> &samples = d_ptr->samples[stage];
+    if(samples.size() < d_ptr->windowSize)
+        samples.append(us);
+    else
+    {
+        /* evict the oldest sample from the histogram */
+        int &pos = d_ptr->writePos[stage];
+        d_ptr->histograms[stage][FrameTimingsPrivate::bucket(samples[pos])]--;
+        samples[pos] = us;
+        pos = (pos + 1) % d_ptr->windowSize;
+    }
+    d_ptr->histograms[stage][FrameTimingsPrivate::bucket(us)]++;
+    d_ptr->totalCount[stage]++;
+}
+
+int FrameTimings::windowSize() const
+{
+    return d_ptr->windowSize;
+}
+
+int FrameTimings::sampleCount(int stage) const
+{
+    if(stage < 0 || stage >= StageCount)
+        return 0;
+    return d_ptr->samples[stage].size();
+}
+
+unsigned long FrameTimings::totalCount(int stage) const
+{
+    if(stage < 0 || stage >= StageCount)
+        return 0;
+    return d_ptr->totalCount[stage];
+}
+
+double FrameTimings::mean(int stage) const
+{
+    if(sampleCount(stage) == 0)
+        return 0.0;
+    double sum = 0.0;
+    foreach(double s, d_ptr->samples[stage])
+        sum += s;
+    return sum / d_ptr->samples[stage].size();
+}
+
+double FrameTimings::max(int stage) const
+{
+    double m = 0.0;
+    if(sampleCount(stage) > 0)
+        foreach(double s, d_ptr->samples[stage])
+            if(s > m)
+                m = s;
+    return m;
+}
+
+double FrameTimings::percentile(int stage, double p) const
+{
+    if(sampleCount(stage) == 0)
+        return 0.0;
+    QVector<double> sorted = d_ptr->samples[stage];
+    qSort(sorted);
+    int index = qBound(0, (int) ceil(p / 100.0 * sorted.size()) - 1, sorted.size() - 1);
+    return sorted.at(index);
+}
+
+QVector<int> FrameTimings::histogram(int stage) const
+{
+    if(stage < 0 || stage >= StageCount)
+        return QVector<int>();
+    return d_ptr->histograms[stage];
+}
+
+void FrameTimings::clear()
+{
+    for(int i = 0; i < StageCount; i++)
+    {
+        d_ptr->samples[i].clear();
+        d_ptr->histograms[i].fill(0);
+        d_ptr->writePos[i] = 0;
+        d_ptr->totalCount[i] = 0;
+    }
+}
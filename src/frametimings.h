@@ -0,0 +1,141 @@
+#ifndef FRAMETIMINGS_H
+#define FRAMETIMINGS_H
+
+#include <QElapsedTimer>
+#include <QVector>
+#include <QString>
+
+class FrameTimingsPrivate;
+class QGraphicsScene;
+
+/** \brief Collects the time spent in each stage of the render pipeline of a
+ *         PlotSceneWidget.
+ *
+ * For each stage, the last windowSize samples are kept in a ring buffer together
+ * with a rolling histogram of their durations, so that the statistics always refer
+ * to the recent frames.
+ *
+ * The stages are:
+ * \li Ingest: SceneCurve::addPoint, addPoints and setData;
+ * \li Bounds: calculation of the curve bounds and autoscale of the axes;
+ * \li Projection: SceneCurve::points(), when the points are projected again;
+ * \li Axes: ScaleItem::paint;
+ * \li Legend: LegendItem::paint;
+ * \li Overlay: MarkerItem::paint, CrosshairItem::paint and the zoom rectangle;
+ * \li Frame: the whole PlotSceneWidget::paintEvent;
+ * \li one stage per ItemPainterInterface::Type, measuring ItemPainterInterface::draw.
+ *     The points are projected before the painters are called: the Projection time
+ *     is not part of these stages.
+ *
+ * Instrumentation is enabled with PlotSceneWidget::setFrameTimingsEnabled and the
+ * FrameTimings object is available through PlotSceneWidget::frameTimings.
+ * When it is disabled, each measuring point costs a pointer test.
+ * Defining QGRAPHICSPLOT_NO_TIMINGS at build time removes the measuring points
+ * altogether.
+ *
+ * Durations are expressed in microseconds.
+ *
+ * \par Example
+ * \code
+ * plot->setFrameTimingsEnabled(true);
+ * // ... later
+ * FrameTimings *ft = plot->frameTimings();
+ * for(int i = 0; i < FrameTimings::StageCount; i++)
+ *     printf("%s: mean %.1fus p95 %.1fus\n", qstoc(FrameTimings::stageName(i)),
+ *             ft->mean(i), ft->percentile(i, 95));
+ * \endcode
+ */
+class FrameTimings
+{
+public:
+    enum Stage { Ingest = 0, Bounds, Projection, Axes, Legend, Overlay, Frame,
+                 PaintLine, PaintDots, PaintCross, PaintHistogram, PaintSteps, PaintPie,
+                 PaintCircleItemSet, PaintUser, StageCount };
+
+    /* histogram bucket i contains the samples in [2^i, 2^(i+1)) microseconds */
+    enum { HistogramBuckets = 24 };
+
+    explicit FrameTimings(int windowSize = 512);
+
+    virtual ~FrameTimings();
+
+    /** \brief maps an ItemPainterInterface::Type to its stage
+     */
+    static int painterStage(int painterType);
+
+    static QString stageName(int stage);
+
+    /** \brief returns the FrameTimings of the PlotSceneWidget owning the scene, if
+     *         instrumentation is enabled, NULL otherwise.
+     */
+    static FrameTimings *forScene(QGraphicsScene *scene);
+
+    void addSample(int stage, double us);
+
+    int windowSize() const;
+
+    /** \brief the number of samples currently in the window of the given stage
+     */
+    int sampleCount(int stage) const;
+
+    /** \brief the total number of samples ever recorded for the given stage
+     */
+    unsigned long totalCount(int stage) const;
+
+    double mean(int stage) const;
+
+    double max(int stage) const;
+
+    /** \brief the p-th percentile (0 <= p <= 100) of the samples in the window
+     */
+    double percentile(int stage, double p) const;
+
+    /** \brief the rolling histogram of the given stage.
+     *
+     * @return a vector of HistogramBuckets elements: element i counts the samples
+     *         that took between 2^i and 2^(i+1) microseconds.
+     */
+    QVector<int> histogram(int stage) const;
+
+    void clear();
+
+private:
+    FrameTimingsPrivate *d_ptr;
+};
+
+/** \brief measures the lifetime of the scope and adds it to the given stage.
+ *
+ * Does nothing if timings is NULL.
+ */
+class FrameTimingScope
+{
+public:
+    FrameTimingScope(FrameTimings *timings, int stage) : mTimings(timings), mStage(stage)
+    {
+        if(mTimings)
+            mTimer.start();
+    }
+
+    ~FrameTimingScope()
+    {
+        if(mTimings)
+            mTimings->addSample(mStage, mTimer.nsecsElapsed() / 1000.0);
+    }
+
+private:
+    FrameTimings *mTimings;
+    int mStage;
+    QElapsedTimer mTimer;
+};
+
+#define PLOT_TIMING_CAT2(a, b) a##b
+#define PLOT_TIMING_CAT(a, b) PLOT_TIMING_CAT2(a, b)
+
+#ifndef QGRAPHICSPLOT_NO_TIMINGS
+    #define PLOT_TIMING_SCOPE(timings, stage) FrameTimingScope PLOT_TIMING_CAT(_frameTimingScope, __LINE__)(timings, stage)
+#else
+    /* sizeof does not evaluate timings, but keeps the variables holding it used */
+    #define PLOT_TIMING_SCOPE(timings, stage) do { (void) sizeof(timings); (void) sizeof(stage); }while(0)
+#endif
+
+#endif // FRAMETIMINGS_H
@@ -1,6 +1,7 @@
 #include "graphicsscene.h"
 #include "graphicsscene_private.h"
 #include "colors.h"
+#include "frametimings.h"
 #include <QPainter>
 #include <QtDebug>
 #include <QGraphicsView>
@@ -12,6 +13,7 @@ GraphicsScene::GraphicsScene(QObject * parent ) : QGraphicsScene(parent)
 
 void GraphicsScene::drawForeground( QPainter * painter, const QRectF & )
 {
+    PLOT_TIMING_SCOPE(FrameTimings::forScene(this), FrameTimings::Overlay);
     if(d_ptr->zoomRect.isValid())
     {
         QPen p = painter->pen();
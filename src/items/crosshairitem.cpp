@@ -0,0 +1,263 @@
+#include "crosshairitem.h"
+#include "plotscenewidget.h"
+#include "scenecurve.h"
+#include "curveitem.h"
+#include "itempainterinterface.h"
+#include "scaleitem.h"
+#include "data.h"
+#include "frametimings.h"
+#include "colors.h"
+#include <QPainter>
+#include <QPixmap>
+#include <QFontMetrics>
+#include <QMouseEvent>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+#include <math.h>
+#include <qgraphicsplotmacros.h>
+
+class CrosshairItemPrivate
+{
+public:
+    PlotSceneWidget *plot;
+
+    QTimer *timer;
+
+    /* the last mouse position, in scene coordinates, not processed yet */
+    QPointF pendingPos;
+
+    /* the vertical line, in scene coordinates */
+    QLineF line;
+
+    QVector<QPointF> dots;
+
+    QVector<QColor> dotColors;
+
+    /* the text of the label pixmap */
+    QStringList lines;
+
+    QPixmap label;
+
+    QPointF labelPos;
+
+    QRectF boundingRect;
+
+    QColor lineColor, textColor, backgroundColor;
+
+    static const double dotRadius;
+};
+
+const double CrosshairItemPrivate::dotRadius = 3.0;
+
+CrosshairItem::CrosshairItem(PlotSceneWidget *plot) : QGraphicsObject(0), MouseEventListener()
+{
+    d_ptr = new CrosshairItemPrivate();
+    d_ptr->plot = plot;
+    d_ptr->lineColor = KDARKGRAY;
+    d_ptr->textColor = Qt::black;
+    d_ptr->backgroundColor = QColor(255, 255, 255, 200);
+    d_ptr->timer = new QTimer(this);
+    d_ptr->timer->setSingleShot(true);
+    d_ptr->timer->setInterval(1000 / 60);
+    connect(d_ptr->timer, SIGNAL(timeout()), this, SLOT(updateReadout()));
+    setZValue(102); /* above the legend and the performance HUD */
+    setObjectName("CrosshairItem");
+    setVisible(false);
+}
+
+CrosshairItem::~CrosshairItem()
+{
+    delete d_ptr;
+}
+
+QColor CrosshairItem::lineColor() const
+{
+    return d_ptr->lineColor;
+}
+
+QColor CrosshairItem::textColor() const
+{
+    return d_ptr->textColor;
+}
+
+QColor CrosshairItem::backgroundColor() const
+{
+    return d_ptr->backgroundColor;
+}
+
+int CrosshairItem::updateRate() const
+{
+    return qRound(1000.0 / qMax(1, d_ptr->timer->interval()));
+}
+
+QStringList CrosshairItem::readout() const
+{
+    return d_ptr->lines;
+}
+
+void CrosshairItem::setLineColor(const QColor& c)
+{
+    d_ptr->lineColor = c;
+    update();
+}
+
+void CrosshairItem::setTextColor(const QColor& c)
+{
+    d_ptr->textColor = c;
+    /* render the label again at the next update */
+    d_ptr->lines.clear();
+}
+
+void CrosshairItem::setBackgroundColor(const QColor& c)
+{
+    d_ptr->backgroundColor = c;
+    d_ptr->lines.clear();
+}
+
+void CrosshairItem::setUpdateRate(int hz)
+{
+    if(hz > 0 && hz <= 1000)
+        d_ptr->timer->setInterval(1000 / hz);
+    else
+        perr("CrosshairItem::setUpdateRate: rate %d out of range [1, 1000]", hz);
+}
+
+/* mouse moves are only recorded: the readout is updated by the timer, so that
+ * bursts of move events cost one update per period
+ */
+void CrosshairItem::mouseMoveEvent(PlotSceneWidget *plot, QMouseEvent *e)
+{
+    d_ptr->plot = plot;
+    d_ptr->pendingPos = plot->mapToScene(e->pos());
+    if(!d_ptr->timer->isActive())
+        d_ptr->timer->start();
+}
+
+void CrosshairItem::mHide()
+{
+    if(isVisible())
+    {
+        QRectF r = sceneBoundingRect();
+        setVisible(false);
+        d_ptr->plot->requestRefresh(r);
+    }
+}
+
+void CrosshairItem::updateReadout()
+{
+    PlotSceneWidget *plot = d_ptr->plot;
+    const QPointF pos = d_ptr->pendingPos;
+    ScaleItem *xScale = plot->xScaleItem();
+    if(!xScale)
+        return;
+    QRectF canvas = xScale->canvasRect();
+    if(!canvas.contains(pos))
+    {
+        mHide();
+        return;
+    }
+
+    QStringList lines;
+    d_ptr->dots.resize(0);
+    d_ptr->dotColors.resize(0);
+    bool xLabelSet = false;
+    foreach(SceneCurve *c, plot->getCurves())
+    {
+        if(!c->curveItem() || !c->curveItem()->isVisible())
+            continue;
+        double x = c->xValue(pos.x()), y;
+        if(!xLabelSet)
+        {
+            lines << c->getXAxis()->label(x);
+            xLabelSet = true;
+        }
+        if(!c->data()->interpolateY(x, &y) || isnan(y))
+            continue;
+        QString name = c->property("alias").toString();
+        if(name.isEmpty())
+            name = c->name();
+        lines << QString("%1: %2").arg(name).arg(c->getYAxis()->label(y));
+        d_ptr->dots << c->scenePos(x, y);
+        QList<ItemPainterInterface *> painters = c->curveItem()->itemPainters();
+        d_ptr->dotColors << (painters.isEmpty() ? d_ptr->lineColor : painters.first()->pen().color());
+    }
+
+    /* the text layout is cached: render only if the text changed */
+    if(lines != d_ptr->lines)
+        mRenderLabel(lines);
+
+    d_ptr->line = QLineF(pos.x(), canvas.top(), pos.x(), canvas.bottom());
+    /* the label follows the cursor on its right, or on its left near the right edge */
+    double lx = pos.x() + 8;
+    if(lx + d_ptr->label.width() > canvas.right())
+        lx = pos.x() - 8 - d_ptr->label.width();
+    d_ptr->labelPos = QPointF(lx, canvas.top() + 4);
+
+    QRectF br(pos.x() - 1, canvas.top(), 2, canvas.height());
+    br |= QRectF(d_ptr->labelPos, d_ptr->label.size());
+    const double r = CrosshairItemPrivate::dotRadius + 1;
+    foreach(QPointF p, d_ptr->dots)
+        br |= QRectF(p.x() - r, p.y() - r, 2 * r, 2 * r);
+
+    /* invalidates the old and the new region only */
+    QRectF oldRect = isVisible() ? sceneBoundingRect() : QRectF();
+    prepareGeometryChange();
+    d_ptr->boundingRect = br;
+    setVisible(true);
+    update();
+    /* needed when manualSceneUpdate is enabled */
+    plot->requestRefresh(oldRect | sceneBoundingRect());
+}
+
+void CrosshairItem::mRenderLabel(const QStringList &lines)
+{
+    d_ptr->lines = lines;
+    if(lines.isEmpty())
+    {
+        d_ptr->label = QPixmap();
+        return;
+    }
+    const int margin = 3;
+    QFont f = d_ptr->plot->font();
+    QFontMetrics fm(f);
+    int w = 0;
+    foreach(QString l, lines)
+        w = qMax(w, fm.width(l));
+    QSize size(w + 2 * margin, lines.size() * fm.height() + 2 * margin);
+    if(size != d_ptr->label.size())
+        d_ptr->label = QPixmap(size);
+    d_ptr->label.fill(d_ptr->backgroundColor);
+
+    QPainter p(&d_ptr->label);
+    p.setFont(f);
+    p.setPen(d_ptr->textColor);
+    int y = margin;
+    foreach(QString l, lines)
+    {
+        p.drawText(QRect(margin, y, w, fm.height()), Qt::AlignLeft|Qt::AlignVCenter, l);
+        y += fm.height();
+    }
+    p.end();
+}
+
+void CrosshairItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
+{
+    PLOT_TIMING_SCOPE(FrameTimings::forScene(scene()), FrameTimings::Overlay);
+    painter->setPen(d_ptr->lineColor);
+    painter->drawLine(d_ptr->line);
+    const double r = CrosshairItemPrivate::dotRadius;
+    for(int i = 0; i < d_ptr->dots.size(); i++)
+    {
+        painter->setPen(d_ptr->lineColor);
+        painter->setBrush(d_ptr->dotColors.at(i));
+        painter->drawEllipse(d_ptr->dots.at(i), r, r);
+    }
+    if(!d_ptr->label.isNull())
+        painter->drawPixmap(d_ptr->labelPos, d_ptr->label);
+}
+
+QRectF CrosshairItem::boundingRect() const
+{
+    return d_ptr->boundingRect;
+}
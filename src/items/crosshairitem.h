@@ -0,0 +1,99 @@
+#ifndef CROSSHAIRITEM_H
+#define CROSSHAIRITEM_H
+
+#include <QGraphicsObject>
+#include <mouseeventlistener.h>
+
+class PlotSceneWidget;
+class CrosshairItemPrivate;
+
+/** \brief A tracking cursor that follows the mouse and shows the y value of each
+ *         curve at the cursor x.
+ *
+ * The CrosshairItem is a companion of MarkerItem: while the MarkerItem marks the
+ * point closest to a click, the crosshair follows mouse moves. It draws a vertical
+ * line at the cursor x across the canvas, a dot on each curve and a box with the x
+ * value and the y value of every visible curve, linearly interpolated at x.
+ *
+ * \par Cost
+ * \li mouse moves are coalesced: the readout is updated at most updateRate times per
+ *     second (default 60);
+ * \li the y values are found with a binary search on the x data (Data::interpolateY),
+ *     O(log n) per curve. Curves whose x data is not ordered (see
+ *     SceneCurve::setXDataIsOrdered) are not listed;
+ * \li the text box is rendered into a cached pixmap only when its text changes;
+ * \li the item only updates its own region (the line, the dots and the text box).
+ *     The curves below are not invalidated: with CurveItem::cacheEnabled they are
+ *     repainted from their layers.
+ *
+ * The crosshair hides itself when the mouse leaves the canvas.
+ *
+ * \par Example
+ * \code
+ *   CrosshairItem* crosshair = new CrosshairItem(myPlotSceneWidget);
+ *   myPlotSceneWidget->installMouseEventListener(crosshair);
+ *   myPlotSceneWidget->scene()->addItem(crosshair);
+ * \endcode
+ *
+ * If the <em>alias</em> Qt property is set on a scene curve, it is shown instead of
+ * the curve name, as in MarkerItem.
+ */
+class CrosshairItem : public QGraphicsObject, public MouseEventListener
+{
+    Q_OBJECT
+
+    Q_PROPERTY(QColor lineColor READ lineColor WRITE setLineColor)
+    Q_PROPERTY(QColor textColor READ textColor WRITE setTextColor)
+    Q_PROPERTY(QColor backgroundColor READ backgroundColor WRITE setBackgroundColor)
+    Q_PROPERTY(int updateRate READ updateRate WRITE setUpdateRate)
+
+public:
+    enum { Type = UserType + 202 };
+
+    explicit CrosshairItem(PlotSceneWidget *plot);
+
+    virtual ~CrosshairItem();
+
+    virtual void mouseMoveEvent(PlotSceneWidget *plot, QMouseEvent *e);
+
+    virtual void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget);
+
+    virtual QRectF boundingRect() const;
+
+    int type() const { return Type; }
+
+    QColor lineColor() const;
+
+    QColor textColor() const;
+
+    QColor backgroundColor() const;
+
+    /** \brief the maximum number of readout updates per second
+     */
+    int updateRate() const;
+
+    /** \brief the lines of the text box: the x value first, then one line per curve
+     */
+    QStringList readout() const;
+
+public slots:
+    void setLineColor(const QColor& c);
+
+    void setTextColor(const QColor& c);
+
+    void setBackgroundColor(const QColor& c);
+
+    void setUpdateRate(int hz);
+
+private slots:
+    void updateReadout();
+
+private:
+    CrosshairItemPrivate *d_ptr;
+
+    void mRenderLabel(const QStringList& lines);
+
+    void mHide();
+};
+
+#endif // CROSSHAIRITEM_H
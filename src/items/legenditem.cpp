@@ -1,6 +1,7 @@
 #include "legenditem.h"
 #include "scenecurve.h"
 #include "curveitem.h"
+#include "frametimings.h"
 #include "../curve/painters/linepainter.h"
 #include "../curve/painters/dotspainter.h"
 #include "../curve/painters/histogrampainter.h"
@@ -77,6 +78,7 @@ LegendItem::LegendItem(QGraphicsScene *) :
 
 void LegendItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *)
 {
+    PLOT_TIMING_SCOPE(FrameTimings::forScene(scene()), FrameTimings::Legend);
     int visibleCurvesCount = 0;
     const double margin = 5.0;
     const double hmargin = 2;
@@ -1,6 +1,7 @@
 #include "markeritem.h"
 #include "plotscenewidget.h"
 #include "markeritemprivate.h"
+#include "frametimings.h"
 #include "qgraphicsplotmacros.h"
 #include "colors.h"
 #include <math.h>
@@ -143,8 +144,10 @@ void MarkerItem::mouseReleaseEvent(PlotSceneWidget* plot, QMouseEvent* e)
 {
     if(e->button() == Qt::MidButton)
     {
+        /* the marker only covers its own region */
+        QRectF r = sceneBoundingRect();
         setVisible(false);
-        plot->scene()->update();
+        plot->requestRefresh(r);
     }
 }
 
@@ -152,8 +155,10 @@ void MarkerItem::mouseDoubleClickEvent(PlotSceneWidget* plot, QMouseEvent* e)
 {
     if(e->button() == Qt::LeftButton)
     {
+        /* the marker only covers its own region */
+        QRectF r = sceneBoundingRect();
         setVisible(false);
-        plot->scene()->update();
+        plot->requestRefresh(r);
     }
 }
 
@@ -190,15 +195,20 @@ void MarkerItem::mouseClickEvent(PlotSceneWidget *plot, const QPointF &pos)
     /* reset bounding rect so that the update that follows works even in the case
      * described in the comment above
      */
+    QRectF oldRect = sceneBoundingRect();
+    prepareGeometryChange();
     d_ptr->boundingRect = QRectF(newTopLeft, newBotRight);
 //    qDebug() << __FUNCTION__ << d_ptr->boundingRect;
 
-    plot->scene()->update();
+    /* update the old and the new marker area only: the curves below are not invalidated */
+    update();
+    plot->requestRefresh(oldRect | sceneBoundingRect());
     setZValue(plot->getCurves().size() + 1);
 }
 
 void MarkerItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *w)
 {
+    PLOT_TIMING_SCOPE(FrameTimings::forScene(scene()), FrameTimings::Overlay);
     QGraphicsView *view = NULL;
     if(scene()->views().size() > 0)
         view = scene()->views().first();
@@ -0,0 +1,229 @@
+#include "performancehuditem.h"
+#include "plotscenewidget.h"
+#include "scenecurve.h"
+#include "curveitem.h"
+#include "data.h"
+#include "scaleitem.h"
+#include <QPainter>
+#include <QPixmap>
+#include <QFontMetrics>
+#include <QStringList>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QtDebug>
+#include <QtAlgorithms>
+#include <qgraphicsplotmacros.h>
+
+class PerformanceHudItemPrivate
+{
+public:
+    PlotSceneWidget *plot;
+
+    QTimer *timer;
+
+    /* time elapsed since the previous sample */
+    QElapsedTimer sampleTimer;
+
+    /* counters at the previous sample */
+    unsigned long lastPaintCount, lastIngestedCount;
+
+    double lastPaintTime;
+
+    double fps, frameTime, ingestRate;
+
+    bool fillBackground;
+
+    QPixmap cache;
+
+    static QString formatBytes(unsigned long bytes);
+};
+
+QString PerformanceHudItemPrivate::formatBytes(unsigned long bytes)
+{
+    if(bytes < 1024)
+        return QString("%1B").arg(bytes);
+    else if(bytes < 1024 * 1024)
+        return QString("%1KB").arg(bytes / 1024.0, 0, 'f', 1);
+    return QString("%1MB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 1);
+}
+
+PerformanceHudItem::PerformanceHudItem(PlotSceneWidget *plot) :
+    QGraphicsObject(0)
+{
+    d_ptr = new PerformanceHudItemPrivate();
+    d_ptr->plot = plot;
+    d_ptr->lastPaintCount = d_ptr->lastIngestedCount = 0;
+    d_ptr->lastPaintTime = 0.0;
+    d_ptr->fps = d_ptr->frameTime = d_ptr->ingestRate = 0.0;
+    d_ptr->fillBackground = true;
+    d_ptr->timer = new QTimer(this);
+    d_ptr->timer->setInterval(500);
+    connect(d_ptr->timer, SIGNAL(timeout()), this, SLOT(sample()));
+    setZValue(101); /* above the legend */
+    setObjectName("PlotSceneWidgetPerformanceHudItem");
+    /* items are created visible: no ItemVisibleHasChanged for that */
+    mStartSampling();
+}
+
+PerformanceHudItem::~PerformanceHudItem()
+{
+    delete d_ptr;
+}
+
+void PerformanceHudItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
+{
+    if(!d_ptr->cache.isNull())
+        painter->drawPixmap(0, 0, d_ptr->cache);
+}
+
+QRectF PerformanceHudItem::boundingRect() const
+{
+    return QRectF(0, 0, d_ptr->cache.width(), d_ptr->cache.height());
+}
+
+int PerformanceHudItem::refreshInterval() const
+{
+    return d_ptr->timer->interval();
+}
+
+bool PerformanceHudItem::fillBackground() const
+{
+    return d_ptr->fillBackground;
+}
+
+double PerformanceHudItem::fps() const
+{
+    return d_ptr->fps;
+}
+
+double PerformanceHudItem::frameTime() const
+{
+    return d_ptr->frameTime;
+}
+
+double PerformanceHudItem::ingestRate() const
+{
+    return d_ptr->ingestRate;
+}
+
+void PerformanceHudItem::setRefreshInterval(int ms)
+{
+    if(ms >= 100)
+        d_ptr->timer->setInterval(ms);
+    else
+        perr("PerformanceHudItem::setRefreshInterval: interval %d too short (min 100ms)", ms);
+}
+
+void PerformanceHudItem::setFillBackground(bool fill)
+{
+    d_ptr->fillBackground = fill;
+    update();
+}
+
+QVariant PerformanceHudItem::itemChange(GraphicsItemChange change, const QVariant &value)
+{
+    if(change == ItemVisibleHasChanged)
+    {
+        if(value.toBool())
+            mStartSampling();
+        else
+            d_ptr->timer->stop();
+    }
+    return QGraphicsObject::itemChange(change, value);
+}
+
+void PerformanceHudItem::mStartSampling()
+{
+    /* the first sample only initializes the counters */
+    d_ptr->sampleTimer.invalidate();
+    sample();
+    d_ptr->timer->start();
+}
+
+void PerformanceHudItem::sample()
+{
+    PlotSceneWidget *plot = d_ptr->plot;
+    QList<SceneCurve *> curves = plot->getCurves();
+    unsigned long paintCount = plot->paintCount();
+    double paintTime = plot->paintTime();
+    unsigned long ingestedCount = 0;
+    foreach(SceneCurve *sc, curves)
+        ingestedCount += sc->data()->ingestedCount();
+
+    if(d_ptr->sampleTimer.isValid())
+    {
+        double secs = d_ptr->sampleTimer.nsecsElapsed() / 1e9;
+        unsigned long frames = paintCount - d_ptr->lastPaintCount;
+        if(secs > 0)
+        {
+            d_ptr->fps = frames / secs;
+            d_ptr->ingestRate = (ingestedCount - d_ptr->lastIngestedCount) / secs;
+        }
+        if(frames > 0)
+            d_ptr->frameTime = (paintTime - d_ptr->lastPaintTime) / frames;
+    }
+    d_ptr->sampleTimer.start();
+    d_ptr->lastPaintCount = paintCount;
+    d_ptr->lastPaintTime = paintTime;
+    d_ptr->lastIngestedCount = ingestedCount;
+
+    QStringList lines;
+    lines << QString("%1 fps  %2 ms/frame").arg(d_ptr->fps, 0, 'f', 1).arg(d_ptr->frameTime, 0, 'f', 2);
+    lines << QString("%1 points/s").arg(d_ptr->ingestRate, 0, 'f', 0);
+    foreach(SceneCurve *sc, curves)
+    {
+        int stored = sc->dataSize();
+        int drawn = 0;
+        if(sc->curveItem() && sc->curveItem()->isVisible() && stored > 0)
+        {
+            const Data *data = sc->data();
+            const int n = qMin(data->xData.size(), data->yData.size());
+            if(sc->xDataIsOrdered() && n > 0)
+            {
+                /* the points within the x range of the axis, with two binary searches */
+                const double *xd = data->xData.constData();
+                drawn = qUpperBound(xd, xd + n, sc->getXAxis()->upperBound()) -
+                        qLowerBound(xd, xd + n, sc->getXAxis()->lowerBound());
+            }
+            else /* the painters draw all the points */
+                drawn = stored;
+        }
+        lines << QString("%1: %2/%3 pts %4").arg(sc->name()).arg(drawn).arg(stored).
+                 arg(PerformanceHudItemPrivate::formatBytes(sc->memoryUsage()));
+    }
+    mRenderCache(lines);
+}
+
+void PerformanceHudItem::mRenderCache(const QStringList &lines)
+{
+    const int margin = 4;
+    QFont f = d_ptr->plot->font();
+    QFontMetrics fm(f);
+    int w = 0;
+    foreach(QString l, lines)
+        w = qMax(w, fm.width(l));
+    QSize size(w + 2 * margin, lines.size() * fm.height() + 2 * margin);
+
+    QRectF oldRect = sceneBoundingRect();
+    if(size != d_ptr->cache.size())
+    {
+        prepareGeometryChange();
+        d_ptr->cache = QPixmap(size);
+    }
+    d_ptr->cache.fill(d_ptr->fillBackground ? QColor(255, 255, 255, 200) : QColor(Qt::transparent));
+
+    QPainter p(&d_ptr->cache);
+    p.setFont(f);
+    p.setPen(Qt::black);
+    int y = margin;
+    foreach(QString l, lines)
+    {
+        p.drawText(QRect(margin, y, w, fm.height()), Qt::AlignLeft|Qt::AlignVCenter, l);
+        y += fm.height();
+    }
+    p.end();
+
+    update();
+    /* needed when manualSceneUpdate is enabled. Only the area of the hud changes */
+    d_ptr->plot->requestRefresh(oldRect | sceneBoundingRect());
+}
@@ -0,0 +1,88 @@
+#ifndef PERFORMANCEHUDITEM_H
+#define PERFORMANCEHUDITEM_H
+
+#include <QGraphicsObject>
+
+class PlotSceneWidget;
+class PerformanceHudItemPrivate;
+
+/** \brief An overlay that shows the rendering and data rates of a PlotSceneWidget.
+ *
+ * This class is created and managed by the PlotSceneWidget when the performanceHudVisible
+ * property is enabled. See PlotSceneWidget::setPerformanceHudVisible.
+ *
+ * The item shows
+ * \li the number of frames painted per second and the average frame time;
+ * \li the number of points received per second by all the curves;
+ * \li for each curve, the points within the x range of the axis versus the points
+ *     stored, and the memory allocated by the curve (see SceneCurve::memoryUsage).
+ *     The former is found with a binary search if the x data is ordered
+ *     (SceneCurve::xDataIsOrdered), otherwise all the stored points are counted.
+ *
+ * \par Cost
+ * The statistics are sampled by a timer every refreshInterval milliseconds (default
+ * 500) and the text is rendered into a cached pixmap. Paint events only draw the
+ * pixmap, so that the item does not weigh on the frames it measures.
+ *
+ * \par Accessing the PerformanceHudItem.
+ * Use PlotSceneWidget::performanceHudItem()
+ */
+class PerformanceHudItem : public QGraphicsObject
+{
+    Q_PROPERTY(int refreshInterval READ refreshInterval WRITE setRefreshInterval)
+    Q_PROPERTY(bool fillBackground READ fillBackground WRITE setFillBackground)
+
+    Q_OBJECT
+public:
+    explicit PerformanceHudItem(PlotSceneWidget *plot);
+
+    virtual ~PerformanceHudItem();
+
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget);
+
+    QRectF boundingRect() const;
+
+    int refreshInterval() const;
+
+    bool fillBackground() const;
+
+    /** \brief the frames per second measured in the last sampling period
+     */
+    double fps() const;
+
+    /** \brief the average time, in milliseconds, spent in a paint event during the
+     *         last sampling period
+     */
+    double frameTime() const;
+
+    /** \brief the number of points per second received by all the curves during the
+     *         last sampling period
+     */
+    double ingestRate() const;
+
+public slots:
+
+    /** \brief sets the sampling period of the statistics, in milliseconds
+     *
+     * @param ms the period. Values less than 100 are ignored.
+     */
+    void setRefreshInterval(int ms);
+
+    void setFillBackground(bool fill);
+
+protected:
+    /* the statistics are sampled only while the item is visible */
+    virtual QVariant itemChange(GraphicsItemChange change, const QVariant &value);
+
+private slots:
+    void sample();
+
+private:
+    PerformanceHudItemPrivate *d_ptr;
+
+    void mRenderCache(const QStringList &lines);
+
+    void mStartSampling();
+};
+
+#endif // PERFORMANCEHUDITEM_H
@@ -0,0 +1,298 @@
+#include "stripchartitem.h"
+#include "plotscenewidget.h"
+#include "scenecurve.h"
+#include "curveitem.h"
+#include "data.h"
+#include "itempainterinterface.h"
+#include "frametimings.h"
+#include "tracerecorder.h"
+
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QImage>
+#include <QTransform>
+#include <QHash>
+#include <QRegion>
+#include <QtDebug>
+#include <string.h>
+#include <math.h>
+#include <qgraphicsplotmacros.h>
+
+class StripChartItemPrivate
+{
+public:
+    PlotSceneWidget *plot;
+
+    bool valid;
+
+    QImage layer;
+
+    /* the device rect covered by the layer */
+    QRect layerDeviceRect;
+
+    QRectF layerCanvasRect;
+
+    QTransform layerTransform;
+
+    ScaleItem *layerXAxis;
+
+    /* x value at the left column of the layer and x axis extension */
+    double layerXlb, layerXext;
+
+    /* y axis, lower and upper bounds used to render the layer */
+    QHash<ScaleItem *, QPointF> layerYBounds;
+
+    /* curve, reset generation of its data at render time */
+    QHash<SceneCurve *, unsigned int> curveResetGenerations;
+
+    /* curve, eviction generation of its data at render time */
+    QHash<SceneCurve *, unsigned int> curveEvictionGenerations;
+
+    /* curve, last x value rendered */
+    QHash<SceneCurve *, double> lastRenderedX;
+
+    int fullRenderCount, scrollRenderCount;
+
+    void scrollLeft(int columns);
+
+    void clearColumns(QPainter *layerPainter, int fromColumn, int toColumn);
+};
+
+/* shift the layer content to the left by columns pixels. The rightmost columns are
+ * left untouched and must be cleared by the caller.
+ */
+void StripChartItemPrivate::scrollLeft(int columns)
+{
+    const int bytesPerPixel = layer.depth() / 8;
+    const int len = (layer.width() - columns) * bytesPerPixel;
+    for(int y = 0; y < layer.height(); y++)
+    {
+        uchar *line = layer.scanLine(y);
+        memmove(line, line + columns * bytesPerPixel, len);
+    }
+}
+
+/* clear the columns in [fromColumn, toColumn) */
+void StripChartItemPrivate::clearColumns(QPainter *layerPainter, int fromColumn, int toColumn)
+{
+    layerPainter->setCompositionMode(QPainter::CompositionMode_Source);
+    layerPainter->fillRect(QRect(fromColumn, 0, toColumn - fromColumn, layer.height()), Qt::transparent);
+    layerPainter->setCompositionMode(QPainter::CompositionMode_SourceOver);
+}
+
+StripChartItem::StripChartItem(PlotSceneWidget *plot) : QGraphicsObject(0)
+{
+    d_ptr = new StripChartItemPrivate();
+    d_ptr->plot = plot;
+    d_ptr->valid = false;
+    d_ptr->layerXAxis = NULL;
+    d_ptr->layerXlb = d_ptr->layerXext = 0.0;
+    d_ptr->fullRenderCount = d_ptr->scrollRenderCount = 0;
+    setObjectName("StripChartItem");
+}
+
+StripChartItem::~StripChartItem()
+{
+    delete d_ptr;
+}
+
+QRectF StripChartItem::boundingRect() const
+{
+    if(scene())
+        return scene()->sceneRect();
+    return QRectF();
+}
+
+int StripChartItem::fullRenderCount() const
+{
+    return d_ptr->fullRenderCount;
+}
+
+int StripChartItem::scrollRenderCount() const
+{
+    return d_ptr->scrollRenderCount;
+}
+
+unsigned long StripChartItem::memoryUsage() const
+{
+    return d_ptr->layer.bytesPerLine() * d_ptr->layer.height();
+}
+
+void StripChartItem::releaseLayer()
+{
+    d_ptr->layer = QImage();
+    d_ptr->valid = false;
+}
+
+void StripChartItem::invalidate()
+{
+    d_ptr->valid = false;
+    update();
+}
+
+void StripChartItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *)
+{
+    QList<SceneCurve *> curves;
+    foreach(SceneCurve *sc, d_ptr->plot->getCurves())
+        if(sc->curveItem() && sc->curveItem()->isVisible() && sc->dataSize() > 0)
+            curves << sc;
+
+    if(curves.isEmpty())
+    {
+        d_ptr->valid = false;
+        return;
+    }
+
+    ScaleItem *xAxis = curves.first()->getXAxis();
+    QRectF canvasRect = xAxis->canvasRect();
+    QTransform deviceTransform = painter->worldTransform();
+    QRect deviceRect = deviceTransform.mapRect(canvasRect).toAlignedRect();
+    double xlb = xAxis->lowerBound();
+    double xext = xAxis->upperBound() - xlb;
+    if(deviceRect.isEmpty() || xext <= 0.0 || canvasRect.width() <= 1)
+        return;
+
+    /* device pixels per x axis unit */
+    double pixelsPerUnit = deviceTransform.m11() * (canvasRect.width() - 1) / xext;
+
+    bool fullRender = !d_ptr->valid || d_ptr->layer.isNull() ||
+            d_ptr->layerCanvasRect != canvasRect ||
+            d_ptr->layerTransform != deviceTransform ||
+            d_ptr->layerXAxis != xAxis ||
+            !qFuzzyCompare(d_ptr->layerXext, xext) ||
+            d_ptr->curveResetGenerations.size() != curves.size();
+
+    for(int i = 0; i < curves.size() && !fullRender; i++)
+    {
+        SceneCurve *sc = curves.at(i);
+        ScaleItem *yAxis = sc->getYAxis();
+        fullRender = sc->getXAxis() != xAxis || !sc->xDataIsOrdered() ||
+                !d_ptr->curveResetGenerations.contains(sc) ||
+                d_ptr->curveResetGenerations.value(sc) != sc->data()->resetGeneration() ||
+                d_ptr->layerYBounds.value(yAxis) != QPointF(yAxis->lowerBound(), yAxis->upperBound());
+    }
+
+    int shift = 0;
+    if(!fullRender)
+    {
+        double dx = (xlb - d_ptr->layerXlb) * pixelsPerUnit;
+        if(dx < 0 || dx >= d_ptr->layer.width())
+            fullRender = true;
+        else
+            shift = (int) floor(dx);
+    }
+
+    QPainter layerPainter;
+    /* columns [0, leftColumns) and [fromColumn, width) are drawn again */
+    int fromColumn = 0, leftColumns = 0;
+    if(fullRender)
+    {
+        if(d_ptr->layer.size() != deviceRect.size())
+            d_ptr->layer = QImage(deviceRect.size(), QImage::Format_ARGB32_Premultiplied);
+        d_ptr->layer.fill(Qt::transparent);
+        d_ptr->layerXlb = xlb;
+        d_ptr->layerXext = xext;
+        d_ptr->layerXAxis = xAxis;
+        d_ptr->layerCanvasRect = canvasRect;
+        d_ptr->layerTransform = deviceTransform;
+        d_ptr->layerDeviceRect = deviceRect;
+        d_ptr->layerYBounds.clear();
+        d_ptr->curveResetGenerations.clear();
+        d_ptr->curveEvictionGenerations.clear();
+        d_ptr->lastRenderedX.clear();
+        foreach(SceneCurve *sc, curves)
+        {
+            ScaleItem *yAxis = sc->getYAxis();
+            d_ptr->layerYBounds.insert(yAxis, QPointF(yAxis->lowerBound(), yAxis->upperBound()));
+        }
+        layerPainter.begin(&d_ptr->layer);
+        d_ptr->fullRenderCount++;
+    }
+    else
+    {
+        if(shift > 0)
+        {
+            d_ptr->scrollLeft(shift);
+            /* keep the layer anchored to a whole pixel: the remainder is applied at blit time */
+            d_ptr->layerXlb += shift / pixelsPerUnit;
+        }
+        fromColumn = d_ptr->layer.width() - shift;
+        /* the segments joining the last rendered samples to the new ones must be drawn too */
+        double margin = 2.0;
+        foreach(SceneCurve *sc, curves)
+        {
+            if(sc->curveItem()->itemPainter())
+                margin = qMax(margin, sc->curveItem()->itemPainter()->elementSize().width() + 2.0);
+            if(d_ptr->lastRenderedX.contains(sc))
+            {
+                double col = (d_ptr->lastRenderedX.value(sc) - d_ptr->layerXlb) * pixelsPerUnit;
+                if(col < fromColumn)
+                    fromColumn = qMax(0, (int) floor(col));
+            }
+            else
+                fromColumn = 0;
+        }
+        fromColumn = qMax(0, fromColumn - (int) ceil(margin));
+        /* the points removed by the buffer size leave their pixels on the left of the
+         * new first point: no curve has data there, apart from around the first points
+         */
+        foreach(SceneCurve *sc, curves)
+        {
+            if(d_ptr->curveEvictionGenerations.value(sc) != sc->data()->evictionGeneration())
+            {
+                double col = (sc->data()->xData.first() - d_ptr->layerXlb) * pixelsPerUnit;
+                leftColumns = qMax(leftColumns, qMin(d_ptr->layer.width(), (int) ceil(col + margin)));
+            }
+        }
+        if(leftColumns >= fromColumn)
+            fromColumn = leftColumns = 0;
+        layerPainter.begin(&d_ptr->layer);
+        d_ptr->clearColumns(&layerPainter, 0, leftColumns);
+        d_ptr->clearColumns(&layerPainter, fromColumn, d_ptr->layer.width());
+        d_ptr->scrollRenderCount++;
+    }
+
+    /* fraction of pixel between the layer anchor and the actual x lower bound */
+    double frac = (xlb - d_ptr->layerXlb) * pixelsPerUnit;
+
+    if(fromColumn < d_ptr->layer.width() || leftColumns > 0)
+    {
+        layerPainter.setRenderHints(painter->renderHints());
+        QRegion clip(fromColumn, 0, d_ptr->layer.width() - fromColumn, d_ptr->layer.height());
+        if(leftColumns > 0)
+            clip += QRegion(0, 0, leftColumns, d_ptr->layer.height());
+        layerPainter.setClipRegion(clip);
+        layerPainter.setWorldTransform(deviceTransform *
+                                       QTransform::fromTranslate(-deviceRect.x() + frac, -deviceRect.y()));
+        QStyleOptionGraphicsItem layerOption(*option);
+        layerOption.exposedRect = layerPainter.clipBoundingRect();
+        FrameTimings *timings = d_ptr->plot->frameTimings();
+        foreach(SceneCurve *sc, curves)
+        {
+            /* the projection is timed apart from the painters */
+            sc->points();
+            foreach(ItemPainterInterface* ipi, sc->curveItem()->itemPainters())
+            {
+                PLOT_TIMING_SCOPE(timings, FrameTimings::painterStage(ipi->type()));
+                PLOT_TRACE_SCOPE(TraceRecorder::painterEventName(ipi->type()));
+                ipi->draw(sc, d_ptr->plot, &layerPainter, &layerOption, 0);
+            }
+        }
+    }
+    layerPainter.end();
+
+    foreach(SceneCurve *sc, curves)
+    {
+        d_ptr->curveResetGenerations.insert(sc, sc->data()->resetGeneration());
+        d_ptr->curveEvictionGenerations.insert(sc, sc->data()->evictionGeneration());
+        d_ptr->lastRenderedX.insert(sc, sc->data()->xData.last());
+    }
+    d_ptr->valid = true;
+
+    /* blit */
+    painter->setClipRect(option->exposedRect.toRect());
+    painter->save();
+    painter->setWorldTransform(QTransform());
+    painter->drawImage(QPointF(d_ptr->layerDeviceRect.x() - frac, d_ptr->layerDeviceRect.y()), d_ptr->layer);
+    painter->restore();
+}
@@ -0,0 +1,76 @@
+#ifndef STRIPCHARTITEM_H
+#define STRIPCHARTITEM_H
+
+#include <QGraphicsObject>
+
+class PlotSceneWidget;
+class StripChartItemPrivate;
+
+/** \brief An item that renders all the curves of a PlotSceneWidget into a scrolling
+ *         offscreen image.
+ *
+ * This class is created and managed by the PlotSceneWidget when the scrollRenderMode
+ * property is enabled. See PlotSceneWidget::setScrollRenderMode.
+ *
+ * In a strip chart (e.g. a time trend with a sliding x window) each refresh moves
+ * the content to the left by a few pixels and adds a few new samples on the right.
+ * The StripChartItem keeps the rendered curves in a QImage: when the x axis bounds
+ * slide, the image is shifted by the corresponding number of pixels and only the
+ * newly exposed columns, together with the columns touched by the samples appended
+ * since the last paint, are rasterized again by the item painters installed on each
+ * CurveItem. When the buffer size of a curve removes its oldest points, the columns
+ * on the left of its new first point are cleared and rasterized again as well.
+ * The CurveItems themselves do not paint while the scroll render mode is enabled.
+ *
+ * Axes and grid are drawn by the ScaleItem objects, that are separate items
+ * and are not part of the scrolling image.
+ *
+ * The image is rendered again from scratch when
+ * \li the canvas rect or the view transform change;
+ * \li the x axis extension or any y axis bounds change;
+ * \li the x lower bound moves backwards or by more than the canvas width;
+ * \li a curve is added, removed, shown or hidden, or its data is replaced (setData);
+ * \li the curves do not share the same x axis or their x data is not ordered.
+ */
+class StripChartItem : public QGraphicsObject
+{
+    Q_OBJECT
+public:
+    explicit StripChartItem(PlotSceneWidget *plot);
+
+    virtual ~StripChartItem();
+
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget);
+
+    QRectF boundingRect() const;
+
+    /** \brief returns the number of times the image has been rendered from scratch
+     */
+    int fullRenderCount() const;
+
+    /** \brief returns the number of times the image has been scrolled and only the new
+     *         columns have been rendered
+     */
+    int scrollRenderCount() const;
+
+    /** \brief the memory, in bytes, used by the scrolling image
+     */
+    unsigned long memoryUsage() const;
+
+    /** \brief frees the scrolling image. It is rendered from scratch at the next paint.
+     */
+    void releaseLayer();
+
+public slots:
+
+    /** \brief forces a full render of the image at the next paint event
+     */
+    void invalidate();
+
+private:
+    StripChartItemPrivate *d_ptr;
+
+    void mRender(QPainter *layerPainter, int fromColumn);
+};
+
+#endif // STRIPCHARTITEM_H
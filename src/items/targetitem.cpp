@@ -246,6 +246,10 @@ QVariant TargetItem::itemChange(GraphicsItemChange change, const QVariant &value
         QPointF newPos = value.toPointF();
         if(d_ptr->itemMoveListener)
             d_ptr->itemMoveListener->itemMoved(newPos);
+        /* repaint only the area left and the area reached by the target */
+        QRectF oldRect = sceneBoundingRect();
+        if(d_ptr->plot)
+            d_ptr->plot->requestRefresh(oldRect | oldRect.translated(newPos - pos()));
     }
     return QGraphicsItem::itemChange(change, value);
 }
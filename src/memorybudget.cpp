@@ -0,0 +1,207 @@
+#include "memorybudget.h"
+#include "plotscenewidget.h"
+#include "curve/scenecurve.h"
+#include "curve/datapool.h"
+#include <QApplication>
+#include <QTimer>
+#include <QtAlgorithms>
+#include <QtDebug>
+#include "qgraphicsplotmacros.h"
+
+static MemoryBudget *budgetInstance = NULL;
+
+/* a curve with the memory held by its data */
+struct CurveUsage
+{
+    SceneCurve *curve;
+    unsigned long bytes;
+};
+
+static bool curveUsageGreaterThan(const CurveUsage &c1, const CurveUsage &c2)
+{
+    return c1.bytes > c2.bytes;
+}
+
+class MemoryBudgetPrivate
+{
+public:
+    qint64 budget;
+
+    int compactionFactor, minimumBufferSize;
+
+    QTimer *timer;
+};
+
+MemoryBudget *MemoryBudget::instance()
+{
+    if(!budgetInstance)
+        budgetInstance = new MemoryBudget(QCoreApplication::instance());
+    return budgetInstance;
+}
+
+MemoryBudget::MemoryBudget(QObject *parent) : QObject(parent)
+{
+    d_ptr = new MemoryBudgetPrivate();
+    d_ptr->budget = 0;
+    d_ptr->compactionFactor = 8;
+    d_ptr->minimumBufferSize = 1024;
+    d_ptr->timer = new QTimer(this);
+    d_ptr->timer->setInterval(1000);
+    connect(d_ptr->timer, SIGNAL(timeout()), this, SLOT(enforce()));
+    setObjectName("memoryBudget");
+}
+
+MemoryBudget::~MemoryBudget()
+{
+    budgetInstance = NULL;
+    delete d_ptr;
+}
+
+qint64 MemoryBudget::budget() const
+{
+    return d_ptr->budget;
+}
+
+int MemoryBudget::checkInterval() const
+{
+    return d_ptr->timer->interval();
+}
+
+int MemoryBudget::compactionFactor() const
+{
+    return d_ptr->compactionFactor;
+}
+
+int MemoryBudget::minimumBufferSize() const
+{
+    return d_ptr->minimumBufferSize;
+}
+
+QList<PlotSceneWidget *> MemoryBudget::plots() const
+{
+    QList<PlotSceneWidget *> plots;
+    foreach(QWidget *w, QApplication::allWidgets())
+    {
+        PlotSceneWidget *plot = qobject_cast<PlotSceneWidget *>(w);
+        if(plot)
+            plots << plot;
+    }
+    return plots;
+}
+
+qint64 MemoryBudget::usage() const
+{
+    qint64 bytes = DataPool::instance()->pooledBytes();
+    foreach(PlotSceneWidget *plot, plots())
+        bytes += plot->memoryUsage();
+    return bytes;
+}
+
+void MemoryBudget::setBudget(qint64 bytes)
+{
+    d_ptr->budget = qMax(bytes, (qint64) 0);
+    if(d_ptr->budget > 0)
+        d_ptr->timer->start();
+    else
+        d_ptr->timer->stop();
+}
+
+void MemoryBudget::setCheckInterval(int ms)
+{
+    if(ms > 0)
+        d_ptr->timer->setInterval(ms);
+    else
+        perr("MemoryBudget::setCheckInterval: interval must be greater than 0 (%d)", ms);
+}
+
+void MemoryBudget::setCompactionFactor(int factor)
+{
+    if(factor >= 3)
+        d_ptr->compactionFactor = factor;
+    else
+        perr("MemoryBudget::setCompactionFactor: factor %d does not save memory (min 3)", factor);
+}
+
+void MemoryBudget::setMinimumBufferSize(int size)
+{
+    d_ptr->minimumBufferSize = qMax(size, 1);
+}
+
+QList<SceneCurve *> MemoryBudget::mReducibleCurves() const
+{
+    QList<CurveUsage> usages;
+    foreach(PlotSceneWidget *plot, plots())
+    {
+        foreach(SceneCurve *c, plot->getCurves())
+        {
+            if(c->data()->scalarMode)
+            {
+                CurveUsage cu;
+                cu.curve = c;
+                cu.bytes = c->dataMemoryUsage();
+                usages << cu;
+            }
+        }
+    }
+    qSort(usages.begin(), usages.end(), curveUsageGreaterThan);
+    QList<SceneCurve *> curves;
+    foreach(CurveUsage cu, usages)
+        curves << cu.curve;
+    return curves;
+}
+
+qint64 MemoryBudget::enforce()
+{
+    qint64 used = usage();
+    if(d_ptr->budget <= 0 || used <= d_ptr->budget)
+        return used;
+
+    emit budgetExceeded(used, d_ptr->budget);
+
+    /* 1. caches: nothing is lost */
+    DataPool *pool = DataPool::instance();
+    qint64 freed = pool->pooledBytes();
+    pool->trim();
+    foreach(PlotSceneWidget *plot, plots())
+        freed += plot->releaseCaches();
+    if(freed > 0)
+        emit cachesDropped(freed);
+    used = usage();
+
+    /* 2. compact the history of the largest curves */
+    QList<SceneCurve *> curves = mReducibleCurves();
+    for(int i = 0; i < curves.size() && used > d_ptr->budget; i++)
+    {
+        SceneCurve *c = curves.at(i);
+        if(c->dataSize() < 2 * d_ptr->compactionFactor || c->dataSize() <= d_ptr->minimumBufferSize)
+            continue;
+        qint64 f = c->compactHistory(0.5, d_ptr->compactionFactor);
+        if(f > 0)
+        {
+            used -= f;
+            emit historyCompacted(c, f);
+        }
+    }
+
+    /* 3. halve the buffers of the largest curves until the budget is met */
+    bool trimmed = true;
+    while(used > d_ptr->budget && trimmed)
+    {
+        trimmed = false;
+        for(int i = 0; i < curves.size() && used > d_ptr->budget; i++)
+        {
+            SceneCurve *c = curves.at(i);
+            int size = qMax(c->dataSize() / 2, d_ptr->minimumBufferSize);
+            if(size >= c->dataSize())
+                continue;
+            qint64 f = c->trimBuffer(size);
+            trimmed = true;
+            used -= f;
+            emit bufferTrimmed(c, size, f);
+        }
+    }
+    if(used > d_ptr->budget)
+        pinfo("MemoryBudget::enforce: usage %lld bytes still exceeds the budget (%lld bytes)",
+              (long long) used, (long long) d_ptr->budget);
+    return usage();
+}
@@ -0,0 +1,122 @@
+#ifndef MEMORYBUDGET_H
+#define MEMORYBUDGET_H
+
+#include <QObject>
+#include <QList>
+
+class PlotSceneWidget;
+class SceneCurve;
+class MemoryBudgetPrivate;
+
+/** \brief A process wide cap on the memory used by the plots.
+ *
+ * The memory of each plot is accounted by PlotSceneWidget::memoryUsage, that sums
+ * the SceneCurve::memoryUsage of the curves (data, projected points, raster layer).
+ * The usage of the MemoryBudget is the sum over all the PlotSceneWidgets of the
+ * application plus the buffers kept by the DataPool.
+ *
+ * The budget is disabled by default. Once a budget is set, the usage is checked every
+ * checkInterval milliseconds (or when enforce is called). When the budget is exceeded,
+ * budgetExceeded is emitted and the following actions are taken in order, each one
+ * only if the previous were not enough:
+ *
+ * \li the DataPool is trimmed and the caches of all the plots are dropped
+ *     (PlotSceneWidget::releaseCaches). Nothing is lost: the caches are rebuilt
+ *     at the next paint. cachesDropped is emitted;
+ * \li the history of the largest curves is compacted: the oldest half of their
+ *     data is replaced by its min/max envelope (SceneCurve::compactHistory).
+ *     historyCompacted is emitted for each curve;
+ * \li the buffers of the largest curves are halved (SceneCurve::trimBuffer), the
+ *     oldest points being removed, down to minimumBufferSize. bufferTrimmed is emitted
+ *     for each curve.
+ *
+ * Only curves fed with addPoint or addPoints are compacted or trimmed: the data of
+ * curves set with setData belongs to the application.
+ *
+ * \par Example
+ * \code
+ * MemoryBudget *budget = MemoryBudget::instance();
+ * connect(budget, SIGNAL(bufferTrimmed(SceneCurve*,int,qint64)), this, SLOT(warnUser(SceneCurve*,int)));
+ * budget->setBudget(512 * 1024 * 1024);
+ * \endcode
+ */
+class MemoryBudget : public QObject
+{
+    Q_PROPERTY(qint64 budget READ budget WRITE setBudget)
+    Q_PROPERTY(int checkInterval READ checkInterval WRITE setCheckInterval)
+    Q_PROPERTY(int compactionFactor READ compactionFactor WRITE setCompactionFactor)
+    Q_PROPERTY(int minimumBufferSize READ minimumBufferSize WRITE setMinimumBufferSize)
+
+    Q_OBJECT
+public:
+    /** \brief returns the unique instance of the budget, creating it if necessary.
+     */
+    static MemoryBudget *instance();
+
+    virtual ~MemoryBudget();
+
+    /** \brief the budget, in bytes. 0 means no budget (the default).
+     */
+    qint64 budget() const;
+
+    int checkInterval() const;
+
+    /** \brief each group of compactionFactor points is replaced by its minimum and
+     *         maximum when history is compacted. Default: 8
+     */
+    int compactionFactor() const;
+
+    /** \brief buffers are never trimmed below this number of points. Default: 1024
+     */
+    int minimumBufferSize() const;
+
+    /** \brief the memory currently used by all the plots of the application, in bytes
+     */
+    qint64 usage() const;
+
+    /** \brief all the PlotSceneWidgets of the application
+     */
+    QList<PlotSceneWidget *> plots() const;
+
+public slots:
+
+    void setBudget(qint64 bytes);
+
+    void setCheckInterval(int ms);
+
+    void setCompactionFactor(int factor);
+
+    void setMinimumBufferSize(int size);
+
+    /** \brief checks the usage against the budget and, if needed, frees memory.
+     *
+     * @return the usage after the actions taken.
+     */
+    qint64 enforce();
+
+signals:
+
+    void budgetExceeded(qint64 usage, qint64 budget);
+
+    /** \brief the caches of the plots and the DataPool have been dropped
+     */
+    void cachesDropped(qint64 freedBytes);
+
+    /** \brief the oldest data of curve has been compacted into its min/max envelope
+     */
+    void historyCompacted(SceneCurve *curve, qint64 freedBytes);
+
+    /** \brief the buffer of curve has been lowered to bufferSize
+     */
+    void bufferTrimmed(SceneCurve *curve, int bufferSize, qint64 freedBytes);
+
+private:
+    explicit MemoryBudget(QObject *parent);
+
+    /* the curves that can be compacted or trimmed, the largest first */
+    QList<SceneCurve *> mReducibleCurves() const;
+
+    MemoryBudgetPrivate *d_ptr;
+};
+
+#endif // MEMORYBUDGET_H
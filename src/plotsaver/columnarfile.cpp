@@ -0,0 +1,332 @@
+#include "columnarfile.h"
+#include "scenecurve.h"
+#include "curve/data.h"
+#include "qgraphicsplotmacros.h"
+#include <QFile>
+#include <QByteArray>
+#include <QtEndian>
+#include <string.h>
+#include <limits.h>
+
+static const char magic[] = "QGPCOLMN";
+
+static const int fixedHeaderSize = 24;
+
+/* name size, x and y type, count, x and y offset, without the name */
+static const int curveRecordSize = 4 + 4 + 4 + 8 + 8 + 8;
+
+class ColumnarFileCurve
+{
+public:
+    QString name;
+
+    int count;
+
+    qint64 xOffset, yOffset;
+};
+
+class ColumnarFilePrivate
+{
+public:
+    QFile file;
+
+    uchar *map;
+
+    qint64 size;
+
+    ColumnarFile::TimeBase timeBase;
+
+    QList<ColumnarFileCurve> curves;
+
+    QString errorMessage;
+};
+
+static void appendU32(QByteArray& b, quint32 v)
+{
+    uchar le[4];
+    qToLittleEndian(v, le);
+    b.append(reinterpret_cast<const char *>(le), 4);
+}
+
+static void appendU64(QByteArray& b, quint64 v)
+{
+    uchar le[8];
+    qToLittleEndian(v, le);
+    b.append(reinterpret_cast<const char *>(le), 8);
+}
+
+/* the first count values of v, with a single write */
+static bool writeColumn(QFile& file, const QVector<double>& v, int count)
+{
+    qint64 bytes = (qint64) count * sizeof(double);
+    if(bytes == 0)
+        return true;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    return file.write(reinterpret_cast<const char *>(v.constData()), bytes) == bytes;
+#else
+    QVector<quint64> le(count);
+    for(int i = 0; i < count; i++)
+    {
+        quint64 u;
+        memcpy(&u, &v.at(i), sizeof(u));
+        qToLittleEndian(u, reinterpret_cast<uchar *>(&le[i]));
+    }
+    return file.write(reinterpret_cast<const char *>(le.constData()), bytes) == bytes;
+#endif
+}
+
+ColumnarFile::ColumnarFile()
+{
+    d_ptr = new ColumnarFilePrivate();
+    d_ptr->map = NULL;
+    d_ptr->size = 0;
+    d_ptr->timeBase = NoTimeBase;
+}
+
+ColumnarFile::~ColumnarFile()
+{
+    close();
+    delete d_ptr;
+}
+
+bool ColumnarFile::write(const QString& fileName, const QList<SceneCurve *>& curves,
+                         TimeBase timeBase, QString *errorMessage)
+{
+    /* shallow copies, so that the columns cannot change while they are written */
+    QList<QByteArray> names;
+    QList<QVector<double> > xColumns, yColumns;
+    qint64 headerSize = fixedHeaderSize;
+    foreach(SceneCurve *c, curves)
+    {
+        names << c->name().toUtf8();
+        xColumns << c->data()->xData;
+        yColumns << c->data()->yData;
+        headerSize += curveRecordSize + names.last().size();
+    }
+    headerSize = (headerSize + 7) & ~Q_INT64_C(7);
+
+    QByteArray header;
+    header.reserve(headerSize);
+    header.append(magic, 8);
+    appendU32(header, Version);
+    appendU32(header, timeBase);
+    appendU32(header, curves.size());
+    appendU32(header, headerSize);
+    qint64 offset = headerSize;
+    for(int i = 0; i < names.size(); i++)
+    {
+        int count = qMin(xColumns.at(i).size(), yColumns.at(i).size());
+        appendU32(header, names.at(i).size());
+        header.append(names.at(i));
+        appendU32(header, Float64);
+        appendU32(header, Float64);
+        appendU64(header, count);
+        appendU64(header, offset);
+        offset += count * sizeof(double);
+        appendU64(header, offset);
+        offset += count * sizeof(double);
+    }
+    header.append(QByteArray(headerSize - header.size(), '\0'));
+
+    QFile file(fileName);
+    bool ok = file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    if(ok)
+        ok = (file.write(header) == header.size());
+    for(int i = 0; i < names.size() && ok; i++)
+    {
+        int count = qMin(xColumns.at(i).size(), yColumns.at(i).size());
+        ok = writeColumn(file, xColumns.at(i), count) && writeColumn(file, yColumns.at(i), count);
+    }
+    if(!ok)
+    {
+        if(errorMessage)
+            *errorMessage = file.errorString();
+        perr("ColumnarFile::write: error writing \"%s\": %s", qstoc(fileName), qstoc(file.errorString()));
+        if(file.isOpen())
+        {
+            file.close();
+            file.remove();
+        }
+        return false;
+    }
+    file.close();
+    return true;
+}
+
+bool ColumnarFile::open(const QString& fileName)
+{
+    close();
+    d_ptr->file.setFileName(fileName);
+    if(!d_ptr->file.open(QIODevice::ReadOnly))
+    {
+        d_ptr->errorMessage = d_ptr->file.errorString();
+        return false;
+    }
+    d_ptr->size = d_ptr->file.size();
+    if(d_ptr->size >= fixedHeaderSize)
+        d_ptr->map = d_ptr->file.map(0, d_ptr->size);
+    if(!d_ptr->map)
+    {
+        QString error = d_ptr->size < fixedHeaderSize ? QString("not a plot data file") : d_ptr->file.errorString();
+        close();
+        d_ptr->errorMessage = error;
+        return false;
+    }
+
+    const uchar *p = d_ptr->map;
+    const qint64 size = d_ptr->size;
+    QString error;
+    quint32 headerSize = qFromLittleEndian<quint32>(p + 20);
+    if(memcmp(p, magic, 8) != 0)
+        error = "not a plot data file";
+    else if(qFromLittleEndian<quint32>(p + 8) != Version)
+        error = QString("unsupported version %1").arg(qFromLittleEndian<quint32>(p + 8));
+    else if(headerSize < (quint32) fixedHeaderSize || headerSize > size || headerSize % 8 != 0)
+        error = "corrupted header";
+
+    d_ptr->timeBase = static_cast<TimeBase>(qFromLittleEndian<quint32>(p + 12));
+    quint32 ncurves = qFromLittleEndian<quint32>(p + 16);
+    qint64 pos = fixedHeaderSize;
+    for(quint32 i = 0; i < ncurves && error.isEmpty(); i++)
+    {
+        if(pos + curveRecordSize > headerSize)
+        {
+            error = "corrupted header";
+            break;
+        }
+        quint32 nameSize = qFromLittleEndian<quint32>(p + pos);
+        pos += 4;
+        if(pos + nameSize + curveRecordSize - 4 > headerSize)
+        {
+            error = "corrupted header";
+            break;
+        }
+        ColumnarFileCurve c;
+        c.name = QString::fromUtf8(reinterpret_cast<const char *>(p + pos), nameSize);
+        pos += nameSize;
+        quint32 xType = qFromLittleEndian<quint32>(p + pos);
+        quint32 yType = qFromLittleEndian<quint32>(p + pos + 4);
+        quint64 count = qFromLittleEndian<quint64>(p + pos + 8);
+        quint64 xOffset = qFromLittleEndian<quint64>(p + pos + 16);
+        quint64 yOffset = qFromLittleEndian<quint64>(p + pos + 24);
+        pos += 32;
+        if(xType != Float64 || yType != Float64)
+            error = QString("curve \"%1\": unsupported column type").arg(c.name);
+        /* each column must lie after the header and inside the file */
+        else if(count > (quint64) INT_MAX / sizeof(double) ||
+                xOffset < headerSize || xOffset > (quint64) size || (quint64) size - xOffset < count * sizeof(double) ||
+                yOffset < headerSize || yOffset > (quint64) size || (quint64) size - yOffset < count * sizeof(double))
+            error = QString("curve \"%1\": corrupted column").arg(c.name);
+        /* the map is page aligned: aligned offsets keep each double aligned */
+        else if(xOffset % 8 != 0 || yOffset % 8 != 0)
+            error = QString("curve \"%1\": misaligned column").arg(c.name);
+        else
+        {
+            c.count = static_cast<int>(count);
+            c.xOffset = xOffset;
+            c.yOffset = yOffset;
+            d_ptr->curves << c;
+        }
+    }
+
+    if(!error.isEmpty())
+    {
+        close();
+        d_ptr->errorMessage = QString("\"%1\": %2").arg(fileName).arg(error);
+        return false;
+    }
+    return true;
+}
+
+void ColumnarFile::close()
+{
+    if(d_ptr->map)
+        d_ptr->file.unmap(d_ptr->map);
+    d_ptr->map = NULL;
+    d_ptr->size = 0;
+    d_ptr->file.close();
+    d_ptr->curves.clear();
+    d_ptr->timeBase = NoTimeBase;
+    d_ptr->errorMessage.clear();
+}
+
+bool ColumnarFile::isOpen() const
+{
+    return d_ptr->map != NULL;
+}
+
+QString ColumnarFile::errorMessage() const
+{
+    return d_ptr->errorMessage;
+}
+
+ColumnarFile::TimeBase ColumnarFile::timeBase() const
+{
+    return d_ptr->timeBase;
+}
+
+int ColumnarFile::curveCount() const
+{
+    return d_ptr->curves.size();
+}
+
+QString ColumnarFile::curveName(int curve) const
+{
+    if(curve >= 0 && curve < d_ptr->curves.size())
+        return d_ptr->curves.at(curve).name;
+    return QString();
+}
+
+int ColumnarFile::pointCount(int curve) const
+{
+    if(curve >= 0 && curve < d_ptr->curves.size())
+        return d_ptr->curves.at(curve).count;
+    return 0;
+}
+
+QVector<double> ColumnarFile::xData(int curve) const
+{
+    if(curve >= 0 && curve < d_ptr->curves.size())
+        return mColumn(d_ptr->curves.at(curve).xOffset, d_ptr->curves.at(curve).count);
+    return QVector<double>();
+}
+
+QVector<double> ColumnarFile::yData(int curve) const
+{
+    if(curve >= 0 && curve < d_ptr->curves.size())
+        return mColumn(d_ptr->curves.at(curve).yOffset, d_ptr->curves.at(curve).count);
+    return QVector<double>();
+}
+
+bool ColumnarFile::load(int curve, SceneCurve *c) const
+{
+    if(!c || curve < 0 || curve >= d_ptr->curves.size())
+        return false;
+    /* skip the points that the buffer size would drop anyway */
+    int count = d_ptr->curves.at(curve).count;
+    int skip = 0;
+    if(c->bufferSize() > -1 && count > c->bufferSize())
+        skip = count - c->bufferSize();
+    c->setData(mColumn(d_ptr->curves.at(curve).xOffset + skip * (qint64) sizeof(double), count - skip),
+               mColumn(d_ptr->curves.at(curve).yOffset + skip * (qint64) sizeof(double), count - skip));
+    return true;
+}
+
+QVector<double> ColumnarFile::mColumn(qint64 offset, int count) const
+{
+    QVector<double> v(count);
+    if(count == 0)
+        return v;
+    const uchar *src = d_ptr->map + offset;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    memcpy(v.data(), src, count * sizeof(double));
+#else
+    double *dst = v.data();
+    for(int i = 0; i < count; i++)
+    {
+        quint64 u = qFromLittleEndian<quint64>(src + i * sizeof(double));
+        memcpy(&dst[i], &u, sizeof(u));
+    }
+#endif
+    return v;
+}
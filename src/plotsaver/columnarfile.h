@@ -0,0 +1,123 @@
+#ifndef COLUMNARFILE_H
+#define COLUMNARFILE_H
+
+#include <QString>
+#include <QList>
+#include <QVector>
+
+class SceneCurve;
+class ColumnarFilePrivate;
+
+/** \brief A binary file holding the data of a set of curves, column by column.
+ *
+ * The file describes itself: a header with the names of the curves, the type of
+ * their columns and the time base of the x values is followed by the raw columns.
+ * All the numbers are little endian.
+ *
+ * \verbatim
+ * offset  size  field
+ * 0       8     magic "QGPCOLMN"
+ * 8       4     version (1)
+ * 12      4     time base (TimeBase)
+ * 16      4     number of curves
+ * 20      4     header size: offset of the first column, a multiple of 8
+ * 24            for each curve:
+ *         4       size of the name, in bytes
+ *         n       the name, UTF-8
+ *         4       type of the x column (ColumnType)
+ *         4       type of the y column
+ *         8       number of points
+ *         8       offset of the x column from the start of the file
+ *         8       offset of the y column
+ *               zeros up to the header size
+ *               the columns, each one starting at a multiple of 8
+ * \endverbatim
+ *
+ * write issues a single write per column. open maps the file into memory
+ * (QFile::map): the columns are not parsed, xData, yData and load copy each
+ * column into a QVector with a single memcpy on little endian hosts.
+ *
+ * \par Example
+ * \code
+ * ColumnarFile::write("/tmp/incident.qgpc", plot->getCurves(), ColumnarFile::UnixSeconds);
+ * // later, for the offline replay
+ * ColumnarFile f;
+ * if(f.open("/tmp/incident.qgpc"))
+ *     for(int i = 0; i < f.curveCount(); i++)
+ *         f.load(i, replayPlot->findCurve(f.curveName(i)));
+ * \endcode
+ *
+ * @see PlotSceneWidget::saveBinaryData
+ * @see PlotSceneWidget::loadData
+ */
+class ColumnarFile
+{
+public:
+    enum TimeBase { NoTimeBase = 0, UnixSeconds = 1 };
+
+    enum ColumnType { Float64 = 1 };
+
+    enum { Version = 1 };
+
+    ColumnarFile();
+
+    /** \brief unmaps the file
+     */
+    ~ColumnarFile();
+
+    /** \brief writes the data of the curves to fileName.
+     *
+     * @param timeBase UnixSeconds if the x values are timestamps in seconds since
+     *        1970-01-01T00:00:00 UTC
+     * @param errorMessage if not NULL, receives the description of the error
+     * @return true if the file has been written, false otherwise
+     */
+    static bool write(const QString& fileName, const QList<SceneCurve *>& curves,
+                      TimeBase timeBase = NoTimeBase, QString *errorMessage = NULL);
+
+    /** \brief maps fileName into memory and reads its header.
+     *
+     * A file previously opened is closed first.
+     *
+     * @return false if the file cannot be mapped or is not a valid columnar file,
+     *         including a header size or a column offset that is not a multiple
+     *         of 8. errorMessage describes the reason.
+     */
+    bool open(const QString& fileName);
+
+    void close();
+
+    bool isOpen() const;
+
+    QString errorMessage() const;
+
+    TimeBase timeBase() const;
+
+    int curveCount() const;
+
+    QString curveName(int curve) const;
+
+    int pointCount(int curve) const;
+
+    QVector<double> xData(int curve) const;
+
+    QVector<double> yData(int curve) const;
+
+    /** \brief sets the data of the given curve of the file on the SceneCurve c
+     *
+     * If c has a buffer size, only the newest bufferSize points are read.
+     * The data is set with SceneCurve::setData: a curve fed by addPoint goes back
+     * to the scalar mode with the next point added, the loaded points being the
+     * oldest of its buffer.
+     *
+     * @return false if curve is out of range or c is NULL
+     */
+    bool load(int curve, SceneCurve *c) const;
+
+private:
+    ColumnarFilePrivate *d_ptr;
+
+    QVector<double> mColumn(qint64 offset, int count) const;
+};
+
+#endif // COLUMNARFILE_H
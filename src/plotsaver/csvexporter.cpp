@@ -0,0 +1,253 @@
+#include "csvexporter.h"
+#include "scenecurve.h"
+#include "curve/data.h"
+#include "doubleformatter.h"
+#include "qgraphicsplotmacros.h"
+#include <QFile>
+#include <QDateTime>
+#include <QAtomicInt>
+#include <QVector>
+#include <math.h>
+
+/* the data of a curve, at the time of setCurves */
+class CsvExporterColumn
+{
+public:
+    QString name;
+
+    QVector<double> x, y;
+};
+
+class CsvExporterPrivate
+{
+public:
+    QList<CsvExporterColumn> columns;
+
+    QString fileName, xFormat, yFormat, dateTimeFormat, xTitle, errorMessage;
+
+    int bufferSize, rowCount;
+
+    QAtomicInt rowsWritten, canceled, completed;
+
+    int lastPercent;
+};
+
+CsvExporter::CsvExporter(QObject *parent) : QThread(parent)
+{
+    d_ptr = new CsvExporterPrivate();
+    d_ptr->xFormat = "%f";
+    d_ptr->yFormat = "%g";
+    d_ptr->xTitle = "x";
+    d_ptr->bufferSize = 1 << 20;
+    d_ptr->rowCount = 0;
+    d_ptr->lastPercent = -1;
+}
+
+CsvExporter::~CsvExporter()
+{
+    cancel();
+    wait();
+    delete d_ptr;
+}
+
+void CsvExporter::setCurves(const QList<SceneCurve *>& curves)
+{
+    d_ptr->columns.clear();
+    d_ptr->rowCount = 0;
+    d_ptr->canceled.fetchAndStoreRelaxed(0);
+    foreach(SceneCurve *c, curves)
+    {
+        CsvExporterColumn col;
+        col.name = c->name();
+        /* shallow copies */
+        col.x = c->data()->xData;
+        col.y = c->data()->yData;
+        d_ptr->rowCount = qMax(d_ptr->rowCount, qMin(col.x.size(), col.y.size()));
+        d_ptr->columns << col;
+    }
+}
+
+void CsvExporter::setFileName(const QString& fileName)
+{
+    d_ptr->fileName = fileName;
+}
+
+QString CsvExporter::fileName() const
+{
+    return d_ptr->fileName;
+}
+
+void CsvExporter::setXFormat(const QString& format)
+{
+    d_ptr->xFormat = format;
+}
+
+QString CsvExporter::xFormat() const
+{
+    return d_ptr->xFormat;
+}
+
+void CsvExporter::setYFormat(const QString& format)
+{
+    d_ptr->yFormat = format;
+}
+
+QString CsvExporter::yFormat() const
+{
+    return d_ptr->yFormat;
+}
+
+void CsvExporter::setDateTimeFormat(const QString& format)
+{
+    d_ptr->dateTimeFormat = format;
+}
+
+QString CsvExporter::dateTimeFormat() const
+{
+    return d_ptr->dateTimeFormat;
+}
+
+void CsvExporter::setXTitle(const QString& title)
+{
+    d_ptr->xTitle = title;
+}
+
+void CsvExporter::setBufferSize(int bytes)
+{
+    d_ptr->bufferSize = qMax(4096, bytes);
+}
+
+int CsvExporter::bufferSize() const
+{
+    return d_ptr->bufferSize;
+}
+
+int CsvExporter::rowCount() const
+{
+    return d_ptr->rowCount;
+}
+
+int CsvExporter::rowsWritten() const
+{
+    return d_ptr->rowsWritten.fetchAndAddRelaxed(0);
+}
+
+bool CsvExporter::wasCanceled() const
+{
+    return d_ptr->canceled.fetchAndAddRelaxed(0) != 0;
+}
+
+QString CsvExporter::errorMessage() const
+{
+    return d_ptr->errorMessage;
+}
+
+bool CsvExporter::completed() const
+{
+    return d_ptr->completed.fetchAndAddRelaxed(0) != 0;
+}
+
+void CsvExporter::cancel()
+{
+    d_ptr->canceled.fetchAndStoreOrdered(1);
+}
+
+QString CsvExporter::dateTimeString(double timestamp, const QString& format)
+{
+    QDateTime dt;
+    /* tango timestamp has microseconds */
+    double usecs = (timestamp - floor(timestamp)) * 1e6;
+    int msecs = qRound(usecs/1000.0);
+    dt.setTime_t(floor(timestamp));
+    dt = dt.addMSecs(msecs);
+    return dt.toString(format);
+}
+
+bool CsvExporter::mFlush(QIODevice *file, QByteArray& buf)
+{
+    if(file->write(buf) != buf.size())
+    {
+        d_ptr->errorMessage = file->errorString();
+        return false;
+    }
+    buf.resize(0); /* keeps the reserved capacity */
+    int percent = d_ptr->rowCount > 0 ? (int) (100.0 * rowsWritten() / d_ptr->rowCount) : 100;
+    if(percent != d_ptr->lastPercent)
+    {
+        d_ptr->lastPercent = percent;
+        emit progress(percent);
+    }
+    return true;
+}
+
+void CsvExporter::run()
+{
+    d_ptr->errorMessage.clear();
+    d_ptr->completed.fetchAndStoreRelaxed(0);
+    d_ptr->rowsWritten.fetchAndStoreRelaxed(0);
+    d_ptr->lastPercent = -1;
+
+    QFile file(d_ptr->fileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text | QIODevice::Unbuffered))
+    {
+        d_ptr->errorMessage = file.errorString();
+        return;
+    }
+
+    const QList<CsvExporterColumn>& columns = d_ptr->columns;
+    const bool dateTime = !d_ptr->dateTimeFormat.isEmpty();
+    DoubleFormatter xFormatter(dateTime ? QString() : d_ptr->xFormat), yFormatter(d_ptr->yFormat);
+    QByteArray buf;
+    buf.reserve(d_ptr->bufferSize + 4096);
+
+    QString header;
+    foreach(const CsvExporterColumn& col, columns)
+        header += d_ptr->xTitle + ",\"" + col.name + "\",";
+    header.chop(1); /* remove last `,' */
+    buf += (header + "\n").toUtf8();
+
+    bool ok = true;
+    const int rows = d_ptr->rowCount;
+    for(int i = 0; i < rows && ok; i++)
+    {
+        if(d_ptr->canceled.fetchAndAddRelaxed(0))
+            break;
+        for(int j = 0; j < columns.size(); j++)
+        {
+            const CsvExporterColumn& col = columns.at(j);
+            if(j > 0)
+                buf += ',';
+            if(i < col.x.size() && i < col.y.size())
+            {
+                double x = col.x.at(i);
+                if(dateTime)
+                    buf += dateTimeString(x, d_ptr->dateTimeFormat).toUtf8();
+                else
+                    xFormatter.append(x, buf);
+                buf += ',';
+                yFormatter.append(col.y.at(i), buf);
+            }
+            else /* the curve is shorter: empty x and y cells */
+                buf += ',';
+        }
+        buf += '\n';
+        d_ptr->rowsWritten.fetchAndStoreRelaxed(i + 1);
+        if(buf.size() >= d_ptr->bufferSize)
+            ok = mFlush(&file, buf);
+    }
+    if(ok && !wasCanceled())
+        ok = mFlush(&file, buf);
+    file.close();
+
+    if(!ok || wasCanceled())
+    {
+        file.remove();
+        return;
+    }
+    foreach(const CsvExporterColumn& col, columns)
+        if(qMin(col.x.size(), col.y.size()) < rows)
+            pinfo("CsvExporter: curve \"%s\" has %d points out of %d rows: the remaining cells are empty",
+                  qstoc(col.name), qMin(col.x.size(), col.y.size()), rows);
+    /* a cancel arriving from now on is too late: the file is complete */
+    d_ptr->completed.fetchAndStoreOrdered(1);
+}
@@ -0,0 +1,139 @@
+#ifndef CSVEXPORTER_H
+#define CSVEXPORTER_H
+
+#include <QThread>
+#include <QList>
+#include <QString>
+
+class SceneCurve;
+class QIODevice;
+class CsvExporterPrivate;
+
+/** \brief Writes the data of a set of curves to a comma separated values file,
+ *         on its own thread.
+ *
+ * setCurves takes a snapshot of the data of the curves: the x and y vectors are
+ * implicitly shared, so that the snapshot costs no copy, and the curves can go on
+ * receiving data while the file is written. Only the vectors modified in the
+ * meantime are detached (copied) by the thread owning the curves.
+ *
+ * Once started, the exporter formats the rows with a DoubleFormatter for x and one
+ * for y into a buffer of bufferSize bytes, that is written to the file whenever it
+ * is full. progress is emitted each time the buffer is written, cancel stops the
+ * export at the next row and removes the partial file.
+ *
+ * Each row holds an x and a y column for each curve. When curves have different
+ * sizes, the cells of the rows beyond the end of the shorter curves are left empty,
+ * so that the columns stay aligned.
+ *
+ * \par Example
+ * \code
+ * CsvExporter *exporter = new CsvExporter(this);
+ * exporter->setCurves(plot->getCurves());
+ * exporter->setFileName("/tmp/data.csv");
+ * connect(exporter, SIGNAL(progress(int)), progressBar, SLOT(setValue(int)));
+ * connect(exporter, SIGNAL(finished()), this, SLOT(exportFinished()));
+ * exporter->start(QThread::LowPriority);
+ * \endcode
+ *
+ * @see PlotSceneWidgetSaver
+ * @see DoubleFormatter
+ */
+class CsvExporter : public QThread
+{
+    Q_OBJECT
+public:
+    CsvExporter(QObject *parent = NULL);
+
+    /** \brief cancels the export, if running, and waits for the thread to finish
+     */
+    virtual ~CsvExporter();
+
+    /** \brief takes a snapshot of the data of the curves and clears a previous
+     *         cancellation.
+     *
+     * Call it from the thread the curves live in, before start.
+     */
+    void setCurves(const QList<SceneCurve *>& curves);
+
+    void setFileName(const QString& fileName);
+
+    QString fileName() const;
+
+    /** \brief the format of the x values, see DoubleFormatter. Default "%f"
+     */
+    void setXFormat(const QString& format);
+
+    QString xFormat() const;
+
+    /** \brief the format of the y values, see DoubleFormatter. Default "%g"
+     */
+    void setYFormat(const QString& format);
+
+    QString yFormat() const;
+
+    /** \brief write x as a date and time, with the given QDateTime format
+     *
+     * An empty format (the default) writes x as a number, with xFormat.
+     */
+    void setDateTimeFormat(const QString& format);
+
+    QString dateTimeFormat() const;
+
+    /** \brief the title of the x columns in the header. Default "x"
+     */
+    void setXTitle(const QString& title);
+
+    /** \brief the size of the write buffer, in bytes. Default 1MB
+     */
+    void setBufferSize(int bytes);
+
+    int bufferSize() const;
+
+    /** \brief the number of rows of the snapshot (the size of the largest curve)
+     */
+    int rowCount() const;
+
+    /** \brief the number of rows written so far
+     */
+    int rowsWritten() const;
+
+    bool wasCanceled() const;
+
+    /** \brief true if the last export wrote the whole file.
+     *
+     * A cancel requested after the last row was written does not remove the file:
+     * wasCanceled is true and so is completed.
+     */
+    bool completed() const;
+
+    /** \brief the error occurred during the last export, empty if none
+     */
+    QString errorMessage() const;
+
+    /** \brief the local date and time of a timestamp in seconds, with format.
+     *
+     * The fraction of second is rounded to the millisecond.
+     */
+    static QString dateTimeString(double timestamp, const QString& format);
+
+public slots:
+    /** \brief stops the export at the next row. The partial file is removed.
+     */
+    void cancel();
+
+signals:
+    /** \brief the percentage of the rows written
+     */
+    void progress(int percent);
+
+protected:
+    void run();
+
+private:
+    CsvExporterPrivate *d_ptr;
+
+    bool mFlush(QIODevice *file, QByteArray& buf);
+};
+
+#endif // CSVEXPORTER_H
@@ -1,10 +1,11 @@
 #include "plotscenewidgetsaver.h"
 #include <QFile>
 #include <QFileDialog>
-#include <QTextStream>
 #include <QDir>
 #include <QMessageBox>
 #include <qgraphicsplotmacros.h>
+#include "doubleformatter.h"
+#include "csvexporter.h"
 #include <math.h>
 
 /* dialog widgets */
@@ -16,6 +17,8 @@
 #include <QDateTime>
 #include <QTextEdit>
 #include <QFile>
+#include <QProgressDialog>
+#include <QEventLoop>
 
 
 OptionsDialog::OptionsDialog(QWidget *parent, double xSam, double ySam) : QDialog(parent)
@@ -38,6 +41,7 @@ OptionsDialog::OptionsDialog(QWidget *parent, double xSam, double ySam) : QDialo
     cbXDateTime->setObjectName("cbXDateTime");
     cbXDateTime->setText("Format x data as date/time");
     leXFormat->setToolTip("For example: %f, %g, %e, %.2f, %.2g...\n"
+                          "%r writes the shortest number that reads back to the same value.\n"
                           "Change the format and see a sample representation\n"
                           "on the right, or check the \"Format data as date/time\"\n"
                           "above to format the x data as date-time.\n"
@@ -50,6 +54,7 @@ OptionsDialog::OptionsDialog(QWidget *parent, double xSam, double ySam) : QDialo
     QLineEdit *leYFormat = new QLineEdit(this);
     leYFormat->setObjectName("LineEditYFormat");
     leYFormat->setToolTip("For example: %f, %g, %e, %.2f, %.2g...\n"
+                          "%r writes the shortest number that reads back to the same value.\n"
                           "Change the format and see a sample representation\n"
                           "on the right.");
 
@@ -114,12 +119,12 @@ void OptionsDialog::updateXExample(const QString& format)
     if(mDateTimeFormat)
         findChild<QLabel *>("xFormatLabel")->setText(timestampToDateTimeString(xSample, format));
     else
-        findChild<QLabel *>("xFormatLabel")->setText(QString().sprintf(qstoc(format), xSample));
+        findChild<QLabel *>("xFormatLabel")->setText(DoubleFormatter(format).format(xSample));
 }
 
 void OptionsDialog::updateYExample(const QString& format)
 {
-    findChild<QLabel *>("yFormatLabel")->setText(QString().sprintf(qstoc(format), ySample));
+    findChild<QLabel *>("yFormatLabel")->setText(DoubleFormatter(format).format(ySample));
 }
 
 void OptionsDialog::setDateTimeFormatEnabled(bool en)
@@ -155,22 +160,17 @@ void OptionsDialog::setDateTimeFormat(bool dateTimeFmt)
 
 QString OptionsDialog::timestampToDateTimeString(double x, const QString& format)
 {
-    QDateTime dt;
-    /* tango timestamp has microseconds */
-    double usecs = (x - floor(x)) * 1e6;
-    int msecs = qRound(usecs/1000.0);
-    dt.setTime_t(floor(x));
-    dt = dt.addMSecs(msecs);
-    return dt.toString(qstoc(format));
+    return CsvExporter::dateTimeString(x, format);
 }
 
 PlotSceneWidgetSaver::PlotSceneWidgetSaver()
 {
-
+    d_canceled = false;
 }
 
 bool PlotSceneWidgetSaver::save(const QList<SceneCurve *> curves, bool timeScale)
 {
+    d_canceled = false;
     if(!curves.size())
     {
         d_errorMessage = "No curves";
@@ -184,7 +184,6 @@ bool PlotSceneWidgetSaver::save(const QList<SceneCurve *> curves, bool timeScale
         int index = floor(qrand() / (float) RAND_MAX * dataSize);
         QString xFormat = "%f", yFormat = "%g";
         bool dateTimeFormat = false; /* the default, as ever in qtango */
-        QString header, line;
         OptionsDialog optionsDialog(0, firstCurve->data()->xData.at(index), firstCurve->data()->yData.at(index));
         if(optionsDialog.exec() == QDialog::Accepted)
         {
@@ -195,61 +194,45 @@ bool PlotSceneWidgetSaver::save(const QList<SceneCurve *> curves, bool timeScale
         d_fileName = QFileDialog::getSaveFileName(0, "Save on file" , QDir::homePath(), "Comma separated values (*.csv)");
         if(!d_fileName.isEmpty())
         {
-            QFile file(d_fileName);
-            if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+            /* the rows are written by a worker thread from a snapshot of the curves,
+             * while a local event loop keeps the plots alive.
+             */
+            CsvExporter exporter;
+            exporter.setCurves(curves);
+            exporter.setFileName(d_fileName);
+            exporter.setXTitle(timeScale ? "timestamp" : "x");
+            exporter.setXFormat(xFormat);
+            exporter.setYFormat(yFormat);
+            if(dateTimeFormat)
+                exporter.setDateTimeFormat(xFormat);
+
+            QProgressDialog progressDialog(QString("Saving \"%1\"...").arg(d_fileName), "Cancel", 0, 100);
+            progressDialog.setWindowModality(Qt::ApplicationModal);
+            /* shown at once: the modal dialog prevents saving again or closing the
+             * plots while the exporter is running
+             */
+            progressDialog.setMinimumDuration(0);
+            progressDialog.setAutoReset(false);
+            progressDialog.show();
+            QEventLoop loop;
+            QObject::connect(&exporter, SIGNAL(progress(int)), &progressDialog, SLOT(setValue(int)));
+            QObject::connect(&progressDialog, SIGNAL(canceled()), &exporter, SLOT(cancel()));
+            QObject::connect(&exporter, SIGNAL(finished()), &loop, SLOT(quit()));
+            exporter.start(QThread::LowPriority);
+            loop.exec();
+
+            if(exporter.completed())
+                return true;
+            else if(exporter.wasCanceled())
             {
-                d_errorMessage = file.errorString();
+                d_canceled = true;
+                d_errorMessage = QString("saving \"%1\" canceled").arg(d_fileName);
                 return false;
             }
-            else
+            else if(!exporter.errorMessage().isEmpty())
             {
-                QList<int> sizes;
-                QTextStream out(&file);
-                foreach(SceneCurve *c, curves)
-                {
-                    /* write the header and gather the sizes of all the curves */
-                    timeScale ? header += "timestamp" : header += "x";
-                    header += ",\"" + c->name() + "\",";
-                    sizes << c->dataSize();
-                }
-                if(!header.isEmpty()) /* remove last `,' */
-                    header.remove(header.length() - 1, 1);
-                out << header + "\n";
-                if(sizes.size() > 0)
-                {
-                    /* we have to find the curve with the greatest number of data inside: not all curves
-           * might have the same data size and we do not want to miss any (x,y) data.
-           */
-                    qSort(sizes.begin(), sizes.end());
-                    int maxSize = sizes.last(); /* here we have the maximum data size among all curves */
-                    for(int i = 0; i < maxSize; i++)
-                    {
-                        line = QString();
-                        for(int j = 0; j < curves.size(); j++)
-                        {
-                            SceneCurve *jthCurve = curves.at(j);
-                            if(jthCurve->dataSize() > i)
-                            {
-                                QString xVal, yVal;
-                                double x = jthCurve->data()->xData.at(i);
-                                if(dateTimeFormat)
-                                    xVal = optionsDialog.timestampToDateTimeString(x, xFormat);
-                                else
-                                    xVal.sprintf(qstoc(xFormat), x);
-
-                                yVal.sprintf(qstoc(yFormat), jthCurve->data()->yData.at(i));
-                                line += QString("%1,%2,").arg(xVal).arg(yVal);
-                            }
-                            else
-                                pinfo("PlotSaver::save: curve \"%s\" has data size %d < %d (max %d)", qstoc(jthCurve->name()),
-                                      jthCurve->dataSize(), i, maxSize);
-                        }
-                        if(line.endsWith(","))
-                            line.remove(line.length() - 1, 1); /* remove `,' */
-                        out << line + "\n";
-                    }
-                }
-                file.close();
+                d_errorMessage = exporter.errorMessage();
+                return false;
             }
         }
         return true;
@@ -48,8 +48,12 @@ class PlotSceneWidgetSaver
 	QString errorMessage() { return d_errorMessage; }
 	QString fileName() { return d_fileName; }
 	
+	/* true if the last save was canceled by the user: save returned false */
+	bool wasCanceled() { return d_canceled; }
+	
   private:
 	QString d_errorMessage, d_fileName;
+	bool d_canceled;
 };
 
 #endif
@@ -18,7 +18,15 @@
 #include "colorpalette.h"
 #include "scalelabelinterface.h"
 #include "items/legenditem.h"
+#include "items/stripchartitem.h"
+#include "items/performancehuditem.h"
+#include "refreshscheduler.h"
+#include "refreshcoordinator.h"
+#include "frametimings.h"
+#include "tracerecorder.h"
 #include "plotsaver/plotscenewidgetsaver.h"
+#include "plotsaver/columnarfile.h"
+#include "scalelabels/timescalelabel.h"
 #include <QGLWidget>
 #include <QPainter>
 #include <QPaintEvent>
@@ -32,8 +40,11 @@
 #include <QContextMenuEvent>
 #include <QMessageBox>
 #include <QMenu>
+#include <QFileDialog>
+#include <QDir>
 #include <QTimer>
 #include <QScrollBar>
+#include <QElapsedTimer>
 #include <math.h>
 
 #include "properties/propertydialog.h"
@@ -235,6 +246,32 @@ void PlotSceneWidget::initPlot(bool useOpenGl)
     d_ptr->legendItem->setObjectName("PlotSceneWidgetLegendItem");
     scene->addItem(d_ptr->legendItem);
     addConfigurableObjects("Legend", d_ptr->legendItem);
+
+    /* created on demand by setScrollRenderMode */
+    d_ptr->stripChartItem = NULL;
+    /* created on demand by setPerformanceHudVisible */
+    d_ptr->performanceHudItem = NULL;
+    /* created by setRefreshPeriod */
+    d_ptr->refreshScheduler = NULL;
+    d_ptr->sharedRefresh = false;
+    d_ptr->layeredRendering = false;
+    /* created by setFrameTimingsEnabled */
+    d_ptr->frameTimings = NULL;
+    d_ptr->paintCount = 0;
+    d_ptr->paintTime = 0.0;
+    /* created by loadData */
+    d_ptr->loadedTimeScaleLabel = NULL;
+}
+
+PlotSceneWidget::~PlotSceneWidget()
+{
+    delete d_ptr->frameTimings;
+    /* the items destroyed with the view must not measure into it */
+    d_ptr->frameTimings = NULL;
+    ScaleItem *xScale = xScaleItem();
+    if(d_ptr->loadedTimeScaleLabel && xScale && xScale->scaleLabelInterface() == d_ptr->loadedTimeScaleLabel)
+        xScale->removeScaleLabelInterface();
+    delete d_ptr->loadedTimeScaleLabel;
 }
 
 void PlotSceneWidget::initDefaultAxes()
@@ -983,22 +1020,21 @@ void PlotSceneWidget::setYAxisLabelsOutsideCanvas(bool outside)
 
 void PlotSceneWidget::setManualSceneUpdate(bool manual)
 {
-    QTimer *t = findChild<QTimer *>("refreshTimer");
     if(manual)
     {
         setViewportUpdateMode(QGraphicsView::NoViewportUpdate);
-        /* if a timer was previously allocated and started, restart it
+        /* if a scheduler was previously allocated and started, restart it
          * so that the used does not need to call setPeriod again to
          * re activate it.
          */
-        if(t)
-            t->start();
+        if(d_ptr->refreshScheduler)
+            d_ptr->refreshScheduler->start();
     }
     else
     {
-        /* stop the timer but do not delete it */
-        if(t)
-            t->stop();
+        /* stop the scheduler but do not delete it */
+        if(d_ptr->refreshScheduler)
+            d_ptr->refreshScheduler->stop();
         /* Qt default mode */
         if(!d_ptr->useGl)
             setViewportUpdateMode(QGraphicsView::MinimalViewportUpdate);
@@ -1017,34 +1053,144 @@ void PlotSceneWidget::setRefreshPeriod(int period)
 {
     if(period > 0)
     {
-        QTimer *t = findChild<QTimer *>("refreshTimer");
-        if(!t)
-            t = new QTimer(this);
-        t->setObjectName("refreshTimer");
-        t->setInterval(period);
-        connect(t, SIGNAL(timeout()), scene(), SLOT(update()));
-        t->start();
-    }
-    else
-    {
-        QTimer *t = findChild<QTimer *>("refreshTimer");
-        if(t)
+        if(!d_ptr->refreshScheduler)
         {
-            t->stop();
-            delete t;
+            d_ptr->refreshScheduler = new RefreshScheduler(this);
+            if(d_ptr->sharedRefresh)
+                d_ptr->refreshScheduler->setCoordinator(RefreshCoordinator::instance());
         }
+        d_ptr->refreshScheduler->setTargetFps(1000.0 / period);
+        d_ptr->refreshScheduler->start();
+    }
+    else if(d_ptr->refreshScheduler)
+    {
+        d_ptr->refreshScheduler->stop();
+        delete d_ptr->refreshScheduler;
+        d_ptr->refreshScheduler = NULL;
     }
 }
 
 int PlotSceneWidget::refreshPeriod() const
 {
-    QTimer *t = findChild<QTimer *>("refreshTimer");
-    if(t)
-        return t->interval();
+    if(d_ptr->refreshScheduler)
+        return d_ptr->refreshScheduler->targetInterval();
     else
         return -1;
 }
 
+RefreshScheduler *PlotSceneWidget::refreshScheduler() const
+{
+    return d_ptr->refreshScheduler;
+}
+
+void PlotSceneWidget::requestRefresh()
+{
+    if(d_ptr->refreshScheduler)
+        d_ptr->refreshScheduler->markDirty();
+}
+
+void PlotSceneWidget::requestRefresh(const QRectF& sceneRect)
+{
+    if(d_ptr->refreshScheduler && manualSceneUpdate())
+        d_ptr->refreshScheduler->markDirty(sceneRect);
+    else if(!sceneRect.isEmpty())
+        scene()->update(sceneRect);
+}
+
+void PlotSceneWidget::setLayeredRendering(bool en)
+{
+    /* switching off releases the layers enabled when switching on */
+    if(en != d_ptr->layeredRendering)
+    {
+        foreach(ScaleItem *axis, d_ptr->axesManager->getAllAxes())
+            axis->setCacheEnabled(en);
+        foreach(SceneCurve *c, d_ptr->curveList)
+            if(c->curveItem())
+                c->curveItem()->setCacheEnabled(en);
+    }
+    d_ptr->layeredRendering = en;
+}
+
+bool PlotSceneWidget::layeredRendering() const
+{
+    return d_ptr->layeredRendering;
+}
+
+void PlotSceneWidget::setSharedRefresh(bool en)
+{
+    d_ptr->sharedRefresh = en;
+    if(d_ptr->refreshScheduler)
+        d_ptr->refreshScheduler->setCoordinator(en ? RefreshCoordinator::instance() : NULL);
+}
+
+bool PlotSceneWidget::sharedRefresh() const
+{
+    return d_ptr->sharedRefresh;
+}
+
+void PlotSceneWidget::setFrameTimingsEnabled(bool en)
+{
+    if(en && !d_ptr->frameTimings)
+        d_ptr->frameTimings = new FrameTimings();
+    else if(!en && d_ptr->frameTimings)
+    {
+        delete d_ptr->frameTimings;
+        d_ptr->frameTimings = NULL;
+    }
+}
+
+bool PlotSceneWidget::frameTimingsEnabled() const
+{
+    return d_ptr->frameTimings != NULL;
+}
+
+FrameTimings *PlotSceneWidget::frameTimings() const
+{
+    return d_ptr->frameTimings;
+}
+
+unsigned long PlotSceneWidget::paintCount() const
+{
+    return d_ptr->paintCount;
+}
+
+double PlotSceneWidget::paintTime() const
+{
+    return d_ptr->paintTime;
+}
+
+unsigned long PlotSceneWidget::memoryUsage() const
+{
+    unsigned long bytes = 0;
+    foreach(SceneCurve *sc, d_ptr->curveList)
+        bytes += sc->memoryUsage();
+    if(d_ptr->stripChartItem)
+        bytes += d_ptr->stripChartItem->memoryUsage();
+    foreach(ScaleItem *axis, d_ptr->axesManager->getAllAxes())
+        bytes += axis->layerMemoryUsage();
+    return bytes;
+}
+
+unsigned long PlotSceneWidget::releaseCaches()
+{
+    unsigned long freed = 0;
+    foreach(SceneCurve *sc, d_ptr->curveList)
+        freed += sc->releaseCaches();
+    if(d_ptr->stripChartItem)
+    {
+        freed += d_ptr->stripChartItem->memoryUsage();
+        d_ptr->stripChartItem->releaseLayer();
+        d_ptr->stripChartItem->update();
+    }
+    foreach(ScaleItem *axis, d_ptr->axesManager->getAllAxes())
+    {
+        freed += axis->layerMemoryUsage();
+        axis->releaseLayer();
+    }
+    requestRefresh();
+    return freed;
+}
+
 /** \brief adds and configures a curve with a LinePainter
  *
  * This methods adds a new curve to the plot. The curve is represented in the plot by
@@ -1085,7 +1231,7 @@ SceneCurve *PlotSceneWidget::addLineCurve(const QString& name, ScaleItem *xScale
     /* automatically pick a color */
     lp->setLineColor(colorPalette.getColor(d_ptr->curveHash.size()));
     lp->setObjectName(name);
-    d_ptr->curveHash.insert(name, sceneCurve);
+    d_ptr->insertCurve(sceneCurve);
     emit curveAdded(sceneCurve);
     return sceneCurve;
 }
@@ -1094,7 +1240,7 @@ void PlotSceneWidget::addCurve(SceneCurve *sceneCurve)
 {
     ScaleItem *xScale = sceneCurve->getXAxis();
     ScaleItem *yScale = sceneCurve->getYAxis();
-    d_ptr->curveHash.insert(sceneCurve->name(), sceneCurve);
+    d_ptr->insertCurve(sceneCurve);
     connect(sceneCurve, SIGNAL(destroyed(QObject*)), this, SLOT(curveAboutToBeDestroyed(QObject*)));
     xScale->installAxisChangeListener(sceneCurve);
     yScale->installAxisChangeListener(sceneCurve);
@@ -1113,7 +1259,7 @@ SceneCurve *PlotSceneWidget::addCurve(const QString &name,
     if(xScaleItem && yScaleItem)
     {
         SceneCurve *sceneCurve = new SceneCurve(this, name, xScaleItem, yScaleItem);
-        d_ptr->curveHash.insert(name, sceneCurve);
+        d_ptr->insertCurve(sceneCurve);
         /* if a curve is deleted by the user (instead of being removed via the removeCurve(QString) )
          * method, we have to manage the curve removal in a clean way.
          */
@@ -1162,7 +1308,7 @@ void PlotSceneWidget::curveAboutToBeDestroyed(const QString& name, bool deleteCu
         }
         else
             perr("PlotSceneWidget::removeCurve: no curve item associated to \"%s\"", qstoc(name));
-        d_ptr->curveHash.remove(name);
+        d_ptr->removeCurve(name);
         if(deleteCurve)
             delete curve;
     }
@@ -1192,7 +1338,7 @@ void PlotSceneWidget::removeAxis(QObject *_axis)
 
 QList<SceneCurve *> PlotSceneWidget::getCurves() const
 {
-    return d_ptr->curveHash.values();
+    return d_ptr->curveList;
 }
 
 SceneCurve *PlotSceneWidget::findCurve(const QString& name)
@@ -1285,7 +1431,7 @@ QList<SceneCurve *> PlotSceneWidget::curvesForAxes(ScaleItem::Id axisId, ScaleIt
 {
     QList<SceneCurve *> curves;
     ScaleItem::Id aId;
-    foreach(SceneCurve *sc, d_ptr->curveHash.values())
+    foreach(SceneCurve *sc, d_ptr->curveList)
     {
         if(orientation == ScaleItem::Horizontal)
             aId = sc->associatedXAxisId();
@@ -1300,15 +1446,23 @@ QList<SceneCurve *> PlotSceneWidget::curvesForAxes(ScaleItem::Id axisId, ScaleIt
 
 void PlotSceneWidget::boundsChanged()
 {
-    foreach(SceneCurve *sc, d_ptr->curveHash.values())
+    foreach(SceneCurve *sc, d_ptr->curveList)
         sc->invalidateCache();
     /* redraw all the axis */
     foreach(ScaleItem* scaleItem, d_ptr->axesManager->getAllAxes())
         scaleItem->redraw();
+    if(scrollRenderMode())
+        d_ptr->stripChartItem->update();
+    requestRefresh();
 }
 
 void PlotSceneWidget::paintEvent(QPaintEvent *event)
 {
+    PLOT_TIMING_SCOPE(d_ptr->frameTimings, FrameTimings::Frame);
+    PLOT_TRACE_SCOPE("paint");
+    QElapsedTimer paintTimer;
+    paintTimer.start();
+
     if(d_ptr->modifiedPaintEvent)
     {
         QPaintEvent *newEvent=new QPaintEvent(event->region().boundingRect());
@@ -1317,6 +1471,13 @@ void PlotSceneWidget::paintEvent(QPaintEvent *event)
     }
     else
         QGraphicsView::paintEvent(event);
+
+    double ms = paintTimer.nsecsElapsed() / 1e6;
+    d_ptr->paintCount++;
+    d_ptr->paintTime += ms;
+    /* let the scheduler adapt the refresh rate to the paint cost */
+    if(d_ptr->refreshScheduler)
+        d_ptr->refreshScheduler->paintFinished(ms);
 }
 
 void PlotSceneWidget::mousePressEvent(QMouseEvent *event)
@@ -1385,7 +1546,10 @@ void PlotSceneWidget::mouseReleaseEvent(QMouseEvent *event)
             QRectF selectionRect = QRectF(mP1, mP2);
             d_ptr->zoomer->zoom(selectionRect);
             /* clear the rect drawn during mouse move + left click */
-            qobject_cast<GraphicsScene* >(scene())->setZoomRect(QRectF());
+            GraphicsScene *gs = qobject_cast<GraphicsScene* >(scene());
+            QRectF oldZoomRect = gs->zoomRect();
+            gs->setZoomRect(QRectF());
+            requestRefresh(oldZoomRect.adjusted(-1, -1, 1, 1));
         }
         //update(); /* shouldn't be necessary */
     }
@@ -1458,8 +1622,11 @@ void PlotSceneWidget::mouseMoveEvent(QMouseEvent *event)
             botRight.setY(d_ptr->mousePressedPoint.y());
         }
         QRectF zoomR(topLeft, botRight);
-        qobject_cast<GraphicsScene* >(scene())->setZoomRect(this->mapToScene(zoomR.toRect()).boundingRect());
-        scene()->update(); /* shouldn't be necessary */
+        GraphicsScene *gs = qobject_cast<GraphicsScene* >(scene());
+        QRectF oldZoomRect = gs->zoomRect();
+        gs->setZoomRect(this->mapToScene(zoomR.toRect()).boundingRect());
+        /* repaint only the area covered by the old and the new rectangle */
+        requestRefresh((oldZoomRect | gs->zoomRect()).adjusted(-1, -1, 1, 1));
     }
     if(d_ptr->mousePressed)
         d_ptr->mousePressed = false;
@@ -1739,26 +1906,18 @@ QList<SceneCurve*> PlotSceneWidget::getClosest(
     closestPos = QPointF();
     SceneCurve *closestCurve = NULL;
     *closestIndex = -1;
-    double minDist = 1e9, dist, xp, yp, xc, yc;
-    foreach(SceneCurve *c, d_ptr->curveHash.values())
+    double minDist = 1e9, dist;
+    int index;
+    foreach(SceneCurve *c, d_ptr->curveList)
     {
-        const QPointF *points = c->points();
-        int dataSize = c->data()->size();
-        for(int i = 0; i < dataSize; i++)
+        /* each curve keeps a nearest point index over its projected points */
+        index = c->closestPoint(scenePos, &dist);
+        if(index >= 0 && dist < minDist)
         {
-            xc = points[i].x();
-            yc = points[i].y();
-            xp = scenePos.x();
-            yp = scenePos.y();
-            dist = sqrt(pow(xp - xc, 2) + pow(yp - yc, 2));
-         //   qDebug() << "dist " << dist << "min dist" << minDist;
-            if(dist < minDist)
-            {
-                minDist = dist;
-                closestCurve = c;
-                *closestIndex = i;
-                closestPos = points[i];
-            }
+            minDist = dist;
+            closestCurve = c;
+            *closestIndex = index;
+            closestPos = c->points()[index];
         }
     }
     if(closestCurve)
@@ -1768,7 +1927,7 @@ QList<SceneCurve*> PlotSceneWidget::getClosest(
         double x = closestCurve->data()->xData.at(*closestIndex);
         double y = closestCurve->data()->yData.at(*closestIndex);
         double otherx, othery;
-        foreach(SceneCurve *c, d_ptr->curveHash.values())
+        foreach(SceneCurve *c, d_ptr->curveList)
         {
             if(c != closestCurve && c)
             {
@@ -1861,6 +2020,10 @@ QMenu * PlotSceneWidget::createContextMenu()
     menu->addSeparator();
     QAction *saveDataAction = menu->addAction("Save Data...", this, SLOT(saveData()));
     saveDataAction->setToolTip("Open a dialog to save data on a file with different format options");
+    QAction *saveBinaryAction = menu->addAction("Save Binary Data...", this, SLOT(saveBinaryData()));
+    saveBinaryAction->setToolTip("Save the data in a binary file that can be loaded back with \"Load Data...\"");
+    QAction *loadDataAction = menu->addAction("Load Data...", this, SLOT(loadData()));
+    loadDataAction->setToolTip("Load the data saved with \"Save Binary Data...\"");
     return menu;
 }
 
@@ -1903,6 +2066,57 @@ bool PlotSceneWidget::legendVisible() const
     return d_ptr->legendItem->isVisible();
 }
 
+void PlotSceneWidget::setScrollRenderMode(bool en)
+{
+    if(en && !d_ptr->stripChartItem)
+    {
+        d_ptr->stripChartItem = new StripChartItem(this);
+        scene()->addItem(d_ptr->stripChartItem);
+        /* a curve added or removed requires the strip chart to be rendered again */
+        connect(this, SIGNAL(curveAdded(SceneCurve*)), d_ptr->stripChartItem, SLOT(invalidate()));
+        connect(this, SIGNAL(curveAboutToBeRemoved(SceneCurve*)), d_ptr->stripChartItem, SLOT(invalidate()));
+    }
+    if(d_ptr->stripChartItem)
+    {
+        d_ptr->stripChartItem->setVisible(en);
+        d_ptr->stripChartItem->invalidate();
+    }
+    foreach(SceneCurve *sc, d_ptr->curveList)
+        if(sc->curveItem())
+            sc->curveItem()->update();
+}
+
+bool PlotSceneWidget::scrollRenderMode() const
+{
+    return d_ptr->stripChartItem != NULL && d_ptr->stripChartItem->isVisible();
+}
+
+StripChartItem *PlotSceneWidget::stripChartItem() const
+{
+    return d_ptr->stripChartItem;
+}
+
+void PlotSceneWidget::setPerformanceHudVisible(bool visible)
+{
+    if(visible && !d_ptr->performanceHudItem)
+    {
+        d_ptr->performanceHudItem = new PerformanceHudItem(this);
+        scene()->addItem(d_ptr->performanceHudItem);
+    }
+    if(d_ptr->performanceHudItem)
+        d_ptr->performanceHudItem->setVisible(visible);
+}
+
+bool PlotSceneWidget::performanceHudVisible() const
+{
+    return d_ptr->performanceHudItem != NULL && d_ptr->performanceHudItem->isVisible();
+}
+
+PerformanceHudItem *PlotSceneWidget::performanceHudItem() const
+{
+    return d_ptr->performanceHudItem;
+}
+
 void PlotSceneWidget::setBackgroundColor(const QColor& c) const
 {
     scene()->setBackgroundBrush(QBrush(c));
@@ -1922,9 +2136,62 @@ void PlotSceneWidget::saveData()
         ScaleLabelInterface *scaleLabelInterface = xScaleItem()->scaleLabelInterface();
         timeScale = (scaleLabelInterface && scaleLabelInterface->type() == ScaleLabelInterface::TimeScale);
         PlotSceneWidgetSaver saver;
-        if(!saver.save(curves, timeScale))
+        /* no error box if the user canceled */
+        if(!saver.save(curves, timeScale) && !saver.wasCanceled())
             QMessageBox::critical(this, "Error saving on file", QString("Error saving file \"%1\":\n%2").arg(saver.fileName()).
                                   arg(saver.errorMessage()));
     }
 }
 
+void PlotSceneWidget::saveBinaryData()
+{
+    QList<SceneCurve *> curves = this->getCurves();
+    if(!curves.size())
+        return;
+    QString fileName = QFileDialog::getSaveFileName(this, "Save binary data", QDir::homePath(), "Plot data (*.qgpc)");
+    if(fileName.isEmpty())
+        return;
+    ScaleLabelInterface *scaleLabelInterface = xScaleItem()->scaleLabelInterface();
+    bool timeScale = (scaleLabelInterface && scaleLabelInterface->type() == ScaleLabelInterface::TimeScale);
+    QString error;
+    if(!ColumnarFile::write(fileName, curves, timeScale ? ColumnarFile::UnixSeconds : ColumnarFile::NoTimeBase, &error))
+        QMessageBox::critical(this, "Error saving on file", QString("Error saving file \"%1\":\n%2").arg(fileName).arg(error));
+}
+
+void PlotSceneWidget::loadData()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, "Load data", QDir::homePath(), "Plot data (*.qgpc)");
+    QString error;
+    if(!fileName.isEmpty() && !loadData(fileName, &error))
+        QMessageBox::critical(this, "Error loading file", QString("Error loading file \"%1\":\n%2").arg(fileName).arg(error));
+}
+
+bool PlotSceneWidget::loadData(const QString& fileName, QString *errorMessage)
+{
+    ColumnarFile file;
+    if(!file.open(fileName))
+    {
+        if(errorMessage)
+            *errorMessage = file.errorMessage();
+        perr("PlotSceneWidget::loadData: %s", qstoc(file.errorMessage()));
+        return false;
+    }
+    for(int i = 0; i < file.curveCount(); i++)
+    {
+        SceneCurve *c = findCurve(file.curveName(i));
+        if(!c)
+            c = addLineCurve(file.curveName(i));
+        file.load(i, c);
+    }
+    /* timestamps: show dates and times on the x axis, unless already so */
+    ScaleLabelInterface *scaleLabelInterface = xScaleItem()->scaleLabelInterface();
+    if(file.timeBase() == ColumnarFile::UnixSeconds &&
+            !(scaleLabelInterface && scaleLabelInterface->type() == ScaleLabelInterface::TimeScale))
+    {
+        if(!d_ptr->loadedTimeScaleLabel)
+            d_ptr->loadedTimeScaleLabel = new TimeScaleLabel();
+        xScaleItem()->installScaleLabelInterface(d_ptr->loadedTimeScaleLabel);
+    }
+    return true;
+}
+
@@ -19,6 +19,10 @@ class AxesManager;
 class PlotGeometryEventListener;
 class MouseEventListener;
 class LegendItem;
+class StripChartItem;
+class PerformanceHudItem;
+class RefreshScheduler;
+class FrameTimings;
 class QGraphicsZoomer;
 
 /** \brief The main class that contains the plot canvas.
@@ -187,6 +191,11 @@ class  PlotSceneWidget : public QGraphicsView, public XYPlotInterface
     Q_PROPERTY(bool scrollBarsEnabled READ scrollBarsEnabled WRITE setScrollBarsEnabled)
     Q_PROPERTY(bool legendVisible READ legendVisible WRITE setLegendVisible)
     Q_PROPERTY(QColor backgroundColor READ backgroundColor WRITE setBackgroundColor)
+    Q_PROPERTY(bool scrollRenderMode READ scrollRenderMode WRITE setScrollRenderMode)
+    Q_PROPERTY(bool sharedRefresh READ sharedRefresh WRITE setSharedRefresh)
+    Q_PROPERTY(bool layeredRendering READ layeredRendering WRITE setLayeredRendering)
+    Q_PROPERTY(bool frameTimingsEnabled READ frameTimingsEnabled WRITE setFrameTimingsEnabled)
+    Q_PROPERTY(bool performanceHudVisible READ performanceHudVisible WRITE setPerformanceHudVisible)
 
     Q_OBJECT
 public:
@@ -197,6 +206,8 @@ public:
 
     explicit PlotSceneWidget(QWidget *parent, bool initDefaultAxes, bool useOpenGl = false);
 
+    virtual ~PlotSceneWidget();
+
     bool xScaleEnabled() const;
 
     bool yScaleEnabled() const;
@@ -213,6 +224,16 @@ public:
 
     bool legendVisible() const;
 
+    bool scrollRenderMode() const;
+
+    bool sharedRefresh() const;
+
+    bool layeredRendering() const;
+
+    bool frameTimingsEnabled() const;
+
+    bool performanceHudVisible() const;
+
     virtual void boundsChanged();
 
     void installPlotGeometryChangeListener(PlotGeometryEventListener *l);
@@ -440,6 +461,58 @@ public:
 
     LegendItem *legendItem() const;
 
+    /** \brief returns the StripChartItem used when scrollRenderMode is enabled, NULL
+     *         if the scroll render mode has never been enabled.
+     */
+    StripChartItem *stripChartItem() const;
+
+    /** \brief returns the PerformanceHudItem, NULL if the performance HUD has never
+     *         been made visible.
+     *
+     * @see setPerformanceHudVisible
+     */
+    PerformanceHudItem *performanceHudItem() const;
+
+    /** \brief returns the RefreshScheduler that paces the scene updates, NULL if
+     *         setRefreshPeriod has not been called with a positive period.
+     *
+     * @see setRefreshPeriod
+     * @see RefreshScheduler
+     */
+    RefreshScheduler *refreshScheduler() const;
+
+    /** \brief returns the per stage timings of the render pipeline, NULL if
+     *         frameTimingsEnabled is false.
+     *
+     * @see setFrameTimingsEnabled
+     * @see FrameTimings
+     */
+    FrameTimings *frameTimings() const;
+
+    /** \brief the number of paint events processed by the view since its creation
+     */
+    unsigned long paintCount() const;
+
+    /** \brief the total time, in milliseconds, spent in paint events since the view
+     *         creation
+     */
+    double paintTime() const;
+
+    /** \brief an estimate of the memory, in bytes, used by the plot: the sum of
+     *         SceneCurve::memoryUsage of its curves plus the StripChartItem image and
+     *         the axes layers.
+     *
+     * @see MemoryBudget
+     */
+    unsigned long memoryUsage() const;
+
+    /** \brief frees the projection caches and the raster layers of the curves, the
+     *         axes layers and the StripChartItem image. They are built again when needed.
+     *
+     * @return the number of bytes freed
+     */
+    unsigned long releaseCaches();
+
     QGraphicsZoomer * zoomer() const;
 
     ScaleItem *addAxis(ScaleItem::Orientation o, ScaleItem::Id id, ScaleItem *associatedAxis);
@@ -640,10 +713,11 @@ public slots:
       * @param  period  the interval, in milliseconds of the internal timer.
       *
       * The period must be greater than 0. If zero or a negative value is passed,
-      * then the internal timer is stopped and destroyed.
-      * When invoked with a value greater than zero, an internal refresh timer is
-      * created, with objectName "refreshTimer", its interval is set to period and
-      * the timer is started. At each timeout, the scene is refreshed.
+      * then the internal scheduler is stopped and destroyed.
+      * When invoked with a value greater than zero, an internal RefreshScheduler is
+      * created and its target frame rate is set to 1000 / period frames per second.
+      * The scene is refreshed at most once per period, and only if a curve or an axis
+      * has notified a change through requestRefresh.
       * The period must be as fast as to ensure that the fastest item in the scene is
       * updated in time.
       *
@@ -654,6 +728,95 @@ public slots:
       */
     void setRefreshPeriod(int period);
 
+    /** \brief notifies the RefreshScheduler, if any, that the scene content has changed.
+     *
+     * SceneCurve and the axes call this method automatically. Call it after changing
+     * custom items when manualSceneUpdate is enabled.
+     *
+     * @see RefreshScheduler
+     */
+    void requestRefresh();
+
+    /** \brief notifies that only a region of the scene has changed, typically because
+     *         an overlay item moved.
+     *
+     * When manualSceneUpdate is enabled, the RefreshScheduler repaints only the region,
+     * unless a full refresh is pending. Otherwise the region is updated in the scene.
+     *
+     * @param sceneRect the changed region, in scene coordinates. It must include the
+     *        area covered by the overlay before the change.
+     *
+     * @see setLayeredRendering
+     */
+    void requestRefresh(const QRectF& sceneRect);
+
+    /** \brief registers the plot refresh with the process wide RefreshCoordinator
+     *
+     * @param en true the RefreshScheduler of the plot is driven by
+     *        RefreshCoordinator::instance(), so that all the plots sharing the refresh
+     *        are updated in a single synchronized pass per frame.
+     * @param en false (default) the RefreshScheduler of the plot uses its own timer.
+     *
+     * The setting takes effect on the scheduler created by setRefreshPeriod, whether
+     * setRefreshPeriod is called before or after.
+     *
+     * @see RefreshCoordinator
+     */
+    void setSharedRefresh(bool en);
+
+    /** \brief composes the plot from separately cached layers, so that interactive
+     *         overlays never cause the curves to be painted again.
+     *
+     * The scene is made of three layers:
+     * \li the static layer: the axes and the grid, cached by each ScaleItem (see
+     *     ScaleItem::setCacheEnabled);
+     * \li the curves layer: each CurveItem, rendered into its raster layer (see
+     *     CurveItem::setCacheEnabled);
+     * \li the overlay layer: the zoom rectangle, MarkerItem, TargetItem and
+     *     CrosshairItem. Overlays always update only the region they cover (see
+     *     requestRefresh(const QRectF&)).
+     *
+     * @param en true the cache is enabled on every axis and on the CurveItem of every
+     *        curve, including the curves added afterwards. When an overlay changes, the
+     *        axes and the curves below are blitted from their layers.
+     * @param en false (default) if layered rendering was enabled, the cache of every
+     *        axis and CurveItem is disabled and the layers are freed. Otherwise the
+     *        caches are left as configured by ScaleItem::setCacheEnabled and
+     *        CurveItem::setCacheEnabled.
+     *
+     * \note Layered rendering is off by default, also with manualSceneUpdate and the
+     * RefreshScheduler. Overlays then still update only the region they cover, but
+     * CurveItem::paint runs again for every curve under that region. Call
+     * setLayeredRendering(true) so that overlays never repaint the curves.
+     *
+     * The layers are rendered again only when the data, the axes bounds, the canvas or
+     * the view transform change. The cost is the memory of one ARGB image per curve,
+     * as large as the curve bounding rect in device coordinates.
+     */
+    void setLayeredRendering(bool en);
+
+    /** \brief enables the measurement of the time spent in each stage of the render
+     *         pipeline
+     *
+     * @param en true the durations of data ingestion, bounds calculation, projection,
+     *        painters, axes, legend and overlays are collected into the FrameTimings
+     *        returned by frameTimings.
+     * @param en false (default) no measurement is taken and the collected timings are
+     *        discarded.
+     *
+     * @see FrameTimings
+     */
+    void setFrameTimingsEnabled(bool en);
+
+    /** \brief shows or hides an overlay with the frame rate, the frame time, the data
+     *         ingestion rate and the points and memory of each curve
+     *
+     * The PerformanceHudItem is created the first time the HUD is shown.
+     *
+     * @see PerformanceHudItem
+     */
+    void setPerformanceHudVisible(bool visible);
+
     void executePropertyDialog();
 
     virtual void appendData(const QString& curveName, double x, double y);
@@ -767,6 +930,21 @@ public slots:
 
     void setLegendVisible(bool visible);
 
+    /** \brief enables the strip chart scroll render mode
+     *
+     * @param en true curves are rendered by a StripChartItem into an offscreen image that is
+     *        shifted by the pixel delta of the x axis bounds, so that only the newly exposed
+     *        columns are rasterized at each refresh.
+     * @param en false (default) each CurveItem draws its curve on each paint event.
+     *
+     * This mode is meant for time trends with a sliding x window, where the curves are fed
+     * with appendData and the x data is ordered. When these conditions are not met, the
+     * StripChartItem falls back to rendering all the curves, and there is no gain.
+     *
+     * @see StripChartItem
+     */
+    void setScrollRenderMode(bool en);
+
     void setXAxisLowerBound(double xlb);
 
     void setYAxisLowerBound(double ylb);
@@ -793,6 +971,29 @@ public slots:
 
     void saveData();
 
+    /** \brief asks for a file name and saves the data of all the curves in the binary
+     *         columnar format of ColumnarFile.
+     *
+     * If the x axis shows a TimeScaleLabel, the x values are stored as timestamps.
+     */
+    void saveBinaryData();
+
+    /** \brief asks for a file saved with saveBinaryData and loads it, see loadData(const QString&)
+     */
+    void loadData();
+
+    /** \brief loads the curves saved in fileName with saveBinaryData.
+     *
+     * The data of each curve of the file replaces the data of the curve with the same
+     * name, see ColumnarFile::load. Missing curves are added with addLineCurve.
+     * If the file was saved with a time base, a TimeScaleLabel is installed on the
+     * x axis, unless the axis already shows times.
+     *
+     * @param errorMessage if not NULL, receives the reason of the failure
+     * @return false if the file cannot be opened or is not a valid file.
+     */
+    bool loadData(const QString& fileName, QString *errorMessage = NULL);
+
     virtual QMenu *createContextMenu();
 
 protected slots:
@@ -1,5 +1,6 @@
 #include "plotscenewidget_private.h"
 #include "plotscenewidget.h"
+#include "curve/scenecurve.h"
 
 PlotSceneWidgetPrivate::PlotSceneWidgetPrivate(PlotSceneWidget *view)
 {
@@ -26,3 +27,18 @@ PlotSceneWidgetPrivate::PlotSceneWidgetPrivate(PlotSceneWidget *view)
 
     useGl = false;
 }
+
+void PlotSceneWidgetPrivate::insertCurve(SceneCurve *c)
+{
+    /* a curve with the same name is replaced */
+    if(curveHash.contains(c->name()))
+        curveList.removeAll(curveHash.value(c->name()));
+    curveHash.insert(c->name(), c);
+    curveList.append(c);
+}
+
+void PlotSceneWidgetPrivate::removeCurve(const QString &name)
+{
+    curveList.removeAll(curveHash.value(name));
+    curveHash.remove(name);
+}
@@ -12,6 +12,11 @@ class PlotGeometryEventListener;
 class MouseEventListener;
 class QGraphicsZoomer;
 class LegendItem;
+class StripChartItem;
+class PerformanceHudItem;
+class RefreshScheduler;
+class FrameTimings;
+class TimeScaleLabel;
 
 class PlotSceneWidgetPrivate
 {
@@ -32,6 +37,15 @@ public:
 
     QHash<QString, SceneCurve *> curveHash;
 
+    /* the curves in curveHash, in insertion order. Returned by getCurves without
+     * building a new list at each call.
+     */
+    QList<SceneCurve *> curveList;
+
+    void insertCurve(SceneCurve *c);
+
+    void removeCurve(const QString& name);
+
     AxesManager *axesManager;
 
     double topLeftXPercent, topLeftYPercent, widthPercent, heightPercent;
@@ -53,6 +67,28 @@ public:
 
     LegendItem *legendItem;
 
+    StripChartItem *stripChartItem;
+
+    PerformanceHudItem *performanceHudItem;
+
+    RefreshScheduler *refreshScheduler;
+
+    bool sharedRefresh;
+
+    /* CurveItem caches are enabled on all the curves */
+    bool layeredRendering;
+
+    /* NULL unless frameTimingsEnabled */
+    FrameTimings *frameTimings;
+
+    /* number of paint events and total time spent painting, in milliseconds */
+    unsigned long paintCount;
+
+    double paintTime;
+
+    /* installed on the x axis by loadData for files with a time base */
+    TimeScaleLabel *loadedTimeScaleLabel;
+
 private:
     PlotSceneWidget *mView;
 
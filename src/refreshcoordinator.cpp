@@ -0,0 +1,194 @@
+#include "refreshcoordinator.h"
+#include "refreshscheduler.h"
+#include "plotscenewidget.h"
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QCoreApplication>
+#include <QHash>
+#include <QList>
+#include <QtAlgorithms>
+#include <QtDebug>
+#include "qgraphicsplotmacros.h"
+
+static RefreshCoordinator *coordinatorInstance = NULL;
+
+/* a dirty scheduler with its priority in the current pass */
+struct Candidate
+{
+    RefreshScheduler *scheduler;
+    int priority;
+};
+
+static bool candidateLessThan(const Candidate &c1, const Candidate &c2)
+{
+    return c1.priority > c2.priority;
+}
+
+class RefreshCoordinatorPrivate
+{
+public:
+    QList<RefreshScheduler *> schedulers;
+
+    /* scheduler, number of consecutive passes it has been deferred */
+    QHash<RefreshScheduler *, int> deferrals;
+
+    QTimer *timer;
+
+    QElapsedTimer lastFrame;
+
+    double targetFps, frameBudget;
+
+    unsigned long frameCount, deferredCount;
+
+    int interval() const { return qRound(1000.0 / targetFps); }
+
+    int priority(RefreshScheduler *s) const;
+};
+
+int RefreshCoordinatorPrivate::priority(RefreshScheduler *s) const
+{
+    PlotSceneWidget *plot = s->plot();
+    int p = 0;
+    if(plot->hasFocus())
+        p = 2;
+    else if(plot->window()->isActiveWindow())
+        p = 1;
+    /* aging: a deferred plot eventually overtakes the others */
+    return p + deferrals.value(s, 0);
+}
+
+RefreshCoordinator *RefreshCoordinator::instance()
+{
+    if(!coordinatorInstance)
+        coordinatorInstance = new RefreshCoordinator(QCoreApplication::instance());
+    return coordinatorInstance;
+}
+
+RefreshCoordinator::RefreshCoordinator(QObject *parent) : QObject(parent)
+{
+    d_ptr = new RefreshCoordinatorPrivate();
+    d_ptr->targetFps = 25.0;
+    d_ptr->frameBudget = 20.0;
+    d_ptr->frameCount = d_ptr->deferredCount = 0;
+    d_ptr->timer = new QTimer(this);
+    d_ptr->timer->setSingleShot(true);
+    connect(d_ptr->timer, SIGNAL(timeout()), this, SLOT(frame()));
+    setObjectName("refreshCoordinator");
+}
+
+RefreshCoordinator::~RefreshCoordinator()
+{
+    coordinatorInstance = NULL;
+    delete d_ptr;
+}
+
+void RefreshCoordinator::registerScheduler(RefreshScheduler *s)
+{
+    if(!d_ptr->schedulers.contains(s))
+        d_ptr->schedulers.append(s);
+}
+
+void RefreshCoordinator::unregisterScheduler(RefreshScheduler *s)
+{
+    d_ptr->schedulers.removeAll(s);
+    d_ptr->deferrals.remove(s);
+}
+
+int RefreshCoordinator::schedulerCount() const
+{
+    return d_ptr->schedulers.size();
+}
+
+double RefreshCoordinator::targetFps() const
+{
+    return d_ptr->targetFps;
+}
+
+double RefreshCoordinator::frameBudget() const
+{
+    return d_ptr->frameBudget;
+}
+
+unsigned long RefreshCoordinator::frameCount() const
+{
+    return d_ptr->frameCount;
+}
+
+unsigned long RefreshCoordinator::deferredCount() const
+{
+    return d_ptr->deferredCount;
+}
+
+void RefreshCoordinator::setTargetFps(double fps)
+{
+    if(fps > 0.0)
+        d_ptr->targetFps = fps;
+    else
+        perr("RefreshCoordinator::setTargetFps: invalid fps %f", fps);
+}
+
+void RefreshCoordinator::setFrameBudget(double ms)
+{
+    if(ms > 0.0)
+        d_ptr->frameBudget = ms;
+    else
+        perr("RefreshCoordinator::setFrameBudget: invalid budget %f", ms);
+}
+
+void RefreshCoordinator::requestFrame()
+{
+    if(d_ptr->timer->isActive())
+        return;
+    int wait = 0;
+    if(d_ptr->lastFrame.isValid())
+        wait = qMax(0, d_ptr->interval() - (int) d_ptr->lastFrame.elapsed());
+    d_ptr->timer->start(wait);
+}
+
+void RefreshCoordinator::frame()
+{
+    QList<Candidate> candidates;
+    foreach(RefreshScheduler *s, d_ptr->schedulers)
+    {
+        if(s->isRunning() && s->isDirty() && !s->isPaused())
+        {
+            Candidate c;
+            c.scheduler = s;
+            c.priority = d_ptr->priority(s);
+            candidates << c;
+        }
+    }
+    if(candidates.isEmpty())
+        return;
+
+    qStableSort(candidates.begin(), candidates.end(), candidateLessThan);
+
+    d_ptr->lastFrame.start();
+    d_ptr->frameCount++;
+    bool pending = false;
+    int updated = 0;
+    double estimatedCost = 0.0;
+    foreach(Candidate c, candidates)
+    {
+        RefreshScheduler *s = c.scheduler;
+        if(!s->frameDue())
+        {
+            /* this plot has a slower refresh period */
+            pending = true;
+        }
+        else if(updated > 0 && estimatedCost + s->paintCost() > d_ptr->frameBudget)
+        {
+            d_ptr->deferrals[s]++;
+            d_ptr->deferredCount++;
+            pending = true;
+        }
+        else if(s->renderFrame())
+        {
+            estimatedCost += s->paintCost();
+            d_ptr->deferrals.remove(s);
+            updated++;
+        }
+    }
+    if(pending)
+        requestFrame();
+}
@@ -0,0 +1,89 @@
+#ifndef REFRESHCOORDINATOR_H
+#define REFRESHCOORDINATOR_H
+
+#include <QObject>
+
+class RefreshScheduler;
+class RefreshCoordinatorPrivate;
+
+/** \brief A process wide coordinator that synchronizes the refresh of many
+ *         PlotSceneWidgets.
+ *
+ * When an application hosts several plots, each RefreshScheduler would run its own
+ * timer and the repaints of the plots would not be synchronized. A RefreshScheduler
+ * registered with the coordinator does not run a timer of its own: it asks the
+ * coordinator for a frame and the coordinator issues one single update pass for all
+ * the dirty plots, at the coordinator targetFps.
+ *
+ * Enable the coordination on a plot with PlotSceneWidget::setSharedRefresh.
+ *
+ * \par Priorities
+ * In each pass, the plot that has the keyboard focus comes first, then the plots
+ * in the active window, then the others. Plots that have been deferred in previous
+ * passes gain priority, so that none of them starves.
+ * Hidden plots are skipped (see RefreshScheduler).
+ * The refresh period of each plot is still honoured: a plot is not updated more
+ * often than its own RefreshScheduler::interval.
+ *
+ * \par Frame budget
+ * The coordinator estimates the cost of each plot with its RefreshScheduler::paintCost.
+ * Once the sum of the estimates of the plots updated in a pass exceeds frameBudget,
+ * the remaining plots are deferred to the next pass. At least one plot is updated
+ * in each pass.
+ */
+class RefreshCoordinator : public QObject
+{
+    Q_PROPERTY(double targetFps READ targetFps WRITE setTargetFps)
+    Q_PROPERTY(double frameBudget READ frameBudget WRITE setFrameBudget)
+
+    Q_OBJECT
+public:
+    /** \brief returns the unique instance of the coordinator, creating it if necessary.
+     */
+    static RefreshCoordinator *instance();
+
+    virtual ~RefreshCoordinator();
+
+    void registerScheduler(RefreshScheduler *s);
+
+    void unregisterScheduler(RefreshScheduler *s);
+
+    int schedulerCount() const;
+
+    double targetFps() const;
+
+    /** \brief the estimated time, in milliseconds, that the plots updated in a single
+     *         pass are allowed to spend painting.
+     */
+    double frameBudget() const;
+
+    /** \brief the number of update passes issued
+     */
+    unsigned long frameCount() const;
+
+    /** \brief the number of times a dirty plot has been deferred to the next pass
+     */
+    unsigned long deferredCount() const;
+
+public slots:
+
+    void setTargetFps(double fps);
+
+    void setFrameBudget(double ms);
+
+    /** \brief called by a registered RefreshScheduler when it becomes dirty.
+     *
+     * Schedules the next update pass, unless one is already scheduled.
+     */
+    void requestFrame();
+
+private slots:
+    void frame();
+
+private:
+    explicit RefreshCoordinator(QObject *parent);
+
+    RefreshCoordinatorPrivate *d_ptr;
+};
+
+#endif // REFRESHCOORDINATOR_H
@@ -0,0 +1,315 @@
+#include "refreshscheduler.h"
+#include "plotscenewidget.h"
+#include "refreshcoordinator.h"
+#include "scenecurve.h"
+#include "curveitem.h"
+#include "tracerecorder.h"
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QPointer>
+#include <QGraphicsScene>
+#include <QtDebug>
+#include <math.h>
+#include "qgraphicsplotmacros.h"
+
+class RefreshSchedulerPrivate
+{
+public:
+    PlotSceneWidget *plot;
+
+    QTimer *timer;
+
+    /* measures the time elapsed since the last frame */
+    QElapsedTimer lastFrame;
+
+    double targetFps, paintBudget, paintCost;
+
+    bool adaptive, running, paused, dirty;
+
+    /* true if the whole scene must be updated, false if only dirtyRect */
+    bool fullDirty;
+
+    /* the union of the regions, in scene coordinates, passed to markDirty */
+    QRectF dirtyRect;
+
+    int interval;
+
+    unsigned long frameCount, dirtyCount;
+
+    QPointer<QWidget> filteredWindow;
+
+    QPointer<RefreshCoordinator> coordinator;
+};
+
+RefreshScheduler::RefreshScheduler(PlotSceneWidget *plot) : QObject(plot)
+{
+    d_ptr = new RefreshSchedulerPrivate();
+    d_ptr->plot = plot;
+    d_ptr->targetFps = 25.0;
+    d_ptr->paintBudget = 0.5;
+    d_ptr->paintCost = 0.0;
+    d_ptr->adaptive = true;
+    d_ptr->running = d_ptr->paused = d_ptr->dirty = d_ptr->fullDirty = false;
+    d_ptr->interval = targetInterval();
+    d_ptr->frameCount = d_ptr->dirtyCount = 0;
+    d_ptr->timer = new QTimer(this);
+    d_ptr->timer->setSingleShot(true);
+    connect(d_ptr->timer, SIGNAL(timeout()), this, SLOT(frameTimeout()));
+    setObjectName("refreshScheduler");
+    plot->installEventFilter(this);
+}
+
+RefreshScheduler::~RefreshScheduler()
+{
+    if(d_ptr->coordinator)
+        d_ptr->coordinator->unregisterScheduler(this);
+    delete d_ptr;
+}
+
+double RefreshScheduler::targetFps() const
+{
+    return d_ptr->targetFps;
+}
+
+int RefreshScheduler::targetInterval() const
+{
+    return qRound(1000.0 / d_ptr->targetFps);
+}
+
+int RefreshScheduler::interval() const
+{
+    return d_ptr->interval;
+}
+
+bool RefreshScheduler::adaptive() const
+{
+    return d_ptr->adaptive;
+}
+
+double RefreshScheduler::paintBudget() const
+{
+    return d_ptr->paintBudget;
+}
+
+bool RefreshScheduler::isRunning() const
+{
+    return d_ptr->running;
+}
+
+bool RefreshScheduler::isPaused() const
+{
+    return d_ptr->paused;
+}
+
+bool RefreshScheduler::isDirty() const
+{
+    return d_ptr->dirty;
+}
+
+double RefreshScheduler::paintCost() const
+{
+    return d_ptr->paintCost;
+}
+
+unsigned long RefreshScheduler::frameCount() const
+{
+    return d_ptr->frameCount;
+}
+
+unsigned long RefreshScheduler::dirtyCount() const
+{
+    return d_ptr->dirtyCount;
+}
+
+PlotSceneWidget *RefreshScheduler::plot() const
+{
+    return d_ptr->plot;
+}
+
+bool RefreshScheduler::frameDue() const
+{
+    return !d_ptr->lastFrame.isValid() || d_ptr->lastFrame.elapsed() >= d_ptr->interval;
+}
+
+RefreshCoordinator *RefreshScheduler::coordinator() const
+{
+    return d_ptr->coordinator;
+}
+
+void RefreshScheduler::setCoordinator(RefreshCoordinator *coordinator)
+{
+    if(d_ptr->coordinator == coordinator)
+        return;
+    if(d_ptr->coordinator)
+        d_ptr->coordinator->unregisterScheduler(this);
+    d_ptr->coordinator = coordinator;
+    d_ptr->timer->stop();
+    if(coordinator)
+        coordinator->registerScheduler(this);
+    mArm();
+}
+
+void RefreshScheduler::setTargetFps(double fps)
+{
+    if(fps <= 0.0)
+    {
+        perr("RefreshScheduler::setTargetFps: invalid fps %f", fps);
+        return;
+    }
+    d_ptr->targetFps = fps;
+    d_ptr->interval = targetInterval();
+}
+
+void RefreshScheduler::setAdaptive(bool en)
+{
+    d_ptr->adaptive = en;
+    if(!en)
+        d_ptr->interval = targetInterval();
+}
+
+void RefreshScheduler::setPaintBudget(double ratio)
+{
+    if(ratio > 0.0 && ratio <= 1.0)
+        d_ptr->paintBudget = ratio;
+    else
+        perr("RefreshScheduler::setPaintBudget: ratio must be in (0, 1], not %f", ratio);
+}
+
+void RefreshScheduler::start()
+{
+    d_ptr->running = true;
+    /* render what changed while stopped */
+    d_ptr->dirty = d_ptr->fullDirty = true;
+    mArm();
+}
+
+void RefreshScheduler::stop()
+{
+    d_ptr->running = false;
+    d_ptr->timer->stop();
+    /* the curve items wait for the next frame: there will be none */
+    mFlushCurveUpdates();
+}
+
+void RefreshScheduler::markDirty()
+{
+    d_ptr->dirtyCount++;
+    d_ptr->dirty = d_ptr->fullDirty = true;
+    mArm();
+}
+
+void RefreshScheduler::markDirty(const QRectF& sceneRect)
+{
+    d_ptr->dirtyCount++;
+    d_ptr->dirty = true;
+    if(!d_ptr->fullDirty)
+        d_ptr->dirtyRect |= sceneRect;
+    mArm();
+}
+
+/* schedule the next frame so that two frames are at least interval() ms apart */
+void RefreshScheduler::mArm()
+{
+    if(!d_ptr->running || !d_ptr->dirty)
+        return;
+    if(d_ptr->coordinator)
+    {
+        d_ptr->coordinator->requestFrame();
+        return;
+    }
+    if(d_ptr->timer->isActive())
+        return;
+    int wait = 0;
+    if(d_ptr->lastFrame.isValid())
+        wait = qMax(0, d_ptr->interval - (int) d_ptr->lastFrame.elapsed());
+    d_ptr->timer->start(wait);
+}
+
+void RefreshScheduler::frameTimeout()
+{
+    renderFrame();
+}
+
+bool RefreshScheduler::renderFrame()
+{
+    if(!d_ptr->dirty)
+        return false;
+    if(!mPlotShown())
+    {
+        /* the event filter resumes when the plot is shown again */
+        d_ptr->paused = true;
+        return false;
+    }
+    d_ptr->paused = false;
+    d_ptr->lastFrame.start();
+    d_ptr->frameCount++;
+    PLOT_TRACE_SCOPE("scene update");
+    mFlushCurveUpdates();
+    if(d_ptr->fullDirty)
+        d_ptr->plot->scene()->update();
+    else if(!d_ptr->dirtyRect.isEmpty())
+    {
+        /* only overlays changed. With NoViewportUpdate the view ignores partial scene
+         * updates: the region is submitted to the viewport directly.
+         * The margin accounts for antialiasing.
+         */
+        QRect r = d_ptr->plot->mapFromScene(d_ptr->dirtyRect).boundingRect().adjusted(-2, -2, 2, 2);
+        d_ptr->plot->viewport()->update(r);
+    }
+    d_ptr->dirty = d_ptr->fullDirty = false;
+    d_ptr->dirtyRect = QRectF();
+    return true;
+}
+
+/* the curve items coalesce their updates and bounding rect changes until the frame */
+void RefreshScheduler::mFlushCurveUpdates()
+{
+    foreach(SceneCurve *c, d_ptr->plot->getCurves())
+        if(c->curveItem())
+            c->curveItem()->flushUpdates();
+}
+
+void RefreshScheduler::paintFinished(double ms)
+{
+    /* exponential moving average of the paint cost */
+    if(d_ptr->paintCost == 0.0)
+        d_ptr->paintCost = ms;
+    else
+        d_ptr->paintCost = 0.8 * d_ptr->paintCost + 0.2 * ms;
+
+    if(d_ptr->adaptive)
+    {
+        int target = targetInterval();
+        double budget = target * d_ptr->paintBudget;
+        if(d_ptr->paintCost > budget)
+            d_ptr->interval = (int) ceil(d_ptr->paintCost / d_ptr->paintBudget);
+        else
+            d_ptr->interval = target;
+    }
+}
+
+bool RefreshScheduler::mPlotShown() const
+{
+    return d_ptr->plot->isVisible() && !d_ptr->plot->window()->isMinimized();
+}
+
+bool RefreshScheduler::eventFilter(QObject *obj, QEvent *event)
+{
+    if(obj == d_ptr->plot && event->type() == QEvent::Show && d_ptr->plot->window() != d_ptr->plot
+            && d_ptr->plot->window() != d_ptr->filteredWindow)
+    {
+        /* watch the top level window to be notified of minimize and restore */
+        if(d_ptr->filteredWindow)
+            d_ptr->filteredWindow->removeEventFilter(this);
+        d_ptr->filteredWindow = d_ptr->plot->window();
+        d_ptr->filteredWindow->installEventFilter(this);
+    }
+    if(d_ptr->paused && (event->type() == QEvent::Show || event->type() == QEvent::WindowStateChange))
+    {
+        /* resume: pending changes are rendered at the next frame */
+        d_ptr->paused = false;
+        mArm();
+    }
+    return QObject::eventFilter(obj, event);
+}
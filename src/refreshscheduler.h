@@ -0,0 +1,172 @@
+#ifndef REFRESHSCHEDULER_H
+#define REFRESHSCHEDULER_H
+
+#include <QObject>
+#include <QRectF>
+
+class PlotSceneWidget;
+class RefreshCoordinator;
+class RefreshSchedulerPrivate;
+
+/** \brief Paces the refresh of a PlotSceneWidget when manualSceneUpdate is enabled.
+ *
+ * The RefreshScheduler replaces the plain refresh timer that used to update the
+ * scene at each timeout. It is created and owned by the PlotSceneWidget when
+ * PlotSceneWidget::setRefreshPeriod is called, and it is available through
+ * PlotSceneWidget::refreshScheduler.
+ *
+ * \par Dirty notifications
+ * Curves and axes notify the scheduler through PlotSceneWidget::requestRefresh each
+ * time their content changes. Notifications are coalesced: the scene is updated at
+ * most once per frame, at the rate given by targetFps. If nothing is dirty, no frame
+ * is rendered and no timer is left running.
+ *
+ * \note Applications that modify custom items while manualSceneUpdate is enabled
+ * must call PlotSceneWidget::requestRefresh to have them repainted.
+ *
+ * \par Hidden widgets
+ * While the plot is hidden or its window is minimized, frames are suspended. Pending
+ * changes are rendered as soon as the plot is shown again.
+ *
+ * \par Adaptive rate
+ * PlotSceneWidget reports the time spent in each paint event through paintFinished.
+ * When the adaptive property is true (the default) and the average paint cost exceeds
+ * paintBudget (a fraction of the frame interval), the interval is stretched so that
+ * the paint cost fits the budget again. The target rate is restored as soon as the
+ * paint cost decreases.
+ *
+ * \par Shared refresh
+ * When a RefreshCoordinator is set, the scheduler does not run its own timer:
+ * frames are requested to the coordinator, that updates all the registered plots
+ * in a single pass. See PlotSceneWidget::setSharedRefresh.
+ */
+class RefreshScheduler : public QObject
+{
+    Q_PROPERTY(double targetFps READ targetFps WRITE setTargetFps)
+    Q_PROPERTY(bool adaptive READ adaptive WRITE setAdaptive)
+    Q_PROPERTY(double paintBudget READ paintBudget WRITE setPaintBudget)
+
+    Q_OBJECT
+public:
+    explicit RefreshScheduler(PlotSceneWidget *plot);
+
+    virtual ~RefreshScheduler();
+
+    double targetFps() const;
+
+    /** \brief the interval, in milliseconds, corresponding to targetFps
+     */
+    int targetInterval() const;
+
+    /** \brief the interval, in milliseconds, actually used between two frames.
+     *
+     * It is greater than targetInterval when the adaptive rate had to slow down
+     * the refresh.
+     */
+    int interval() const;
+
+    bool adaptive() const;
+
+    double paintBudget() const;
+
+    bool isRunning() const;
+
+    /** \brief true if the scheduler is running but frames are suspended because the
+     *         plot is hidden or minimized.
+     */
+    bool isPaused() const;
+
+    bool isDirty() const;
+
+    /** \brief the average time, in milliseconds, spent painting a frame
+     */
+    double paintCost() const;
+
+    /** \brief the number of frames rendered since the scheduler was created
+     */
+    unsigned long frameCount() const;
+
+    /** \brief the number of dirty notifications received since the scheduler was created
+     */
+    unsigned long dirtyCount() const;
+
+    PlotSceneWidget *plot() const;
+
+    /** \brief true if at least interval() milliseconds have elapsed since the last frame
+     */
+    bool frameDue() const;
+
+    RefreshCoordinator *coordinator() const;
+
+    /** \brief registers the scheduler with the given coordinator, or makes it use its
+     *         own timer again if coordinator is NULL.
+     */
+    void setCoordinator(RefreshCoordinator *coordinator);
+
+public slots:
+
+    /** \brief sets the desired number of frames per second
+     *
+     * @param fps the maximum refresh rate. Values less than or equal to zero are ignored.
+     */
+    void setTargetFps(double fps);
+
+    /** \brief enables or disables the adaptation of the refresh rate to the paint cost
+     */
+    void setAdaptive(bool en);
+
+    /** \brief sets the fraction of the frame interval that painting is allowed to take
+     *
+     * @param ratio a number between 0 and 1. Default: 0.5
+     */
+    void setPaintBudget(double ratio);
+
+    void start();
+
+    void stop();
+
+    /** \brief notifies the scheduler that the scene content has changed.
+     *
+     * A frame is scheduled, unless one is already pending.
+     */
+    void markDirty();
+
+    /** \brief notifies the scheduler that only the given region of the scene has changed.
+     *
+     * Used by overlays (zoom rectangle, markers, crosshair). If no full update is pending
+     * when the frame is rendered, only the union of the regions is repainted, so that the
+     * curves and the axes outside are not painted at all.
+     *
+     * @param sceneRect the changed region, in scene coordinates
+     */
+    void markDirty(const QRectF& sceneRect);
+
+    /** \brief renders a frame now, if something is dirty and the plot is visible.
+     *
+     * @return true if a frame has been rendered, false otherwise.
+     */
+    bool renderFrame();
+
+    /** \brief called by the PlotSceneWidget at the end of each paint event
+     *
+     * @param ms the time spent painting, in milliseconds
+     */
+    void paintFinished(double ms);
+
+protected:
+    bool eventFilter(QObject *obj, QEvent *event);
+
+private slots:
+    void frameTimeout();
+
+private:
+    RefreshSchedulerPrivate *d_ptr;
+
+    bool mPlotShown() const;
+
+    void mArm();
+
+    void mFlushCurveUpdates();
+};
+
+#endif // REFRESHSCHEDULER_H
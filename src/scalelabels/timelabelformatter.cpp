@@ -0,0 +1,235 @@
+#include "timelabelformatter.h"
+#include <QDateTime>
+#include <QVarLengthArray>
+#include <math.h>
+
+/* floor division: days and hours before 1970 are negative */
+static inline qint64 floorDiv(qint64 a, qint64 b)
+{
+    qint64 q = a / b;
+    if((a % b != 0) && ((a < 0) != (b < 0)))
+        q--;
+    return q;
+}
+
+TimeLabelFormatter::TimeLabelFormatter(const QString& format)
+{
+    mOffsetFrom = mOffsetTo = 0;
+    mOffset = 0;
+    mOffsetLookups = 0;
+    setFormat(format);
+}
+
+void TimeLabelFormatter::setFormat(const QString& format)
+{
+    mFormat = format;
+    mTokens.clear();
+    mLiterals.clear();
+    mFractionScale = 1;
+    int i = 0;
+    while(i < format.length())
+    {
+        QChar c = format.at(i);
+        int run = 1;
+        while(i + run < format.length() && format.at(i + run) == c)
+            run++;
+        Token t;
+        t.field = Literal;
+        t.width = 0;
+        t.pos = 0;
+        if(c == 'd' || c == 'M' || c == 'h' || c == 'm' || c == 's')
+        {
+            t.width = qMin(run, 2);
+            if(c == 'd') t.field = Day;
+            else if(c == 'M') t.field = Month;
+            else if(c == 'h') t.field = Hour;
+            else if(c == 'm') t.field = Minute;
+            else t.field = Second;
+        }
+        else if(c == 'y' && run >= 4)
+        {
+            t.field = Year4;
+            t.width = 4;
+        }
+        else if(c == 'y' && run >= 2)
+        {
+            t.field = Year2;
+            t.width = 2;
+        }
+        else if(c == 'z')
+        {
+            t.field = Fraction;
+            t.width = qMin(run, 3);
+            while(mFractionScale < (t.width == 1 ? 10 : (t.width == 2 ? 100 : 1000)))
+                mFractionScale *= 10;
+        }
+
+        if(t.field != Literal)
+        {
+            mTokens << t;
+            i += t.width;
+            continue;
+        }
+
+        /* literal text: a quoted section or a single character */
+        QString text;
+        if(c == '\'')
+        {
+            i++;
+            while(i < format.length())
+            {
+                if(format.at(i) == '\'' && i + 1 < format.length() && format.at(i + 1) == '\'')
+                {
+                    text += '\'';
+                    i += 2;
+                }
+                else if(format.at(i) == '\'')
+                {
+                    i++;
+                    break;
+                }
+                else
+                    text += format.at(i++);
+            }
+        }
+        else
+        {
+            text = c;
+            i++;
+        }
+        /* merge with the previous literal */
+        if(!mTokens.isEmpty() && mTokens.last().field == Literal)
+            mTokens.last().width += text.length();
+        else
+        {
+            t.pos = mLiterals.length();
+            t.width = text.length();
+            mTokens << t;
+        }
+        mLiterals += text;
+    }
+}
+
+QString TimeLabelFormatter::formatString() const
+{
+    return mFormat;
+}
+
+unsigned long TimeLabelFormatter::offsetLookups() const
+{
+    return mOffsetLookups;
+}
+
+/* the offset of the local time from UTC, in seconds, at the given UTC time */
+int TimeLabelFormatter::mOffsetAt(qint64 utc)
+{
+    if(utc < 0 || utc > 0xFFFFFFFFLL)
+        return 0;
+    QDateTime local = QDateTime::fromTime_t((uint) utc);
+    QDateTime wallClockAsUtc(local.date(), local.time(), Qt::UTC);
+    return local.secsTo(wallClockAsUtc);
+}
+
+/* caches the offset for the local day of utc. If the offset changes during that day,
+ * the cache covers only the local hour of utc: offsets change on the hour.
+ */
+void TimeLabelFormatter::mUpdateOffset(qint64 utc) const
+{
+    int offset = mOffsetAt(utc);
+    qint64 local = utc + offset;
+    qint64 from = floorDiv(local, 86400) * 86400 - offset;
+    qint64 to = from + 86400;
+    mOffsetLookups++;
+    if(mOffsetAt(from) != offset || mOffsetAt(to - 1) != offset)
+    {
+        from = floorDiv(local, 3600) * 3600 - offset;
+        to = from + 3600;
+    }
+    mOffset = offset;
+    mOffsetFrom = from;
+    mOffsetTo = to;
+}
+
+int TimeLabelFormatter::mLocalOffset(qint64 utc) const
+{
+    if(utc < mOffsetFrom || utc >= mOffsetTo)
+        mUpdateOffset(utc);
+    return mOffset;
+}
+
+QString TimeLabelFormatter::format(double timestamp) const
+{
+    if(isnan(timestamp) || isinf(timestamp))
+        return QString();
+    /* round, then split: a carry of the fraction goes into the seconds */
+    qint64 ticks = qRound64(timestamp * mFractionScale);
+    qint64 utc = floorDiv(ticks, mFractionScale);
+    int frac = (int) (ticks - utc * mFractionScale);
+    qint64 local = utc + mLocalOffset(utc);
+    qint64 days = floorDiv(local, 86400);
+    int sod = (int) (local - days * 86400);
+    int fields[Fraction + 1];
+    fields[Hour] = sod / 3600;
+    fields[Minute] = (sod / 60) % 60;
+    fields[Second] = sod % 60;
+
+    /* civil date from the days since 1970-01-01 (proleptic Gregorian calendar) */
+    qint64 z = days + 719468;
+    qint64 era = floorDiv(z, 146097);
+    int doe = (int) (z - era * 146097);
+    int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int mp = (5 * doy + 2) / 153;
+    fields[Day] = doy - (153 * mp + 2) / 5 + 1;
+    fields[Month] = mp < 10 ? mp + 3 : mp - 9;
+    fields[Year4] = (int) (yoe + era * 400 + (fields[Month] <= 2 ? 1 : 0));
+    fields[Year2] = ((fields[Year4] % 100) + 100) % 100;
+
+    QVarLengthArray<QChar, 64> buf(mLiterals.length() + 4 * mTokens.size());
+    int n = 0;
+    foreach(const Token& t, mTokens)
+    {
+        if(t.field == Literal)
+        {
+            const QChar *lit = mLiterals.constData() + t.pos;
+            for(int i = 0; i < t.width; i++)
+                buf[n++] = lit[i];
+            continue;
+        }
+        int value, digits = t.width;
+        if(t.field == Fraction)
+        {
+            int scale = (digits == 1) ? 10 : (digits == 2 ? 100 : 1000);
+            value = frac / (int) (mFractionScale / scale);
+        }
+        else
+        {
+            value = fields[t.field];
+            /* d, M, h, m, s: no leading zero */
+            if(digits == 1 && value >= 10)
+                digits = 2;
+        }
+        for(int i = digits - 1; i >= 0; i--)
+        {
+            buf[n + i] = QChar('0' + value % 10);
+            value /= 10;
+        }
+        n += digits;
+    }
+    return QString(buf.constData(), n);
+}
+
+QString TimeLabelFormatter::longestLabel() const
+{
+    QString s;
+    foreach(const Token& t, mTokens)
+    {
+        if(t.field == Literal)
+            s += mLiterals.mid(t.pos, t.width);
+        else if(t.field == Fraction || t.field == Year4 || t.width == 2)
+            s += QString(t.width, 'X');
+        else
+            s += "XX";
+    }
+    return s;
+}
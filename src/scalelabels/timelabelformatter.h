@@ -0,0 +1,96 @@
+#ifndef TIMELABELFORMATTER_H
+#define TIMELABELFORMATTER_H
+
+#include <QString>
+#include <QVector>
+
+/** \brief Formats timestamps into local date and time labels, quickly.
+ *
+ * QDateTime::fromTime_t(value).toString(format) looks up the time zone and parses the
+ * format at each call. The TimeLabelFormatter parses the format once, in setFormat,
+ * and caches the offset of the local time from UTC: the offset is looked up again
+ * only when a timestamp falls outside the local day of the last lookup (or outside
+ * its hour, on the days when the offset changes). Each label is composed in a fixed
+ * buffer.
+ *
+ * \par Format
+ * \li d, dd: the day of the month, without and with a leading zero;
+ * \li M, MM: the month;
+ * \li yy, yyyy: the year, two and four digits;
+ * \li h, hh: the hour (0-23);
+ * \li m, mm: the minute;
+ * \li s, ss: the second;
+ * \li z, zz, zzz: the fraction of second, in tenths, hundredths and milliseconds.
+ *     Note that, unlike QDateTime, z is one digit;
+ * \li text between single quotes is copied as it is, two single quotes make a quote;
+ * \li any other character is copied as it is.
+ *
+ * The timestamp is rounded to the finest fraction of second in the format, or to
+ * the second if there is none. A carry goes into the seconds: 59.9996 is written
+ * 00.000 of the next minute with zzz.
+ *
+ * \par Example
+ * \code
+ * TimeLabelFormatter f("hh:mm:ss.zzz");
+ * QString s = f.format(1400000000.25); // "18:53:20.250" in Central Europe
+ * \endcode
+ *
+ * @see TimeScaleLabel
+ */
+class TimeLabelFormatter
+{
+public:
+    TimeLabelFormatter(const QString& format = "hh:mm:ss");
+
+    void setFormat(const QString& format);
+
+    QString formatString() const;
+
+    /** \brief formats a timestamp, in seconds since 1970-01-01T00:00:00 UTC
+     */
+    QString format(double timestamp) const;
+
+    /** \brief the longest string that format can return: each field is replaced by
+     *         as many "X" as its maximum number of digits
+     */
+    QString longestLabel() const;
+
+    /** \brief the number of times the local time offset has been looked up
+     */
+    unsigned long offsetLookups() const;
+
+private:
+    enum Field { Literal, Day, Month, Year2, Year4, Hour, Minute, Second, Fraction };
+
+    struct Token
+    {
+        Field field;
+
+        /* digits, or the position of the literal in mLiterals */
+        int width, pos;
+    };
+
+    QString mFormat;
+
+    QVector<Token> mTokens;
+
+    QString mLiterals;
+
+    /* 10 to the number of digits of the finest fraction in the format */
+    qint64 mFractionScale;
+
+    /* the local offset, valid for UTC seconds in [mOffsetFrom, mOffsetTo) */
+    mutable qint64 mOffsetFrom, mOffsetTo;
+
+    mutable int mOffset;
+
+    mutable unsigned long mOffsetLookups;
+
+    int mLocalOffset(qint64 utc) const;
+
+    void mUpdateOffset(qint64 utc) const;
+
+    static int mOffsetAt(qint64 utc);
+};
+
+#endif // TIMELABELFORMATTER_H
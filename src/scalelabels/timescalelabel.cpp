@@ -2,6 +2,7 @@
 
 #include <QDateTime>
 #include <QtDebug>
+#include "qgraphicsplotmacros.h"
 
 TimeScaleLabel::~TimeScaleLabel()
 {
@@ -12,16 +13,31 @@ TimeScaleLabel::TimeScaleLabel(bool showDate)
 {
     d_ptr = new TimeScaleLabelPrivate();
     d_ptr->showDate = showDate;
+    d_ptr->subSecondDigits = 0;
+    mUpdateFormat();
 }
 
 QString TimeScaleLabel::label(double value) const
 {
-    QString ret;
-    if(!d_ptr->showDate)
-        ret = QDateTime::fromTime_t(value).toString("hh:mm:ss");
-    else
-        ret = QDateTime::fromTime_t(value).toString("dd/MM hh:mm:ss");
-    return ret;
+    return d_ptr->formatter.format(value);
+}
+
+/* the format given to the formatter: the custom one or the one built from
+ * showDate and subSecondDigits
+ */
+void TimeScaleLabel::mUpdateFormat()
+{
+    QString format = d_ptr->customFormat;
+    if(format.isEmpty())
+    {
+        if(!d_ptr->showDate)
+            format = "hh:mm:ss";
+        else
+            format = "dd/MM hh:mm:ss";
+        if(d_ptr->subSecondDigits > 0)
+            format += "." + QString(d_ptr->subSecondDigits, 'z');
+    }
+    d_ptr->formatter.setFormat(format);
 }
 
 /** \brief show the date together with the time
@@ -30,11 +46,14 @@ QString TimeScaleLabel::label(double value) const
  * @param show false show only the time
  *
  * \par Note
- * updateGeometry may be required on the scale that uses this interface
+ * updateGeometry may be required on the scale that uses this interface.
+ * ScaleItem keeps the labels already formatted: call ScaleItem::clearLabelCache
+ * and ScaleItem::updateLabelsCache on the scale afterwards.
  */
 void TimeScaleLabel::setShowDate(bool show)
 {
     d_ptr->showDate = show;
+    mUpdateFormat();
 }
 
 /** \brief Returns true if the label contains both time and date, false
@@ -46,6 +65,51 @@ bool TimeScaleLabel::showDate() const
     return d_ptr->showDate;
 }
 
+/** \brief shows the fractions of second after the seconds
+ *
+ * @param digits the number of digits after the seconds, between 0 (default) and 3
+ *        (milliseconds). The fraction is truncated.
+ *
+ * The same notes as for setShowDate apply.
+ */
+void TimeScaleLabel::setSubSecondDigits(int digits)
+{
+    if(digits >= 0 && digits <= 3)
+    {
+        d_ptr->subSecondDigits = digits;
+        mUpdateFormat();
+    }
+    else
+        perr("TimeScaleLabel::setSubSecondDigits: digits must be between 0 and 3, not %d", digits);
+}
+
+int TimeScaleLabel::subSecondDigits() const
+{
+    return d_ptr->subSecondDigits;
+}
+
+/** \brief sets a custom format, overriding showDate and subSecondDigits
+ *
+ * @param format a format as described in TimeLabelFormatter. An empty string restores
+ *        the format given by showDate and subSecondDigits.
+ *
+ * The same notes as for setShowDate apply.
+ *
+ * @see TimeLabelFormatter
+ */
+void TimeScaleLabel::setFormat(const QString& format)
+{
+    d_ptr->customFormat = format;
+    mUpdateFormat();
+}
+
+/** \brief the format currently used to compose the labels
+ */
+QString TimeScaleLabel::format() const
+{
+    return d_ptr->formatter.formatString();
+}
+
 ScaleLabelInterface::Type TimeScaleLabel::type() const
 {
     return ScaleLabelInterface::TimeScale;
@@ -56,9 +120,5 @@ ScaleLabelInterface::Type TimeScaleLabel::type() const
  */
 QString TimeScaleLabel::longestLabel() const
 {
-    if(!d_ptr->showDate)
-        return "XX:XX:XX";
-    else
-        return "XX/MMHH:MM:SS";
+    return d_ptr->formatter.longestLabel();
 }
-
@@ -2,15 +2,30 @@
 #define TIMESCALELABEL_H
 
 #include <scalelabelinterface.h>
+#include "timelabelformatter.h"
 
 class TimeScaleLabelPrivate
 {
 public:
     TimeScaleLabelPrivate() {}
     bool showDate;
+    int subSecondDigits;
+    /* empty unless set with setFormat */
+    QString customFormat;
+    TimeLabelFormatter formatter;
 };
 
 
+/** \brief A ScaleLabelInterface that shows the values of the axis, interpreted as
+ *         seconds since 1970-01-01T00:00:00 UTC, as local time.
+ *
+ * The labels are composed by a TimeLabelFormatter: the format is parsed once and the
+ * local time offset is cached, so that the labels are cheap to generate even when
+ * the axis bounds change at each sample.
+ *
+ * The default format is "hh:mm:ss", or "dd/MM hh:mm:ss" with setShowDate. Fractions of
+ * second can be added with setSubSecondDigits, a custom format can be set with setFormat.
+ */
 class TimeScaleLabel : public ScaleLabelInterface
 {
 public:
@@ -23,6 +38,14 @@ public:
 
     bool showDate() const;
 
+    void setSubSecondDigits(int digits);
+
+    int subSecondDigits() const;
+
+    void setFormat(const QString& format);
+
+    QString format() const;
+
     virtual ScaleLabelInterface::Type type() const;
 
     virtual QString longestLabel() const;
@@ -31,6 +54,8 @@ public:
 private:
     Q_DECLARE_PRIVATE(TimeScaleLabel)
     TimeScaleLabelPrivate *d_ptr;
+
+    void mUpdateFormat();
 };
 
 #endif // TIMESCALELABEL_H
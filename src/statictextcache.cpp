@@ -0,0 +1,98 @@
+#include "statictextcache.h"
+#include <QHash>
+#include <QTransform>
+
+class StaticTextCacheEntry
+{
+public:
+    QStaticText text;
+
+    unsigned long lastUse;
+};
+
+class StaticTextCachePrivate
+{
+public:
+    QFont font;
+
+    QHash<QString, StaticTextCacheEntry> texts;
+
+    int capacity;
+
+    unsigned long useCount;
+};
+
+StaticTextCache::StaticTextCache(int capacity)
+{
+    d_ptr = new StaticTextCachePrivate();
+    d_ptr->capacity = qMax(1, capacity);
+    d_ptr->useCount = 0;
+}
+
+StaticTextCache::~StaticTextCache()
+{
+    delete d_ptr;
+}
+
+void StaticTextCache::setFont(const QFont &f)
+{
+    if(f != d_ptr->font)
+    {
+        d_ptr->font = f;
+        d_ptr->texts.clear();
+    }
+}
+
+QFont StaticTextCache::font() const
+{
+    return d_ptr->font;
+}
+
+QStaticText StaticTextCache::text(const QString &s)
+{
+    QHash<QString, StaticTextCacheEntry>::iterator it = d_ptr->texts.find(s);
+    if(it == d_ptr->texts.end())
+    {
+        if(d_ptr->texts.size() >= d_ptr->capacity)
+            mEvict();
+        StaticTextCacheEntry e;
+        e.text.setText(s);
+        e.text.setTextFormat(Qt::PlainText);
+        /* the layout is computed again by the painter only if its transform, apart
+         * from the translation, differs from this one (e.g. rotated labels)
+         */
+        e.text.prepare(QTransform(), d_ptr->font);
+        it = d_ptr->texts.insert(s, e);
+    }
+    it.value().lastUse = ++d_ptr->useCount;
+    return it.value().text;
+}
+
+/* drops the older half of the labels */
+void StaticTextCache::mEvict()
+{
+    unsigned long threshold = d_ptr->useCount - d_ptr->capacity / 2;
+    QHash<QString, StaticTextCacheEntry>::iterator it = d_ptr->texts.begin();
+    while(it != d_ptr->texts.end())
+    {
+        if(it.value().lastUse <= threshold)
+            it = d_ptr->texts.erase(it);
+        else
+            ++it;
+    }
+}
+
+void StaticTextCache::clear()
+{
+    d_ptr->texts.clear();
+}
+
+int StaticTextCache::size() const
+{
+    return d_ptr->texts.size();
+}
+
+int StaticTextCache::capacity() const
+{
+    return d_ptr->capacity;
+}
@@ -0,0 +1,49 @@
+#ifndef STATICTEXTCACHE_H
+#define STATICTEXTCACHE_H
+
+#include <QStaticText>
+#include <QFont>
+#include <QString>
+
+class StaticTextCachePrivate;
+
+/* pre-laid-out axis labels.
+ *
+ * Keeps a QStaticText for each label drawn with the font of the cache, so that
+ * the text is shaped once and drawn with QPainter::drawStaticText afterwards.
+ * The painter font must be the font of the cache, otherwise QPainter lays the
+ * text out again at each draw.
+ *
+ * The least recently used labels are dropped beyond the capacity.
+ * Used by ScaleItem and ExternalScaleWidget.
+ */
+class StaticTextCache
+{
+public:
+    explicit StaticTextCache(int capacity = 256);
+
+    ~StaticTextCache();
+
+    /* changing the font drops all the labels */
+    void setFont(const QFont& f);
+
+    QFont font() const;
+
+    /* the laid out text. The returned object shares the layout with the cached one,
+     * so that the layout computed by the first drawStaticText is kept in the cache.
+     */
+    QStaticText text(const QString& s);
+
+    void clear();
+
+    int size() const;
+
+    int capacity() const;
+
+private:
+    StaticTextCachePrivate *d_ptr;
+
+    void mEvict();
+};
+
+#endif // STATICTEXTCACHE_H
@@ -0,0 +1,267 @@
+#include "tracerecorder.h"
+#include <QElapsedTimer>
+#include <QThreadStorage>
+#include <QThread>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QList>
+#include <QtAlgorithms>
+#include <QFile>
+#include <QCoreApplication>
+#include <QtDebug>
+#include "qgraphicsplotmacros.h"
+
+QAtomicInt TraceRecorder::sEnabled(0);
+
+struct TraceEvent
+{
+    const char *name;
+    qint64 start, end;
+};
+
+/* single producer (the owner thread) single consumer (the flushing thread) ring.
+ * head is written by the producer only, tail by the consumer only.
+ */
+class TraceBuffer
+{
+public:
+    TraceBuffer(int tid, const QString& threadName) : tid(tid), threadName(threadName),
+        head(0), tail(0), dropped(0), finished(0) {}
+
+    int tid;
+
+    QString threadName;
+
+    TraceEvent events[TraceRecorder::BufferCapacity];
+
+    QAtomicInt head, tail, dropped;
+
+    /* set when the owner thread has finished: no more events will be pushed */
+    QAtomicInt finished;
+
+    void push(const TraceEvent &e);
+
+    void drain(QList<TraceEvent> &out);
+};
+
+void TraceBuffer::push(const TraceEvent &e)
+{
+    int h = head.fetchAndAddRelaxed(0);
+    int next = (h + 1) % TraceRecorder::BufferCapacity;
+    if(next == tail.fetchAndAddAcquire(0))
+    {
+        dropped.ref();
+        return;
+    }
+    events[h] = e;
+    /* publish the event to the consumer */
+    head.fetchAndStoreRelease(next);
+}
+
+void TraceBuffer::drain(QList<TraceEvent> &out)
+{
+    int t = tail.fetchAndAddRelaxed(0);
+    int h = head.fetchAndAddAcquire(0);
+    while(t != h)
+    {
+        out << events[t];
+        t = (t + 1) % TraceRecorder::BufferCapacity;
+    }
+    /* give the slots back to the producer */
+    tail.fetchAndStoreRelease(t);
+}
+
+/* QThreadStorage deletes its data when the thread finishes: the buffer itself
+ * is owned by the recorder, so that the events of a finished thread can still
+ * be flushed. The buffer is recycled after that flush.
+ */
+struct TraceBufferRef
+{
+    ~TraceBufferRef() { buffer->finished.fetchAndStoreRelease(1); }
+
+    TraceBuffer *buffer;
+};
+
+class TraceRecorderPrivate
+{
+public:
+    QElapsedTimer clock;
+
+    QThreadStorage<TraceBufferRef *> threadBuffers;
+
+    /* protects buffers and the flush */
+    QMutex mutex;
+
+    QList<TraceBuffer *> buffers;
+
+    /* the buffers of the finished threads, drained, ready for new threads */
+    QList<TraceBuffer *> freeBuffers;
+
+    /* the tid of the next thread */
+    int nextTid;
+
+    TraceBuffer *currentBuffer();
+
+    static QByteArray escaped(const QString& s);
+};
+
+TraceBuffer *TraceRecorderPrivate::currentBuffer()
+{
+    if(!threadBuffers.hasLocalData())
+    {
+        QMutexLocker locker(&mutex);
+        QThread *thread = QThread::currentThread();
+        QString name = thread->objectName();
+        if(name.isEmpty() && QCoreApplication::instance() && thread == QCoreApplication::instance()->thread())
+            name = "main";
+        else if(name.isEmpty())
+            name = QString("thread %1").arg(nextTid);
+        TraceBufferRef *ref = new TraceBufferRef;
+        if(!freeBuffers.isEmpty())
+        {
+            /* no producer is left on a free buffer */
+            ref->buffer = freeBuffers.takeLast();
+            ref->buffer->tid = nextTid;
+            ref->buffer->threadName = name;
+            ref->buffer->head.fetchAndStoreRelaxed(0);
+            ref->buffer->tail.fetchAndStoreRelaxed(0);
+            ref->buffer->dropped.fetchAndStoreRelaxed(0);
+            ref->buffer->finished.fetchAndStoreRelaxed(0);
+        }
+        else
+            ref->buffer = new TraceBuffer(nextTid, name);
+        nextTid++;
+        buffers << ref->buffer;
+        threadBuffers.setLocalData(ref);
+    }
+    return threadBuffers.localData()->buffer;
+}
+
+QByteArray TraceRecorderPrivate::escaped(const QString& s)
+{
+    QString e = s;
+    e.replace("\\", "\\\\").replace("\"", "\\\"");
+    return e.toUtf8();
+}
+
+TraceRecorder *TraceRecorder::instance()
+{
+    /* never destroyed: threads may record until the very end of the process */
+    static TraceRecorder *recorder = new TraceRecorder();
+    return recorder;
+}
+
+TraceRecorder::TraceRecorder()
+{
+    d_ptr = new TraceRecorderPrivate();
+    d_ptr->nextTid = 1;
+    d_ptr->clock.start();
+}
+
+TraceRecorder::~TraceRecorder()
+{
+    /* the buffers in use may still be referenced by running threads */
+    qDeleteAll(d_ptr->freeBuffers);
+    delete d_ptr;
+}
+
+void TraceRecorder::setEnabled(bool en)
+{
+    sEnabled.fetchAndStoreOrdered(en ? 1 : 0);
+}
+
+qint64 TraceRecorder::timestamp() const
+{
+    return d_ptr->clock.nsecsElapsed();
+}
+
+void TraceRecorder::addEvent(const char *name, qint64 start, qint64 end)
+{
+    TraceEvent e;
+    e.name = name;
+    e.start = start;
+    e.end = end;
+    d_ptr->currentBuffer()->push(e);
+}
+
+int TraceRecorder::droppedCount() const
+{
+    int dropped = 0;
+    QMutexLocker locker(&d_ptr->mutex);
+    foreach(TraceBuffer *b, d_ptr->buffers)
+        dropped += b->dropped.fetchAndAddRelaxed(0);
+    return dropped;
+}
+
+const char *TraceRecorder::painterEventName(int painterType)
+{
+    /* ItemPainterInterface::Type: Line = 0, Dot, Cross, Histogram, Step, Pie, CircleItemSet */
+    static const char *names[] = { "draw line", "draw dots", "draw cross", "draw histogram",
+                                   "draw steps", "draw pie", "draw circle item set" };
+    if(painterType >= 0 && painterType < (int) (sizeof(names) / sizeof(names[0])))
+        return names[painterType];
+    return "draw user";
+}
+
+QByteArray TraceRecorder::toJson()
+{
+    QMutexLocker locker(&d_ptr->mutex);
+    qint64 pid = QCoreApplication::applicationPid();
+    QByteArray json = "{\"traceEvents\":[\n";
+    bool first = true;
+    QList<TraceEvent> events;
+    QList<TraceBuffer *> finished;
+    foreach(TraceBuffer *b, d_ptr->buffers)
+    {
+        /* read before draining: a finished thread has pushed all its events */
+        if(b->finished.fetchAndAddAcquire(0))
+            finished << b;
+        events.clear();
+        b->drain(events);
+        b->dropped.fetchAndStoreRelaxed(0);
+
+        /* thread name metadata */
+        if(!first)
+            json += ",\n";
+        first = false;
+        json += QString("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%1,\"tid\":%2,\"args\":{\"name\":\"")
+                .arg(pid).arg(b->tid).toUtf8();
+        json += TraceRecorderPrivate::escaped(b->threadName) + "\"}}";
+
+        foreach(const TraceEvent &e, events)
+        {
+            /* ts and dur are expressed in microseconds */
+            json += QString(",\n{\"name\":\"%1\",\"cat\":\"qgraphicsplot\",\"ph\":\"X\",\"ts\":%2,"
+                            "\"dur\":%3,\"pid\":%4,\"tid\":%5}").arg(e.name)
+                    .arg(e.start / 1000.0, 0, 'f', 3).arg((e.end - e.start) / 1000.0, 0, 'f', 3)
+                    .arg(pid).arg(b->tid).toUtf8();
+        }
+    }
+    json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    /* the events of the finished threads have been flushed: recycle their buffers */
+    foreach(TraceBuffer *b, finished)
+    {
+        d_ptr->buffers.removeOne(b);
+        d_ptr->freeBuffers << b;
+    }
+    return json;
+}
+
+bool TraceRecorder::writeJson(const QString& fileName)
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        perr("TraceRecorder::writeJson: cannot open \"%s\": %s", qstoc(fileName), qstoc(file.errorString()));
+        return false;
+    }
+    QByteArray json = toJson();
+    if(file.write(json) != json.size())
+    {
+        perr("TraceRecorder::writeJson: error writing \"%s\": %s", qstoc(fileName), qstoc(file.errorString()));
+        return false;
+    }
+    file.close();
+    return true;
+}
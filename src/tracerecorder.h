@@ -0,0 +1,149 @@
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+
+#include <QString>
+#include <QByteArray>
+#include <QAtomicInt>
+
+class TraceRecorderPrivate;
+
+/** \brief Records the activity of the plot pipeline as Chrome trace events.
+ *
+ * The TraceRecorder collects spans (complete events, "ph":"X") for
+ * \li appendData, addPoints and setData on each SceneCurve;
+ * \li the recalculation of the curve and axis bounds;
+ * \li the projection of the data into scene coordinates (SceneCurve::points);
+ * \li each ItemPainterInterface::draw call;
+ * \li the regeneration of the axis labels;
+ * \li scene updates and paint events of the PlotSceneWidget.
+ *
+ * writeJson and toJson produce the JSON Object Format understood by chrome://tracing
+ * and by the Perfetto UI (ui.perfetto.dev).
+ *
+ * \par Threads
+ * Each thread records into its own buffer, a single producer single consumer ring
+ * that is written without locks. A lock is only taken the first time a thread
+ * records an event, to register its buffer. When a buffer is full, new events
+ * from that thread are dropped and counted (see droppedCount) until the next flush.
+ * The buffers are drained on demand by writeJson and toJson, that can be called
+ * from any thread. The buffer of a finished thread is kept until its events have
+ * been flushed, then it is reused by the next thread that records.
+ *
+ * \par Application events
+ * Acquisition threads can record their own spans with PLOT_TRACE_SCOPE or addEvent,
+ * so that they appear in the same timeline as the plot activity. Timestamps are
+ * taken from a single monotonic clock shared by all the threads.
+ *
+ * \par Cost
+ * Recording is disabled by default: a disabled measuring point costs the read of
+ * a flag. Defining QGRAPHICSPLOT_NO_TIMINGS at build time removes the measuring
+ * points altogether (see also FrameTimings).
+ *
+ * \par Example
+ * \code
+ * TraceRecorder::instance()->setEnabled(true);
+ * // ... reproduce the stall ...
+ * TraceRecorder::instance()->writeJson("/tmp/plot.trace.json");
+ * \endcode
+ */
+class TraceRecorder
+{
+public:
+    /* maximum number of events buffered per thread between two flushes */
+    enum { BufferCapacity = 16384 };
+
+    static TraceRecorder *instance();
+
+    static bool isEnabled()
+    {
+#if QT_VERSION >= 0x050000
+        return sEnabled.load() != 0;
+#else
+        return sEnabled != 0;
+#endif
+    }
+
+    void setEnabled(bool en);
+
+    /** \brief the time, in nanoseconds, elapsed since the creation of the recorder.
+     *
+     * All the timestamps of the trace are taken from this clock.
+     */
+    qint64 timestamp() const;
+
+    /** \brief records a span in the buffer of the calling thread.
+     *
+     * @param name the name of the event. It must point to a string that lives as long
+     *        as the recorder, such as a string literal.
+     * @param start the start of the span, as returned by timestamp
+     * @param end the end of the span, as returned by timestamp
+     */
+    void addEvent(const char *name, qint64 start, qint64 end);
+
+    /** \brief drains all the thread buffers and writes the events recorded since the
+     *         previous flush to fileName.
+     *
+     * @return true if the file has been written successfully, false otherwise.
+     */
+    bool writeJson(const QString& fileName);
+
+    /** \brief drains all the thread buffers and returns the events recorded since the
+     *         previous flush as a trace event JSON document.
+     */
+    QByteArray toJson();
+
+    /** \brief the number of events dropped because a thread buffer was full, since
+     *         the previous flush
+     */
+    int droppedCount() const;
+
+    /** \brief the name used in traces for the events of the painter of the given
+     *         ItemPainterInterface::Type
+     */
+    static const char *painterEventName(int painterType);
+
+private:
+    TraceRecorder();
+
+    ~TraceRecorder();
+
+    TraceRecorderPrivate *d_ptr;
+
+    static QAtomicInt sEnabled;
+};
+
+/** \brief records a span lasting as long as the scope, if the TraceRecorder is enabled
+ */
+class TraceScope
+{
+public:
+    explicit TraceScope(const char *name) : mName(name), mStart(-1)
+    {
+        if(TraceRecorder::isEnabled())
+            mStart = TraceRecorder::instance()->timestamp();
+    }
+
+    ~TraceScope()
+    {
+        if(mStart >= 0)
+        {
+            TraceRecorder *r = TraceRecorder::instance();
+            r->addEvent(mName, mStart, r->timestamp());
+        }
+    }
+
+private:
+    const char *mName;
+    qint64 mStart;
+};
+
+#define PLOT_TRACE_CAT2(a, b) a##b
+#define PLOT_TRACE_CAT(a, b) PLOT_TRACE_CAT2(a, b)
+
+#ifndef QGRAPHICSPLOT_NO_TIMINGS
+    #define PLOT_TRACE_SCOPE(name) TraceScope PLOT_TRACE_CAT(_traceScope, __LINE__)(name)
+#else
+    #define PLOT_TRACE_SCOPE(name) do {}while(0)
+#endif
+
+#endif // TRACERECORDER_H